@@ -1,25 +1,217 @@
-#define MAX_NUM_LEN (30)
+// Largest exponent of a number worth reading, far beyond the range of a double.
+#define JSON_MAX_EXPONENT (100000)
 
-// Used only for returning data in a convenient way. Not used for storage.
+// Arrays with at least this many elements get an offset table on the first indexed access.
+#define JSON_ARRAY_TABLE_THRESHOLD (8)
+
+// Value of the items of type VALUE_ARRAY. The elements are items chained as siblings, whose parent
+// is the array item.
 typedef struct JsonArray
 {
-    struct JsonItem* element;
+    struct JsonItem* element; // First element.
+    size_t len;
+    // Offset table pointing to each element, built lazily from the owner's arena.
+    struct JsonItem** elements_pp;
+    size_t elements_capacity; // Entries allocated for `elements_pp`.
+    struct JsonItem* owner_p; // Item whose value is the array, and parent of the elements.
 } JsonArray;
 
 typedef enum
 {
-    EMPTY,
-    NUMBER,
-    STRING,
-    KEY,
-    BOOLEAN_TRUE,
-    BOOLEAN_FALSE,
-    INVALID,
-} ElementType;
+    TOKEN_OBJECT_BEGIN,
+    TOKEN_OBJECT_END,
+    TOKEN_ARRAY_BEGIN,
+    TOKEN_ARRAY_END,
+    TOKEN_KEY,
+    TOKEN_STRING,
+    TOKEN_NUMBER,
+    TOKEN_TRUE,
+    TOKEN_FALSE,
+    TOKEN_NULL,
+    TOKEN_END,
+    TOKEN_INVALID,
+    TOKEN_INCOMPLETE, // Cut by the end of partial input: see `JsonTokenizer.partial`.
+} JsonTokenType;
+
+// What the tokenizer accepts next according to the JSON grammar.
+typedef enum
+{
+    EXPECT_VALUE,
+    EXPECT_VALUE_OR_ARRAY_END,
+    EXPECT_KEY,
+    EXPECT_KEY_OR_OBJECT_END,
+    EXPECT_COMMA_OR_END,
+    EXPECT_NOTHING,
+    EXPECT_ERROR,
+} JsonExpect;
+
+// Digits of a number, gathered while the tokenizer validates it.
+typedef struct
+{
+    uint64_t mantissa; // Leading significant digits, as many as fit.
+    int64_t exponent;  // Power of 10 by which `mantissa` is multiplied.
+    bool is_negative;
+    bool is_integer;   // With neither a fraction nor an exponent.
+    bool is_truncated; // With more digits than `mantissa` could take.
+} JsonNumber;
+
+typedef struct
+{
+    JsonTokenType type;
+    // First char of the token. For keys and strings, the char following the opening quote.
+    const char* start_p;
+    // Length in bytes of the token. For keys and strings, the quotes are not included.
+    size_t len;
+    bool has_escapes;  // TOKEN_KEY and TOKEN_STRING only.
+    JsonNumber number; // TOKEN_NUMBER only.
+} JsonToken;
+
+#define JSON_BLOCK_SIZE (64)
+
+// Classification of a block of `JSON_BLOCK_SIZE` input bytes: bit `i` of each mask refers to the
+// byte at position `i` of the block.
+typedef struct
+{
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t structural; // One of `{}[],:`
+    uint64_t whitespace;
+    uint64_t control; // Below 0x20, not allowed inside strings.
+} JsonBlockMasks;
+
+typedef void (*JsonClassifyFn)(const char*, JsonBlockMasks*);
+
+// Single-pass tokenizer: it skips whitespace, validates the grammar and splits the input into
+// tokens without copying or modifying it.
+typedef struct
+{
+    const char* begin_p;
+    const char* curr_p;
+    const char* end_p;
+    JsonExpect expect;
+    size_t depth;
+    // Deepest nesting allowed: less than JSON_MAX_DEPTH for a part of a document, whose containers
+    // are already that deep.
+    size_t max_depth;
+    // One bit per nesting level: 1 for objects, 0 for arrays.
+    uint8_t container_stack[(JSON_MAX_DEPTH + 7) / 8];
+    // Last classified block, reused until the tokenizer moves past it.
+    const char* block_p;
+    JsonBlockMasks block_masks;
+    // More input may follow `end_p`: a token cut by it is TOKEN_INCOMPLETE rather than invalid, and
+    // the tokenizer is left as it was, ready to read the token again once the input is extended.
+    bool partial;
+    // String cut by the end of partial input, whose scan resumes where it stopped rather than from
+    // the opening quote, so that a long string arriving in many chunks is scanned once.
+    const char* cut_string_p; // First char of the content, or NULL.
+    const char* cut_scan_p;   // First char not scanned yet.
+    bool cut_has_escapes;
+} JsonTokenizer;
+
+// Chunk of memory owned by a `JsonArena`. Chunks are chained from the most recent one backwards.
+typedef struct JsonArenaChunk
+{
+    struct JsonArenaChunk* prev_p;
+    size_t capacity;
+    size_t used;
+    max_align_t data[];
+} JsonArenaChunk;
+
+#define JSON_ARENA_MIN_CHUNK_SIZE (4096)
+#define JSON_ARENA_MAX_CHUNK_SIZE (1 << 24)
+
+// Prepare an empty arena. The first chunk is sized after `size_hint`, usually the input length.
+static void _JsonArena_init(JsonArena* arena_p, size_t size_hint)
+{
+    arena_p->chunk_p         = NULL;
+    arena_p->key_table_p     = NULL;
+    arena_p->shape_cache_p   = NULL;
+    arena_p->next_chunk_size = size_hint < JSON_ARENA_MIN_CHUNK_SIZE   ? JSON_ARENA_MIN_CHUNK_SIZE
+                               : size_hint > JSON_ARENA_MAX_CHUNK_SIZE ? JSON_ARENA_MAX_CHUNK_SIZE
+                                                                       : size_hint;
+}
+
+// Bump-allocate `size` bytes, aligned for any type. A new chunk, twice as large as the previous
+// one, is added when the current one is full.
+static void* _JsonArena_alloc(const char* file, const int line, JsonArena* arena_p, size_t size)
+{
+    JsonArenaChunk* chunk_p = arena_p->chunk_p;
+    size = (size + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1);
+    if ((chunk_p == NULL) || (chunk_p->capacity - chunk_p->used < size))
+    {
+        size_t capacity = arena_p->next_chunk_size;
+        if (capacity < size)
+        {
+            capacity = size;
+        }
+        chunk_p           = my_memory_malloc(file, line, sizeof(JsonArenaChunk) + capacity);
+        chunk_p->prev_p   = arena_p->chunk_p;
+        chunk_p->capacity = capacity;
+        chunk_p->used     = 0;
+        arena_p->chunk_p  = chunk_p;
+        if (arena_p->next_chunk_size < JSON_ARENA_MAX_CHUNK_SIZE)
+        {
+            arena_p->next_chunk_size *= 2;
+        }
+    }
+    void* ret_p = (char*)chunk_p->data + chunk_p->used;
+    chunk_p->used += size;
+    return ret_p;
+}
+
+// Release all the allocations but keep the most recent chunk, which is also the largest one, for
+// the next user of the arena.
+static void _JsonArena_reset(JsonArena* arena_p)
+{
+    JsonArenaChunk* chunk_p = arena_p->chunk_p;
+    if (chunk_p == NULL)
+    {
+        return;
+    }
+    JsonArenaChunk* prev_p = chunk_p->prev_p;
+    while (prev_p != NULL)
+    {
+        JsonArenaChunk* to_free_p = prev_p;
+        prev_p                    = prev_p->prev_p;
+        my_memory_free(to_free_p);
+    }
+    chunk_p->prev_p = NULL;
+    chunk_p->used   = 0;
+}
+
+// Hand the chunks of `src_arena_p` over to `dst_arena_p`, which keeps allocating from the current
+// chunk of `src_arena_p`.
+static void _JsonArena_merge(JsonArena* dst_arena_p, JsonArena* src_arena_p)
+{
+    JsonArenaChunk* oldest_chunk_p = src_arena_p->chunk_p;
+    if (oldest_chunk_p == NULL)
+    {
+        return;
+    }
+    while (oldest_chunk_p->prev_p != NULL)
+    {
+        oldest_chunk_p = oldest_chunk_p->prev_p;
+    }
+    oldest_chunk_p->prev_p = dst_arena_p->chunk_p;
+    dst_arena_p->chunk_p   = src_arena_p->chunk_p;
+    src_arena_p->chunk_p   = NULL;
+}
+
+static void _JsonArena_destroy(JsonArena* arena_p)
+{
+    JsonArenaChunk* chunk_p = arena_p->chunk_p;
+    while (chunk_p != NULL)
+    {
+        JsonArenaChunk* prev_p = chunk_p->prev_p;
+        my_memory_free(chunk_p);
+        chunk_p = prev_p;
+    }
+    arena_p->chunk_p = NULL;
+}
 
-JsonItem* _JsonItem_new(const char* file, const int line)
+JsonItem* _JsonItem_new(const char* file, const int line, JsonArena* arena_p)
 {
-    JsonItem* new_item         = (JsonItem*)my_memory_malloc(file, line, sizeof(JsonItem));
+    JsonItem* new_item = (JsonItem*)_JsonArena_alloc(file, line, arena_p, sizeof(JsonItem));
     new_item->key_p            = NULL;
     new_item->index            = 0;
     new_item->value.value_type = VALUE_UNDEFINED;
@@ -28,1029 +220,8716 @@ JsonItem* _JsonItem_new(const char* file, const int line)
     return new_item;
 }
 
-bool _is_token(const char c)
+static inline bool _is_whitespace(const char c)
+{
+    return (c == ' ') || (c == '\n') || (c == '\r') || (c == '\t');
+}
+
+static inline bool _is_blank(const char* curr_p, size_t len)
 {
-    char* token_list = "{}[],:\"";
-    for (llu_t i = 0; i < strlen(token_list); i++)
+    while ((len > 0) && _is_whitespace(*curr_p))
     {
-        if (c == token_list[i])
-            return true;
+        curr_p++;
+        len--;
+    }
+    return len == 0;
+}
+
+static inline bool _is_digit(const char c) { return (c >= '0') && (c <= '9'); }
+
+static void _classify_block_scalar(const char* block_p, JsonBlockMasks* out_masks_p)
+{
+    memset(out_masks_p, 0, sizeof(JsonBlockMasks));
+    for (size_t i = 0; i < JSON_BLOCK_SIZE; i++)
+    {
+        const unsigned char c = (unsigned char)block_p[i];
+        const uint64_t bit    = (uint64_t)1 << i;
+        switch (c)
+        {
+        case '"':
+            out_masks_p->quote |= bit;
+            break;
+        case '\\':
+            out_masks_p->backslash |= bit;
+            break;
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case ',':
+        case ':':
+            out_masks_p->structural |= bit;
+            break;
+        case ' ':
+        case '\n':
+        case '\r':
+        case '\t':
+            out_masks_p->whitespace |= bit;
+            break;
+        default:
+            break;
+        }
+        if (c < 0x20)
+        {
+            out_masks_p->control |= bit;
+        }
     }
-    return false;
 }
 
-ElementType _get_value_type(char* initial_char_p)
+#if defined(__x86_64__) || defined(__i386__)
+#define SSE42_SET_MODE (_SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK)
+
+__attribute__((target("sse4.2"))) static void _classify_block_sse42(
+    const char* block_p,
+    JsonBlockMasks* out_masks_p)
 {
-    if (strncmp(initial_char_p, "{\"", 2) == 0 || strncmp(initial_char_p, ",\"", 2) == 0)
+    // Only the first 6 and 4 chars of the sets are compared.
+    const __m128i structural_set
+        = _mm_setr_epi8('{', '}', '[', ']', ',', ':', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i whitespace_set
+        = _mm_setr_epi8(' ', '\n', '\r', '\t', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i quote_set      = _mm_set1_epi8('"');
+    const __m128i backslash_set  = _mm_set1_epi8('\\');
+    const __m128i control_max    = _mm_set1_epi8(0x1F);
+    memset(out_masks_p, 0, sizeof(JsonBlockMasks));
+    for (size_t i = 0; i < JSON_BLOCK_SIZE; i += 16)
     {
-        return KEY;
+        const __m128i chunk      = _mm_loadu_si128((const __m128i*)(block_p + i));
+        const __m128i structural = _mm_cmpestrm(structural_set, 6, chunk, 16, SSE42_SET_MODE);
+        const __m128i whitespace = _mm_cmpestrm(whitespace_set, 4, chunk, 16, SSE42_SET_MODE);
+        const __m128i control    = _mm_cmpeq_epi8(_mm_min_epu8(chunk, control_max), chunk);
+        const __m128i quote      = _mm_cmpeq_epi8(chunk, quote_set);
+        const __m128i backslash  = _mm_cmpeq_epi8(chunk, backslash_set);
+        out_masks_p->quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(quote) << i;
+        out_masks_p->backslash |= (uint64_t)(uint16_t)_mm_movemask_epi8(backslash) << i;
+        out_masks_p->structural |= (uint64_t)(uint16_t)_mm_cvtsi128_si32(structural) << i;
+        out_masks_p->whitespace |= (uint64_t)(uint16_t)_mm_cvtsi128_si32(whitespace) << i;
+        out_masks_p->control |= (uint64_t)(uint16_t)_mm_movemask_epi8(control) << i;
     }
-    else if (strncmp(initial_char_p, "{}", 2) == 0)
+}
+
+#define AVX2_EQ(chunk, c) _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(c))
+#define AVX2_MASK(vector) ((uint64_t)(uint32_t)_mm256_movemask_epi8(vector))
+
+__attribute__((target("avx2"))) static void _classify_block_avx2(
+    const char* block_p,
+    JsonBlockMasks* out_masks_p)
+{
+    const __m256i control_max = _mm256_set1_epi8(0x1F);
+    memset(out_masks_p, 0, sizeof(JsonBlockMasks));
+    for (size_t i = 0; i < JSON_BLOCK_SIZE; i += 32)
     {
-        return EMPTY;
+        const __m256i chunk    = _mm256_loadu_si256((const __m256i*)(block_p + i));
+        const __m256i brackets = _mm256_or_si256(
+            _mm256_or_si256(AVX2_EQ(chunk, '{'), AVX2_EQ(chunk, '}')),
+            _mm256_or_si256(AVX2_EQ(chunk, '['), AVX2_EQ(chunk, ']')));
+        const __m256i structural
+            = _mm256_or_si256(brackets, _mm256_or_si256(AVX2_EQ(chunk, ','), AVX2_EQ(chunk, ':')));
+        const __m256i whitespace = _mm256_or_si256(
+            _mm256_or_si256(AVX2_EQ(chunk, ' '), AVX2_EQ(chunk, '\n')),
+            _mm256_or_si256(AVX2_EQ(chunk, '\r'), AVX2_EQ(chunk, '\t')));
+        const __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, control_max), chunk);
+        out_masks_p->quote |= AVX2_MASK(AVX2_EQ(chunk, '"')) << i;
+        out_masks_p->backslash |= AVX2_MASK(AVX2_EQ(chunk, '\\')) << i;
+        out_masks_p->structural |= AVX2_MASK(structural) << i;
+        out_masks_p->whitespace |= AVX2_MASK(whitespace) << i;
+        out_masks_p->control |= AVX2_MASK(control) << i;
     }
-    else if (initial_char_p[0] == '"')
+}
+#endif /* __x86_64__ || __i386__ */
+
+static JsonClassifyFn _classify_block   = _classify_block_scalar;
+static pthread_once_t _classify_once_ctl = PTHREAD_ONCE_INIT;
+
+// Pick the widest classifier supported by the CPU we are running on.
+static void _classify_block_select(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
     {
-        return STRING;
+        _classify_block = _classify_block_avx2;
     }
-    else if (strncmp(initial_char_p, "true", 4) == 0)
+    else if (__builtin_cpu_supports("sse4.2"))
     {
-        return BOOLEAN_TRUE;
+        _classify_block = _classify_block_sse42;
     }
-    else if (strncmp(initial_char_p, "false", 5) == 0)
+#endif /* __x86_64__ || __i386__ */
+}
+
+// Classify the block starting at `curr_p`. Bytes past the end of the input are zero-padded, hence
+// they look like control chars and stop any scan.
+static void _JsonTokenizer_load_block(JsonTokenizer* tokenizer_p, const char* curr_p)
+{
+    const size_t remaining = (size_t)(tokenizer_p->end_p - curr_p);
+    if (remaining >= JSON_BLOCK_SIZE)
     {
-        return BOOLEAN_FALSE;
+        _classify_block(curr_p, &tokenizer_p->block_masks);
     }
     else
     {
-        return NUMBER;
+        char padded_block[JSON_BLOCK_SIZE] = {0};
+        memcpy(padded_block, curr_p, remaining);
+        _classify_block(padded_block, &tokenizer_p->block_masks);
     }
+    tokenizer_p->block_p = curr_p;
 }
 
-static char* _strip_whitespace_malloc(const char* json_cstr)
+// Return the masks of the input starting at `curr_p`, with bit 0 referring to `curr_p`, and the
+// number of bytes they describe. The current block is reused as long as `curr_p` falls inside it.
+static inline size_t _JsonTokenizer_masks(
+    JsonTokenizer* tokenizer_p,
+    const char* curr_p,
+    JsonBlockMasks* out_masks_p)
 {
-    // The returned string cannot be longer than the input string (plus an termination char).
-    char* ret_str;
-    const size_t str_len = strlen(json_cstr);
-    ret_str              = my_memory_malloc(__FILENAME__, __LINE__, str_len + 1);
-
-    size_t pos_out     = 0;
-    bool inside_string = false;
-    for (size_t pos_in = 0; pos_in < str_len; pos_in++)
+    size_t offset = (size_t)(curr_p - tokenizer_p->block_p);
+    if (offset >= JSON_BLOCK_SIZE)
     {
-        char curr_char = json_cstr[pos_in];
-        // "Open/Close" a string.
-        if (curr_char == '\"')
-        { // TODO: check how it works if the value contains an escaped '\"'
-            inside_string = !inside_string;
-        }
-        // Ignore everything outside a string that is not printable or is a space (ascii 32).
-        if (inside_string || (curr_char > 32))
-        {
-            ret_str[pos_out++] = json_cstr[pos_in];
-        }
+        _JsonTokenizer_load_block(tokenizer_p, curr_p);
+        offset = 0;
     }
-    ret_str[pos_out] = '\0';
-    return ret_str;
+    out_masks_p->quote      = tokenizer_p->block_masks.quote >> offset;
+    out_masks_p->backslash  = tokenizer_p->block_masks.backslash >> offset;
+    out_masks_p->structural = tokenizer_p->block_masks.structural >> offset;
+    out_masks_p->whitespace = tokenizer_p->block_masks.whitespace >> offset;
+    out_masks_p->control    = tokenizer_p->block_masks.control >> offset;
+    return JSON_BLOCK_SIZE - offset;
 }
 
-static char* _terminate_str(char* char_p)
+static void _JsonTokenizer_init(JsonTokenizer* tokenizer_p, const char* json_p, size_t json_len)
 {
-    while ((char_p != NULL) && (char_p + 1 != NULL))
-    {
-        if (*char_p == '"')
-        {
-            char_p++;
-            if ((*char_p == ',') || (*char_p == '}') || (*char_p == ']') || (*char_p == ':'))
-            {
-                *(char_p - 1) = '\0';
-                // return the position following the str termination
-                return char_p;
-            }
-        }
-        else
-        {
-            char_p++;
-        }
-    }
-    return NULL;
+    pthread_once(&_classify_once_ctl, _classify_block_select);
+    tokenizer_p->begin_p = json_p;
+    tokenizer_p->curr_p  = json_p;
+    tokenizer_p->end_p   = json_p + json_len;
+    tokenizer_p->expect  = EXPECT_VALUE;
+    tokenizer_p->depth        = 0;
+    tokenizer_p->max_depth    = JSON_MAX_DEPTH;
+    tokenizer_p->partial      = false;
+    tokenizer_p->cut_string_p = NULL;
+    _JsonTokenizer_load_block(tokenizer_p, json_p);
 }
 
-static char* _generate_tokens_malloc(char* json_cstr)
+static inline const char* _JsonTokenizer_skip_whitespace(
+    JsonTokenizer* tokenizer_p,
+    const char* curr_p)
 {
-    char* ret_str;
-    size_t str_len     = strlen(json_cstr);
-    ret_str            = my_memory_malloc(__FILENAME__, __LINE__, str_len + 1);
-    size_t pos_out     = 0;
-    bool inside_string = false;
-    for (size_t pos_in = 0; pos_in < str_len; pos_in++)
+    JsonBlockMasks masks;
+    // Minified input has no whitespace at all: avoid looking at the masks in that case.
+    if ((curr_p < tokenizer_p->end_p) && !_is_whitespace(*curr_p))
     {
-        char curr_char = json_cstr[pos_in];
-        // "Open/Close" a string.
-        if (curr_char == '\"')
-        {
-            inside_string = !inside_string;
-        }
-        // Ignore tokens found inside a string unless it's the '\"", hence end of the string.
-        if ((_is_token(curr_char) && !inside_string) || curr_char == '"')
+        return curr_p;
+    }
+    while (curr_p < tokenizer_p->end_p)
+    {
+        const size_t available        = _JsonTokenizer_masks(tokenizer_p, curr_p, &masks);
+        const uint64_t non_whitespace = ~masks.whitespace;
+        if ((non_whitespace != 0) && ((size_t)__builtin_ctzll(non_whitespace) < available))
         {
-            ret_str[pos_out++] = json_cstr[pos_in];
+            return curr_p + __builtin_ctzll(non_whitespace);
         }
+        curr_p += available;
     }
-    ret_str[pos_out] = '\0';
-    return ret_str;
+    return tokenizer_p->end_p;
 }
 
-static Error _validate_tokens(char* json_char_p)
+// Return the length of the escape sequence at `curr_p`, or 0 if invalid. A sequence cut by `end_p`
+// may look longer than the input left.
+static size_t _json_escape_len(const char* curr_p, const char* end_p)
 {
-    Error ret_res                  = ERR_ALL_GOOD;
-    unsigned long long obj_counter = 0;
-    unsigned long long arr_counter = 0;
-    char curr_char;
-    for (size_t index = 0; json_char_p[index] != 0; index++)
+    if (curr_p + 1 == end_p)
     {
-        curr_char = json_char_p[index];
-        if (curr_char == '[')
-        {
-            arr_counter++;
-        }
-        else if (curr_char == ']')
-        {
-            if (arr_counter > 0)
-            {
-                arr_counter--;
-            }
-            else
-            {
-                LOG_ERROR("Extra `]` detected");
-                return ERR_JSON_INVALID;
-            }
-        }
-        if (curr_char == '{')
-        {
-            obj_counter++;
-        }
-        else if (curr_char == '}')
+        return 2;
+    }
+    switch (curr_p[1])
+    {
+    case '"':
+    case '\\':
+    case '/':
+    case 'b':
+    case 'f':
+    case 'n':
+    case 'r':
+    case 't':
+        return 2;
+    case 'u':
+        for (const char* hex_p = curr_p + 2; (hex_p < curr_p + 6) && (hex_p < end_p); hex_p++)
         {
-            if (obj_counter > 0)
-            {
-                obj_counter--;
-            }
-            else
+            if (!isxdigit((unsigned char)*hex_p))
             {
-                LOG_ERROR("Extra `}` detected");
-                return ERR_JSON_INVALID;
+                return 0;
             }
         }
+        return 6;
+    default:
+        return 0;
     }
-    if (arr_counter)
-    {
-        LOG_ERROR("Missing `]` detected");
-        return ERR_JSON_INVALID;
-    }
-    if (obj_counter)
+}
+
+// Remember where the scan of the string whose content starts at `string_p` stopped, if more input
+// can follow.
+static inline void _JsonTokenizer_cut_string(
+    JsonTokenizer* tokenizer_p,
+    const char* string_p,
+    const char* scan_p,
+    bool has_escapes)
+{
+    if (tokenizer_p->partial)
     {
-        LOG_ERROR("Missing `}` detected");
-        return ERR_JSON_INVALID;
+        tokenizer_p->cut_string_p    = string_p;
+        tokenizer_p->cut_scan_p      = scan_p;
+        tokenizer_p->cut_has_escapes = has_escapes;
     }
-    return ret_res;
 }
 
-Error _deserialize(const char* file, const int line, JsonItem* curr_item_p, char** start_pos_p)
+// Return the position of the quote closing the string whose content starts at `string_p`, `end_p`
+// if the input ends first, or NULL if the string contains control characters or invalid escape
+// sequences. Whether it contains any escape sequence is stored at `out_has_escapes_p`.
+static const char* _JsonTokenizer_scan_string(
+    JsonTokenizer* tokenizer_p,
+    const char* string_p,
+    bool* out_has_escapes_p)
 {
-    char* curr_pos_p = *start_pos_p;
-    bool parent_set  = false;
-    Error ret_result = ERR_ALL_GOOD;
-    while ((curr_pos_p[0] != '\0') && (curr_pos_p[1] != '\0'))
+    JsonBlockMasks masks;
+    const char* curr_p = string_p;
+    *out_has_escapes_p = false;
+    if (tokenizer_p->cut_string_p == string_p)
     {
-        if ((curr_pos_p[0] == '}') || (curr_pos_p[0] == ']'))
+        curr_p                    = tokenizer_p->cut_scan_p;
+        *out_has_escapes_p        = tokenizer_p->cut_has_escapes;
+        tokenizer_p->cut_string_p = NULL;
+    }
+    while (curr_p < tokenizer_p->end_p)
+    {
+        const size_t available = _JsonTokenizer_masks(tokenizer_p, curr_p, &masks);
+        const uint64_t stop    = masks.quote | masks.backslash | masks.control;
+        if (stop == 0)
         {
-            // Use continue to make sure the next 2 chars are checked.
-            curr_pos_p++;
-            curr_item_p = curr_item_p->parent;
+            curr_p += available;
             continue;
         }
-        if (curr_pos_p[0] == '[')
+        curr_p += __builtin_ctzll(stop);
+        if (curr_p >= tokenizer_p->end_p)
         {
-            LOG_TRACE("Found beginning of array.");
-            JsonItem* new_item               = _JsonItem_new(file, line);
-            new_item->parent                 = curr_item_p;
-            curr_item_p->value.value_type    = VALUE_ARRAY;
-            curr_item_p->value.value_child_p = new_item;
-            curr_pos_p++;
-
-            curr_item_p = new_item;
-            continue;
+            break;
         }
-        if ((curr_item_p->parent->value.value_type == VALUE_ARRAY) && (*curr_pos_p == ','))
+        if (*curr_p == '"')
         {
-            // This is a sibling of an array.
-            LOG_TRACE("Found sibling in array.");
-            JsonItem* new_item        = _JsonItem_new(file, line);
-            new_item->index           = curr_item_p->index + 1;
-            new_item->parent          = curr_item_p->parent;
-            curr_item_p->next_sibling = new_item;
-            curr_pos_p++;
-            curr_item_p = new_item;
-            continue;
+            return curr_p;
         }
-        // If we are here, it's an item. If its parent is of type VALUE_ARRAY, we need to increment
-        // the index, somehow.
-        switch (_get_value_type(curr_pos_p))
-        {
-        case NUMBER:
-        {
-            // 23 digits should be sufficient.
-            char num_buff[MAX_NUM_LEN];
-            // Try to convert into an integer or a double, depending on the presence of a dot ('.').
-            bool dot_found = false;
-            llu_t i        = 0;
-            // Create a substring containing the number.
-            for (; (i < MAX_NUM_LEN - 1) && (*curr_pos_p != ',') && (*curr_pos_p != '}')
-                   && (*curr_pos_p != ']');
-                 i++)
-            {
-                if (*curr_pos_p == '.')
-                {
-                    dot_found = true;
-                }
-                num_buff[i] = *curr_pos_p;
-                curr_pos_p++;
-            }
-            // Null terminate the string.
-            num_buff[i] = '\0';
-            if (dot_found)
-            {
-                double parsed_double = 0.0f;
-                ret_result           = numparser_cstr_to_double(num_buff, &parsed_double, '\0');
-                if (is_ok(ret_result))
-                {
-                    curr_item_p->value.value_type   = VALUE_DOUBLE;
-                    curr_item_p->value.value_double = parsed_double;
-                    LOG_TRACE("Found value %lf", curr_item_p->value.value_double);
-                }
-            }
-            else if (num_buff[0] == '-')
-            { // Convert into an integer if it is negative.
-                lld_t parsed_lld = 0;
-                ret_result       = numparser_cstr_to_lld(num_buff, &parsed_lld, '\0');
-                if (is_ok(ret_result))
-                {
-                    curr_item_p->value.value_type = VALUE_LLD;
-                    curr_item_p->value.value_lld  = parsed_lld;
-                    LOG_TRACE("Found value %lld", parsed_lld);
-                }
-            }
-            else
-            {
-                // Convert any positive value into a size_t.
-                llu_t parsed_llu = 0;
-                ret_result       = numparser_cstr_to_llu(num_buff, &parsed_llu, '\0');
-                if (is_ok(ret_result))
-                {
-                    curr_item_p->value.value_type = VALUE_LLU;
-                    curr_item_p->value.value_llu  = parsed_llu;
-                    LOG_TRACE("Found LLU value %llu", parsed_llu);
-                }
-            }
-            break;
+        if (*curr_p != '\\')
+        {
+            return NULL;
         }
-        case STRING:
+        // Skip the escape sequence so that `\"` does not close the string.
+        const size_t escape_len = _json_escape_len(curr_p, tokenizer_p->end_p);
+        if (escape_len == 0)
         {
-            curr_item_p->value.value_type = VALUE_CSTR;
-            curr_item_p->value.value_cstr = curr_pos_p + 1; // Point after the quote
-            curr_pos_p                    = _terminate_str(curr_pos_p);
-            LOG_TRACE("Found value \"%s\"", curr_item_p->value.value_cstr);
-            break;
+            return NULL;
         }
-        case KEY:
+        if (escape_len >= (size_t)(tokenizer_p->end_p - curr_p))
         {
-            if (*curr_pos_p == '{')
-            {
-                if (parent_set)
-                {
-                    // It's a child
-                    LOG_TRACE("Found new object");
-                    JsonItem* new_item               = _JsonItem_new(file, line);
-                    new_item->parent                 = curr_item_p;
-                    curr_item_p->value.value_type    = VALUE_ITEM;
-                    curr_item_p->value.value_child_p = new_item;
-                    curr_item_p                      = new_item;
-                }
-                else
-                {
-                    parent_set = true;
-                }
-            }
-            else if (*curr_pos_p == ',')
-            {
-                // It's a sibling - the parent must be in common.
-                JsonItem* new_item        = _JsonItem_new(file, line);
-                curr_item_p->next_sibling = new_item;
-                new_item->parent          = curr_item_p->parent;
-                curr_item_p               = new_item;
-            }
-            // Extract the key for the new item.
-            curr_pos_p         = curr_pos_p + 2; // That's where the key starts
-            curr_item_p->key_p = curr_pos_p;
-            curr_pos_p         = _terminate_str(curr_pos_p); // We should be at ':' now.
-            LOG_TRACE("Found key: \"%s\"", curr_item_p->key_p);
-            if (*curr_pos_p != ':')
-            {
-                LOG_ERROR("Something bad happened");
-                exit(ERR_FATAL);
-            }
-            curr_pos_p++; // Skip the ':'.
             break;
         }
-        case BOOLEAN_TRUE:
+        *out_has_escapes_p = true;
+        curr_p += escape_len;
+    }
+    // A cut escape sequence is scanned again from its backslash.
+    _JsonTokenizer_cut_string(
+        tokenizer_p,
+        string_p,
+        (curr_p < tokenizer_p->end_p) ? curr_p : tokenizer_p->end_p,
+        *out_has_escapes_p);
+    return tokenizer_p->end_p;
+}
+
+// Append the digit `c` to the number, or account for it in the exponent once the mantissa is full.
+static inline void _JsonNumber_push_digit(JsonNumber* number_p, char c, bool is_fraction)
+{
+    uint64_t mantissa;
+    if (!number_p->is_truncated && !__builtin_mul_overflow(number_p->mantissa, 10, &mantissa)
+        && !__builtin_add_overflow(mantissa, (uint64_t)(c - '0'), &mantissa))
+    {
+        number_p->mantissa = mantissa;
+        number_p->exponent -= is_fraction;
+        return;
+    }
+    number_p->is_truncated = true;
+    number_p->exponent += !is_fraction;
+}
+
+// Return the position following the number starting at `curr_p`, or NULL if it is malformed. The
+// digits are collected into `out_number_p` along the way, hence the number is never read again.
+static const char* _scan_number(const char* curr_p, const char* end_p, JsonNumber* out_number_p)
+{
+    out_number_p->mantissa     = 0;
+    out_number_p->exponent     = 0;
+    out_number_p->is_negative  = false;
+    out_number_p->is_integer   = true;
+    out_number_p->is_truncated = false;
+    if ((curr_p < end_p) && (*curr_p == '-'))
+    {
+        out_number_p->is_negative = true;
+        curr_p++;
+    }
+    if ((curr_p == end_p) || !_is_digit(*curr_p))
+    {
+        return NULL;
+    }
+    if (*curr_p == '0')
+    {
+        curr_p++;
+    }
+    else
+    {
+        while ((curr_p < end_p) && _is_digit(*curr_p))
         {
-            curr_pos_p += 4;
-            // Null terminate the string.
-            curr_item_p->value.value_type = VALUE_BOOL;
-            curr_item_p->value.value_bool = true;
-            LOG_TRACE("Found value TRUE");
-            break;
+            _JsonNumber_push_digit(out_number_p, *curr_p++, false);
         }
-        case BOOLEAN_FALSE:
+    }
+    if ((curr_p < end_p) && (*curr_p == '.'))
+    {
+        out_number_p->is_integer = false;
+        curr_p++;
+        if ((curr_p == end_p) || !_is_digit(*curr_p))
         {
-            curr_pos_p += 5;
-            // Null terminate the string.
-            curr_item_p->value.value_type = VALUE_BOOL;
-            curr_item_p->value.value_bool = false;
-            LOG_TRACE("Found value FALSE");
-            break;
+            return NULL;
         }
-        case EMPTY:
+        while ((curr_p < end_p) && _is_digit(*curr_p))
         {
-            LOG_TRACE("Found empty object - skipping");
-            curr_pos_p += 2;
-            break;
+            _JsonNumber_push_digit(out_number_p, *curr_p++, true);
         }
-        case INVALID:
+    }
+    if ((curr_p < end_p) && ((*curr_p == 'e') || (*curr_p == 'E')))
+    {
+        out_number_p->is_integer = false;
+        curr_p++;
+        bool is_exponent_negative = false;
+        if ((curr_p < end_p) && ((*curr_p == '+') || (*curr_p == '-')))
         {
-            LOG_ERROR("TODO: handle this");
-            exit(3);
+            is_exponent_negative = (*curr_p == '-');
+            curr_p++;
         }
-
-        default:
-            break;
+        if ((curr_p == end_p) || !_is_digit(*curr_p))
+        {
+            return NULL;
         }
-        if (is_err(ret_result))
+        int64_t exponent = 0;
+        while ((curr_p < end_p) && _is_digit(*curr_p))
         {
-            return ERR_JSON_INVALID;
+            // Way past the range of a double: more digits would not change the result.
+            if (exponent < JSON_MAX_EXPONENT)
+            {
+                exponent = 10 * exponent + (*curr_p - '0');
+            }
+            curr_p++;
         }
+        out_number_p->exponent += is_exponent_negative ? -exponent : exponent;
     }
-    return ERR_ALL_GOOD;
+    return curr_p;
 }
 
-Error _JsonObj_new(
-    const char* file,
-    const int line,
-    const char* json_cstr,
-    JsonObj* out_json_obj_p)
+static inline bool _JsonTokenizer_in_object(const JsonTokenizer* tokenizer_p)
+{
+    const size_t level = tokenizer_p->depth - 1;
+    return (tokenizer_p->container_stack[level / 8] >> (level % 8)) & 1;
+}
+
+static inline bool _JsonTokenizer_push(JsonTokenizer* tokenizer_p, bool is_object)
 {
-    Error ret_err                      = ERR_ALL_GOOD;
-    char* trimmed_json_cstr            = NULL;
-    char* curr_pos_p                   = NULL;
-    __autofree_cstr__ char* token_cstr = NULL;
-    if (strlen(json_cstr) == 0)
+    const size_t level = tokenizer_p->depth;
+    if (level == tokenizer_p->max_depth)
     {
-        LOG_ERROR("Empty JSON string detected");
-        return ERR_EMPTY_STRING;
+        LOG_ERROR("Maximum nesting level (%zu) exceeded", (size_t)JSON_MAX_DEPTH);
+        return false;
     }
-    trimmed_json_cstr = _strip_whitespace_malloc(json_cstr);
-    if ((trimmed_json_cstr[0] != '{') /*&& (*out_json_obj_pp->json_cstr.str[0] != '[')*/)
+    if (is_object)
     {
-        // TODO: Handle case in which the JSON string starts with [{ (array of objects).
-        LOG_ERROR("Invalid JSON string.");
-        my_memory_free(trimmed_json_cstr);
-        return ERR_JSON_INVALID;
+        tokenizer_p->container_stack[level / 8] |= (uint8_t)(1 << (level % 8));
     }
-    token_cstr = _generate_tokens_malloc(trimmed_json_cstr);
-    ret_err    = _validate_tokens(token_cstr);
-    if (is_err(ret_err))
+    else
     {
-        my_memory_free(trimmed_json_cstr);
-        LOG_ERROR("Invalid JSON string detected.");
-        return ret_err;
+        tokenizer_p->container_stack[level / 8] &= (uint8_t) ~(1 << (level % 8));
     }
-    out_json_obj_p->json_cstr = trimmed_json_cstr;
+    tokenizer_p->depth++;
+    return true;
+}
 
-    curr_pos_p = out_json_obj_p->json_cstr; // position analyzed (iterator)
-    // Create a dummy root item as the entry point of the JSON object. The first actual item is the
-    // first sibling of root. This prevents root's value type from being overwritten, hence causing
-    // errors.
-    out_json_obj_p->root.value.value_type = VALUE_ROOT;
-    out_json_obj_p->root.parent
-        = &out_json_obj_p->root; // Set the parent to itself to recognize 'root'.
-    JsonItem* new_item                = _JsonItem_new(file, line);
-    out_json_obj_p->root.next_sibling = new_item;
-    new_item->parent                  = out_json_obj_p->root.parent;
+static inline JsonTokenType _JsonTokenizer_invalid(JsonTokenizer* tokenizer_p, const char* curr_p)
+{
+    tokenizer_p->curr_p = curr_p;
+    tokenizer_p->expect = EXPECT_ERROR;
+    return TOKEN_INVALID;
+}
 
-    LOG_DEBUG("JSON deserialization started.");
-    if (is_err(_deserialize(file, line, out_json_obj_p->root.next_sibling, &curr_pos_p)))
+// Report a token cut by the end of the input, which is only an error if no more input can follow.
+static inline JsonTokenType _JsonTokenizer_truncated(
+    JsonTokenizer* tokenizer_p,
+    const char* curr_p,
+    JsonToken* out_token_p)
+{
+    if (!tokenizer_p->partial)
     {
-        JsonObj_destroy(out_json_obj_p);
-        LOG_ERROR("Failed to deserialize JSON");
-        return ERR_JSON_INVALID;
+        return _JsonTokenizer_invalid(tokenizer_p, curr_p);
     }
-    LOG_DEBUG("JSON deserialization ended successfully.")
-
-    return ERR_ALL_GOOD;
+    out_token_p->type = TOKEN_INCOMPLETE;
+    return TOKEN_INCOMPLETE;
 }
 
-void _JsonItem_destroy(JsonItem* json_item)
+// Whether the input from `curr_p` to its end can be the beginning of a number.
+static inline bool _is_number_prefix(const char* curr_p, const char* end_p)
 {
-    if (json_item == NULL)
+    while ((curr_p < end_p)
+           && (_is_digit(*curr_p) || (*curr_p == '-') || (*curr_p == '+') || (*curr_p == '.')
+               || (*curr_p == 'e') || (*curr_p == 'E')))
     {
-        return;
+        curr_p++;
     }
-    if (json_item->value.value_type != VALUE_UNDEFINED)
+    return curr_p == end_p;
+}
+
+// Close the innermost container and set what is expected after it.
+static inline JsonTokenType _JsonTokenizer_pop(
+    JsonTokenizer* tokenizer_p,
+    const char* curr_p,
+    JsonToken* out_token_p)
+{
+    const bool in_object = _JsonTokenizer_in_object(tokenizer_p);
+    out_token_p->type    = in_object ? TOKEN_OBJECT_END : TOKEN_ARRAY_END;
+    out_token_p->start_p = curr_p;
+    out_token_p->len     = 1;
+    tokenizer_p->depth--;
+    tokenizer_p->expect = tokenizer_p->depth ? EXPECT_COMMA_OR_END : EXPECT_NOTHING;
+    tokenizer_p->curr_p = curr_p + 1;
+    return out_token_p->type;
+}
+
+static JsonTokenType _JsonTokenizer_read_value(
+    JsonTokenizer* tokenizer_p,
+    const char* curr_p,
+    JsonToken* out_token_p)
+{
+    const char* end_p       = tokenizer_p->end_p;
+    const char* token_end_p = NULL;
+    out_token_p->start_p    = curr_p;
+    switch (*curr_p)
     {
-        if (json_item->value.value_type == VALUE_ITEM)
+    case '{':
+        if (!_JsonTokenizer_push(tokenizer_p, true))
         {
-            _JsonItem_destroy(json_item->value.value_child_p);
+            return _JsonTokenizer_invalid(tokenizer_p, curr_p);
         }
-        if (json_item->value.value_type == VALUE_ARRAY)
+        out_token_p->type   = TOKEN_OBJECT_BEGIN;
+        out_token_p->len    = 1;
+        tokenizer_p->expect = EXPECT_KEY_OR_OBJECT_END;
+        tokenizer_p->curr_p = curr_p + 1;
+        return TOKEN_OBJECT_BEGIN;
+    case '[':
+        if (!_JsonTokenizer_push(tokenizer_p, false))
         {
-            _JsonItem_destroy(json_item->value.value_child_p);
+            return _JsonTokenizer_invalid(tokenizer_p, curr_p);
         }
-    }
-    if (json_item->next_sibling != NULL)
+        out_token_p->type   = TOKEN_ARRAY_BEGIN;
+        out_token_p->len    = 1;
+        tokenizer_p->expect = EXPECT_VALUE_OR_ARRAY_END;
+        tokenizer_p->curr_p = curr_p + 1;
+        return TOKEN_ARRAY_BEGIN;
+    case '"':
+        token_end_p
+            = _JsonTokenizer_scan_string(tokenizer_p, curr_p + 1, &out_token_p->has_escapes);
+        if (token_end_p == NULL)
+        {
+            return _JsonTokenizer_invalid(tokenizer_p, curr_p);
+        }
+        if (token_end_p == end_p)
+        {
+            return _JsonTokenizer_truncated(tokenizer_p, curr_p, out_token_p);
+        }
+        out_token_p->type    = TOKEN_STRING;
+        out_token_p->start_p = curr_p + 1;
+        out_token_p->len     = (size_t)(token_end_p - curr_p - 1);
+        token_end_p++; // Skip the closing quote.
+        break;
+    case 't':
+    case 'f':
+    case 'n':
     {
-        _JsonItem_destroy(json_item->next_sibling);
+        const char* literal    = (*curr_p == 't') ? "true" : (*curr_p == 'f') ? "false" : "null";
+        const size_t len       = strlen(literal);
+        const size_t available = (size_t)(end_p - curr_p);
+        if ((available < len) && (memcmp(curr_p, literal, available) == 0))
+        {
+            return _JsonTokenizer_truncated(tokenizer_p, curr_p, out_token_p);
+        }
+        if ((available < len) || (memcmp(curr_p, literal, len) != 0))
+        {
+            return _JsonTokenizer_invalid(tokenizer_p, curr_p);
+        }
+        out_token_p->type = (*curr_p == 't') ? TOKEN_TRUE
+                          : (*curr_p == 'f') ? TOKEN_FALSE
+                                             : TOKEN_NULL;
+        token_end_p       = curr_p + len;
+        break;
+    }
+    default:
+        token_end_p = _scan_number(curr_p, end_p, &out_token_p->number);
+        // A number reaching the end of partial input may go on.
+        if (((token_end_p == NULL) || (token_end_p == end_p)) && tokenizer_p->partial
+            && _is_number_prefix(curr_p, end_p))
+        {
+            return _JsonTokenizer_truncated(tokenizer_p, curr_p, out_token_p);
+        }
+        if (token_end_p == NULL)
+        {
+            return _JsonTokenizer_invalid(tokenizer_p, curr_p);
+        }
+        out_token_p->type = TOKEN_NUMBER;
+        break;
     }
-    json_item->value.value_type = VALUE_UNDEFINED;
-    if (json_item != json_item->parent)
+    if (out_token_p->type != TOKEN_STRING)
     {
-        my_memory_free(json_item);
+        out_token_p->len = (size_t)(token_end_p - curr_p);
     }
-    json_item = NULL;
+    tokenizer_p->expect = tokenizer_p->depth ? EXPECT_COMMA_OR_END : EXPECT_NOTHING;
+    tokenizer_p->curr_p = token_end_p;
+    return out_token_p->type;
 }
 
-void JsonObj_destroy(JsonObj* json_obj_p)
+static JsonTokenType _JsonTokenizer_read_key(
+    JsonTokenizer* tokenizer_p,
+    const char* curr_p,
+    JsonToken* out_token_p)
 {
-    if (json_obj_p == NULL)
+    const char* end_p = tokenizer_p->end_p;
+    const char* key_end_p;
+    if (*curr_p != '"')
     {
-        return;
+        return _JsonTokenizer_invalid(tokenizer_p, curr_p);
+    }
+    key_end_p = _JsonTokenizer_scan_string(tokenizer_p, curr_p + 1, &out_token_p->has_escapes);
+    if (key_end_p == NULL)
+    {
+        return _JsonTokenizer_invalid(tokenizer_p, curr_p);
+    }
+    if (key_end_p == end_p)
+    {
+        return _JsonTokenizer_truncated(tokenizer_p, curr_p, out_token_p);
+    }
+    out_token_p->type    = TOKEN_KEY;
+    out_token_p->start_p = curr_p + 1;
+    out_token_p->len     = (size_t)(key_end_p - curr_p - 1);
+    curr_p               = _JsonTokenizer_skip_whitespace(tokenizer_p, key_end_p + 1);
+    if (curr_p == end_p)
+    {
+        // The key will be read again up to the colon: only its closing quote is looked at again.
+        _JsonTokenizer_cut_string(
+            tokenizer_p, out_token_p->start_p, key_end_p, out_token_p->has_escapes);
+        return _JsonTokenizer_truncated(tokenizer_p, curr_p, out_token_p);
     }
-    if (json_obj_p->root.value.value_type != VALUE_UNDEFINED)
+    if (*curr_p != ':')
     {
-        _JsonItem_destroy(&json_obj_p->root);
+        return _JsonTokenizer_invalid(tokenizer_p, curr_p);
     }
-    my_memory_free(json_obj_p->json_cstr);
-    json_obj_p->json_cstr = NULL;
-    json_obj_p            = NULL;
+    tokenizer_p->expect = EXPECT_VALUE;
+    tokenizer_p->curr_p = curr_p + 1;
+    return TOKEN_KEY;
 }
 
-#define OBJ_GET_VALUE_c(suffix, value_token, out_type, ACTION)                      \
-    Error obj_get_##suffix(const JsonObj* obj, const char* key, out_type out_value) \
-    {                                                                               \
-        if (obj)                                                                    \
-        {                                                                           \
-            return get_##suffix(obj->root.next_sibling, key, out_value);            \
-        }                                                                           \
-        else                                                                        \
-        {                                                                           \
-            return ERR_NULL;                                                        \
-        }                                                                           \
+// Return the next token, or TOKEN_END once the top-level value is complete. On TOKEN_INVALID,
+// `tokenizer_p->curr_p` points to the offending char.
+static JsonTokenType _JsonTokenizer_next(JsonTokenizer* tokenizer_p, JsonToken* out_token_p)
+{
+    const char* end_p  = tokenizer_p->end_p;
+    const char* curr_p = _JsonTokenizer_skip_whitespace(tokenizer_p, tokenizer_p->curr_p);
+    if (curr_p == end_p)
+    {
+        if (tokenizer_p->expect == EXPECT_NOTHING)
+        {
+            tokenizer_p->curr_p = curr_p;
+            out_token_p->type   = TOKEN_END;
+            return TOKEN_END;
+        }
+        return _JsonTokenizer_truncated(tokenizer_p, curr_p, out_token_p);
     }
-
-#define GET_VALUE_c(suffix, value_token, out_type, ACTION)                           \
-    Error get_##suffix(const JsonItem* item, const char* key, out_type out_value)    \
-    {                                                                                \
-        if (item == NULL)                                                            \
-        {                                                                            \
-            *out_value = NULL;                                                       \
-            LOG_ERROR("Input item is NULL - key `%s`.", key);                        \
-            return ERR_JSON_MISSING_ENTRY;                                           \
-        }                                                                            \
-        if (!item->key_p)                                                            \
-        {                                                                            \
-            return ERR_NULL;                                                         \
-        }                                                                            \
-        if (!strcmp(item->key_p, key))                                               \
-        {                                                                            \
-            if (item->value.value_type == value_token)                               \
-            {                                                                        \
-                *out_value = item->value.suffix;                                     \
-                ACTION;                                                              \
-                return ERR_ALL_GOOD;                                                 \
-            }                                                                        \
-            else                                                                     \
-            {                                                                        \
-                LOG_ERROR("Requested " #value_token " for a different value type."); \
-                return ERR_TYPE_MISMATCH;                                            \
-            }                                                                        \
-        }                                                                            \
-        else                                                                         \
-        {                                                                            \
-            return get_##suffix(item->next_sibling, key, out_value);                 \
-        }                                                                            \
+    switch (tokenizer_p->expect)
+    {
+    case EXPECT_COMMA_OR_END:
+        if (*curr_p == ',')
+        {
+            curr_p = _JsonTokenizer_skip_whitespace(tokenizer_p, curr_p + 1);
+            if (curr_p == end_p)
+            {
+                return _JsonTokenizer_truncated(tokenizer_p, curr_p, out_token_p);
+            }
+            if (_JsonTokenizer_in_object(tokenizer_p))
+            {
+                return _JsonTokenizer_read_key(tokenizer_p, curr_p, out_token_p);
+            }
+            return _JsonTokenizer_read_value(tokenizer_p, curr_p, out_token_p);
+        }
+        if (*curr_p == (_JsonTokenizer_in_object(tokenizer_p) ? '}' : ']'))
+        {
+            return _JsonTokenizer_pop(tokenizer_p, curr_p, out_token_p);
+        }
+        return _JsonTokenizer_invalid(tokenizer_p, curr_p);
+    case EXPECT_KEY_OR_OBJECT_END:
+        if (*curr_p == '}')
+        {
+            return _JsonTokenizer_pop(tokenizer_p, curr_p, out_token_p);
+        }
+        return _JsonTokenizer_read_key(tokenizer_p, curr_p, out_token_p);
+    case EXPECT_KEY:
+        return _JsonTokenizer_read_key(tokenizer_p, curr_p, out_token_p);
+    case EXPECT_VALUE_OR_ARRAY_END:
+        if (*curr_p == ']')
+        {
+            return _JsonTokenizer_pop(tokenizer_p, curr_p, out_token_p);
+        }
+        return _JsonTokenizer_read_value(tokenizer_p, curr_p, out_token_p);
+    case EXPECT_VALUE:
+        return _JsonTokenizer_read_value(tokenizer_p, curr_p, out_token_p);
+    case EXPECT_NOTHING:
+    case EXPECT_ERROR:
+    default:
+        return _JsonTokenizer_invalid(tokenizer_p, curr_p);
     }
+}
 
-#define OBJ_GET_NUMBER_c(suffix, value_token, out_type, ACTION)                     \
-    Error obj_get_##suffix(const JsonObj* obj, const char* key, out_type out_value) \
-    {                                                                               \
-        return get_##suffix(obj->root.next_sibling, key, out_value);                \
+// Read the next key of an object if it is `key`, by comparing the input with it instead of scanning
+// it: `key` must have neither escapes nor control chars. Otherwise leave the tokenizer as it is.
+static bool _JsonTokenizer_match_key(
+    JsonTokenizer* tokenizer_p,
+    const char* key,
+    size_t key_len,
+    JsonToken* out_token_p)
+{
+    const char* end_p  = tokenizer_p->end_p;
+    const char* curr_p = _JsonTokenizer_skip_whitespace(tokenizer_p, tokenizer_p->curr_p);
+    if ((tokenizer_p->depth == 0) || !_JsonTokenizer_in_object(tokenizer_p))
+    {
+        return false;
     }
-
-#define GET_NUMBER_c(suffix, value_token, out_type, ACTION)                                   \
-    Error get_##suffix(const JsonItem* item, const char* key, out_type out_value)             \
-    {                                                                                         \
-        if (item == NULL)                                                                     \
-        {                                                                                     \
-            LOG_ERROR("Input item is NULL - key: `%s`.", key);                                \
-            return ERR_NULL;                                                                  \
-        }                                                                                     \
-        if (!item->key_p)                                                                     \
-        {                                                                                     \
-            return ERR_NULL;                                                                  \
-        }                                                                                     \
-        if (!strcmp(item->key_p, key))                                                        \
-        {                                                                                     \
-            if (item->value.value_type == value_token)                                        \
-            {                                                                                 \
-                *out_value = item->value.suffix;                                              \
-                ACTION;                                                                       \
-                return ERR_ALL_GOOD;                                                          \
-            }                                                                                 \
-            else if ((item->value.value_type == VALUE_LLD) && (value_token == VALUE_DOUBLE))  \
-            {                                                                                 \
-                LOG_WARNING("Converting int to double");                                      \
-                *out_value = (double)(1.0 * item->value.value_lld);                           \
-                ACTION;                                                                       \
-                return ERR_ALL_GOOD;                                                          \
-            }                                                                                 \
-            else if ((item->value.value_type == VALUE_LLU) && (value_token == VALUE_DOUBLE))  \
-            {                                                                                 \
-                LOG_WARNING("Converting size_t to double");                                   \
-                *out_value = (double)(1.0 * item->value.value_llu);                           \
-                ACTION;                                                                       \
-                return ERR_ALL_GOOD;                                                          \
-            }                                                                                 \
-            else if ((item->value.value_type == VALUE_LLD) && (value_token == VALUE_LLU))     \
-            {                                                                                 \
-                LOG_WARNING("Converting int to size_t");                                      \
-                if (item->value.value_lld < 0)                                                \
-                {                                                                             \
-                    LOG_ERROR(                                                                \
-                        "Impossible to convert negative int %lld into size_t",                \
-                        item->value.value_lld);                                               \
-                    LOG_ERROR("Failed to convert from INT to LLU");                           \
-                    return ERR_INVALID;                                                       \
-                };                                                                            \
-                *out_value = (llu_t)item->value.value_lld;                                    \
-                ACTION;                                                                       \
-                return ERR_ALL_GOOD;                                                          \
-            }                                                                                 \
-            else if ((item->value.value_type == VALUE_LLU) && (value_token == VALUE_LLD))     \
-            {                                                                                 \
-                LOG_WARNING("Converting size_t to int");                                      \
-                *out_value = (lld_t)item->value.value_llu;                                    \
-                /* check for overflow */                                                      \
-                if (*out_value < 0)                                                           \
-                {                                                                             \
-                    LOG_ERROR(                                                                \
-                        "Overflow while converting %llu into an lld", item->value.value_llu); \
-                    return ERR_INVALID;                                                       \
-                };                                                                            \
-                ACTION;                                                                       \
-                return ERR_ALL_GOOD;                                                          \
-            }                                                                                 \
-            else                                                                              \
-            {                                                                                 \
-                LOG_ERROR("Requested " #value_token " for a different value type.")           \
-                return ERR_TYPE_MISMATCH;                                                     \
-            }                                                                                 \
-        }                                                                                     \
-        else                                                                                  \
-        {                                                                                     \
-            return get_##suffix(item->next_sibling, key, out_value);                          \
-        }                                                                                     \
+    if (tokenizer_p->expect == EXPECT_COMMA_OR_END)
+    {
+        if ((curr_p == end_p) || (*curr_p != ','))
+        {
+            return false;
+        }
+        curr_p = _JsonTokenizer_skip_whitespace(tokenizer_p, curr_p + 1);
     }
-
-#define GET_ARRAY_VALUE_c(suffix, value_token, out_type)                                    \
-    Error get_array_##suffix(const JsonArray* json_array, size_t index, out_type out_value) \
-    {                                                                                       \
-        if (json_array == NULL)                                                             \
-        {                                                                                   \
-            LOG_ERROR("Input item is NULL");                                                \
-            return ERR_JSON_MISSING_ENTRY;                                                  \
-        }                                                                                   \
-        JsonItem* json_item = json_array->element;                                          \
-        while (true)                                                                        \
-        {                                                                                   \
-            if (json_item->index == index)                                                  \
-            {                                                                               \
-                break;                                                                      \
-            }                                                                               \
-            else if (json_item->next_sibling == NULL)                                       \
-            {                                                                               \
-                LOG_WARNING("Index %lu out of boundaries.", index);                         \
-                return ERR_NULL;                                                            \
-            }                                                                               \
-            json_item = json_item->next_sibling;                                            \
-        }                                                                                   \
-        if (json_item->value.value_type != value_token)                                     \
-        {                                                                                   \
-            LOG_ERROR(                                                                      \
-                "Incompatible data type - found %d, requested %d",                          \
-                json_item->value.value_type,                                                \
-                value_token);                                                               \
-            return ERR_TYPE_MISMATCH;                                                       \
-        }                                                                                   \
-        *out_value = json_item->value.suffix;                                               \
-        return ERR_ALL_GOOD;                                                                \
+    else if (tokenizer_p->expect != EXPECT_KEY_OR_OBJECT_END)
+    {
+        return false;
+    }
+    if (((size_t)(end_p - curr_p) < key_len + 2) || (curr_p[0] != '"')
+        || (memcmp(curr_p + 1, key, key_len) != 0) || (curr_p[key_len + 1] != '"'))
+    {
+        return false;
+    }
+    const char* colon_p = _JsonTokenizer_skip_whitespace(tokenizer_p, curr_p + key_len + 2);
+    if ((colon_p == end_p) || (*colon_p != ':'))
+    {
+        return false;
     }
+    out_token_p->type        = TOKEN_KEY;
+    out_token_p->start_p     = curr_p + 1;
+    out_token_p->len         = key_len;
+    out_token_p->has_escapes = false;
+    tokenizer_p->expect      = EXPECT_VALUE;
+    tokenizer_p->curr_p      = colon_p + 1;
+    return true;
+}
 
-// clang-format off
-OBJ_GET_VALUE_c(value_cstr, VALUE_CSTR, const char**, )
-OBJ_GET_VALUE_c(value_child_p, VALUE_ITEM, JsonItem**, )
-OBJ_GET_VALUE_c(
-    value_array_p,
-    VALUE_ARRAY,
-    JsonArray**,
-    (*out_value)->element = item->value.value_child_p)
+// Powers of 10 represented exactly by a double.
+#define JSON_MAX_EXACT_POW10 (22)
+static const double _json_exact_pow10[JSON_MAX_EXACT_POW10 + 1] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
 
-OBJ_GET_NUMBER_c(value_lld, VALUE_LLD, lld_t*, )
-OBJ_GET_NUMBER_c(value_llu, VALUE_LLU, llu_t*, )
-OBJ_GET_NUMBER_c(value_double, VALUE_DOUBLE, double*, )
-OBJ_GET_NUMBER_c(value_bool, VALUE_BOOL, bool*, )
+#define JSON_MAX_EXACT_MANTISSA ((uint64_t)1 << 53)
 
-GET_VALUE_c(value_cstr, VALUE_CSTR, const char**, )
-GET_VALUE_c(value_child_p, VALUE_ITEM, JsonItem**, )
-GET_VALUE_c(
-    value_array_p,
-    VALUE_ARRAY,
-    JsonArray**,
-    (*out_value)->element = item->value.value_child_p)
+// Convert the number when both the mantissa and the power of 10 are exact doubles: a single
+// multiplication or division then rounds correctly (Clinger's fast path).
+static bool _JsonNumber_to_double_fast(const JsonNumber* number_p, double* out_double_p)
+{
+    uint64_t mantissa = number_p->mantissa;
+    int64_t exponent  = number_p->exponent;
+    if (number_p->is_truncated || (mantissa > JSON_MAX_EXACT_MANTISSA))
+    {
+        return false;
+    }
+    // Move the excess of a large exponent into the mantissa, as long as it stays exact.
+    while ((exponent > JSON_MAX_EXACT_POW10) && (mantissa <= JSON_MAX_EXACT_MANTISSA / 10))
+    {
+        mantissa *= 10;
+        exponent--;
+    }
+    if ((exponent < -JSON_MAX_EXACT_POW10) || (exponent > JSON_MAX_EXACT_POW10))
+    {
+        return false;
+    }
+    const double value_double = (double)mantissa;
+    *out_double_p = (exponent < 0) ? value_double / _json_exact_pow10[-exponent]
+                                   : value_double * _json_exact_pow10[exponent];
+    if (number_p->is_negative)
+    {
+        *out_double_p = -*out_double_p;
+    }
+    return true;
+}
 
-GET_NUMBER_c(value_lld, VALUE_LLD, lld_t*, )
-GET_NUMBER_c(value_llu, VALUE_LLU, llu_t *, )
-GET_NUMBER_c(value_double, VALUE_DOUBLE, double*, )
-GET_NUMBER_c(value_bool, VALUE_BOOL, bool*, )
+// 128-bit approximations of the powers of 10 from 1e-348 to 1e347, rounded down and normalized so
+// that the highest bit is set, as high and low halves.
+#define JSON_POW10_128_MIN_EXPONENT (-348)
+#define JSON_POW10_128_MAX_EXPONENT (347)
 
-GET_ARRAY_VALUE_c(value_cstr, VALUE_CSTR, const char**)
-GET_ARRAY_VALUE_c(value_lld, VALUE_LLD, lld_t*)
-GET_ARRAY_VALUE_c(value_llu, VALUE_LLU, llu_t*)
-GET_ARRAY_VALUE_c(value_double, VALUE_DOUBLE, double*)
-GET_ARRAY_VALUE_c(value_bool, VALUE_BOOL, bool*)
-GET_ARRAY_VALUE_c(value_child_p, VALUE_ITEM, JsonItem**)
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wextra-semi"
-; // ensure clang-format works when turned on again
-#pragma clang diagnostic pop
-                                                                                  // clang-format on
+static const uint64_t _json_pow10_128[][2] = {
+    {0xFA8FD5A0081C0288ULL, 0x1732C869CD60E453ULL}, {0x9C99E58405118195ULL, 0x0E7FBD42205C8EB4ULL},
+    {0xC3C05EE50655E1FAULL, 0x521FAC92A873B261ULL}, {0xF4B0769E47EB5A78ULL, 0xE6A797B752909EF9ULL},
+    {0x98EE4A22ECF3188BULL, 0x9028BED2939A635CULL}, {0xBF29DCABA82FDEAEULL, 0x7432EE873880FC33ULL},
+    {0xEEF453D6923BD65AULL, 0x113FAA2906A13B3FULL}, {0x9558B4661B6565F8ULL, 0x4AC7CA59A424C507ULL},
+    {0xBAAEE17FA23EBF76ULL, 0x5D79BCF00D2DF649ULL}, {0xE95A99DF8ACE6F53ULL, 0xF4D82C2C107973DCULL},
+    {0x91D8A02BB6C10594ULL, 0x79071B9B8A4BE869ULL}, {0xB64EC836A47146F9ULL, 0x9748E2826CDEE284ULL},
+    {0xE3E27A444D8D98B7ULL, 0xFD1B1B2308169B25ULL}, {0x8E6D8C6AB0787F72ULL, 0xFE30F0F5E50E20F7ULL},
+    {0xB208EF855C969F4FULL, 0xBDBD2D335E51A935ULL}, {0xDE8B2B66B3BC4723ULL, 0xAD2C788035E61382ULL},
+    {0x8B16FB203055AC76ULL, 0x4C3BCB5021AFCC31ULL}, {0xADDCB9E83C6B1793ULL, 0xDF4ABE242A1BBF3DULL},
+    {0xD953E8624B85DD78ULL, 0xD71D6DAD34A2AF0DULL}, {0x87D4713D6F33AA6BULL, 0x8672648C40E5AD68ULL},
+    {0xA9C98D8CCB009506ULL, 0x680EFDAF511F18C2ULL}, {0xD43BF0EFFDC0BA48ULL, 0x0212BD1B2566DEF2ULL},
+    {0x84A57695FE98746DULL, 0x014BB630F7604B57ULL}, {0xA5CED43B7E3E9188ULL, 0x419EA3BD35385E2DULL},
+    {0xCF42894A5DCE35EAULL, 0x52064CAC828675B9ULL}, {0x818995CE7AA0E1B2ULL, 0x7343EFEBD1940993ULL},
+    {0xA1EBFB4219491A1FULL, 0x1014EBE6C5F90BF8ULL}, {0xCA66FA129F9B60A6ULL, 0xD41A26E077774EF6ULL},
+    {0xFD00B897478238D0ULL, 0x8920B098955522B4ULL}, {0x9E20735E8CB16382ULL, 0x55B46E5F5D5535B0ULL},
+    {0xC5A890362FDDBC62ULL, 0xEB2189F734AA831DULL}, {0xF712B443BBD52B7BULL, 0xA5E9EC7501D523E4ULL},
+    {0x9A6BB0AA55653B2DULL, 0x47B233C92125366EULL}, {0xC1069CD4EABE89F8ULL, 0x999EC0BB696E840AULL},
+    {0xF148440A256E2C76ULL, 0xC00670EA43CA250DULL}, {0x96CD2A865764DBCAULL, 0x380406926A5E5728ULL},
+    {0xBC807527ED3E12BCULL, 0xC605083704F5ECF2ULL}, {0xEBA09271E88D976BULL, 0xF7864A44C633682EULL},
+    {0x93445B8731587EA3ULL, 0x7AB3EE6AFBE0211DULL}, {0xB8157268FDAE9E4CULL, 0x5960EA05BAD82964ULL},
+    {0xE61ACF033D1A45DFULL, 0x6FB92487298E33BDULL}, {0x8FD0C16206306BABULL, 0xA5D3B6D479F8E056ULL},
+    {0xB3C4F1BA87BC8696ULL, 0x8F48A4899877186CULL}, {0xE0B62E2929ABA83CULL, 0x331ACDABFE94DE87ULL},
+    {0x8C71DCD9BA0B4925ULL, 0x9FF0C08B7F1D0B14ULL}, {0xAF8E5410288E1B6FULL, 0x07ECF0AE5EE44DD9ULL},
+    {0xDB71E91432B1A24AULL, 0xC9E82CD9F69D6150ULL}, {0x892731AC9FAF056EULL, 0xBE311C083A225CD2ULL},
+    {0xAB70FE17C79AC6CAULL, 0x6DBD630A48AAF406ULL}, {0xD64D3D9DB981787DULL, 0x092CBBCCDAD5B108ULL},
+    {0x85F0468293F0EB4EULL, 0x25BBF56008C58EA5ULL}, {0xA76C582338ED2621ULL, 0xAF2AF2B80AF6F24EULL},
+    {0xD1476E2C07286FAAULL, 0x1AF5AF660DB4AEE1ULL}, {0x82CCA4DB847945CAULL, 0x50D98D9FC890ED4DULL},
+    {0xA37FCE126597973CULL, 0xE50FF107BAB528A0ULL}, {0xCC5FC196FEFD7D0CULL, 0x1E53ED49A96272C8ULL},
+    {0xFF77B1FCBEBCDC4FULL, 0x25E8E89C13BB0F7AULL}, {0x9FAACF3DF73609B1ULL, 0x77B191618C54E9ACULL},
+    {0xC795830D75038C1DULL, 0xD59DF5B9EF6A2417ULL}, {0xF97AE3D0D2446F25ULL, 0x4B0573286B44AD1DULL},
+    {0x9BECCE62836AC577ULL, 0x4EE367F9430AEC32ULL}, {0xC2E801FB244576D5ULL, 0x229C41F793CDA73FULL},
+    {0xF3A20279ED56D48AULL, 0x6B43527578C1110FULL}, {0x9845418C345644D6ULL, 0x830A13896B78AAA9ULL},
+    {0xBE5691EF416BD60CULL, 0x23CC986BC656D553ULL}, {0xEDEC366B11C6CB8FULL, 0x2CBFBE86B7EC8AA8ULL},
+    {0x94B3A202EB1C3F39ULL, 0x7BF7D71432F3D6A9ULL}, {0xB9E08A83A5E34F07ULL, 0xDAF5CCD93FB0CC53ULL},
+    {0xE858AD248F5C22C9ULL, 0xD1B3400F8F9CFF68ULL}, {0x91376C36D99995BEULL, 0x23100809B9C21FA1ULL},
+    {0xB58547448FFFFB2DULL, 0xABD40A0C2832A78AULL}, {0xE2E69915B3FFF9F9ULL, 0x16C90C8F323F516CULL},
+    {0x8DD01FAD907FFC3BULL, 0xAE3DA7D97F6792E3ULL}, {0xB1442798F49FFB4AULL, 0x99CD11CFDF41779CULL},
+    {0xDD95317F31C7FA1DULL, 0x40405643D711D583ULL}, {0x8A7D3EEF7F1CFC52ULL, 0x482835EA666B2572ULL},
+    {0xAD1C8EAB5EE43B66ULL, 0xDA3243650005EECFULL}, {0xD863B256369D4A40ULL, 0x90BED43E40076A82ULL},
+    {0x873E4F75E2224E68ULL, 0x5A7744A6E804A291ULL}, {0xA90DE3535AAAE202ULL, 0x711515D0A205CB36ULL},
+    {0xD3515C2831559A83ULL, 0x0D5A5B44CA873E03ULL}, {0x8412D9991ED58091ULL, 0xE858790AFE9486C2ULL},
+    {0xA5178FFF668AE0B6ULL, 0x626E974DBE39A872ULL}, {0xCE5D73FF402D98E3ULL, 0xFB0A3D212DC8128FULL},
+    {0x80FA687F881C7F8EULL, 0x7CE66634BC9D0B99ULL}, {0xA139029F6A239F72ULL, 0x1C1FFFC1EBC44E80ULL},
+    {0xC987434744AC874EULL, 0xA327FFB266B56220ULL}, {0xFBE9141915D7A922ULL, 0x4BF1FF9F0062BAA8ULL},
+    {0x9D71AC8FADA6C9B5ULL, 0x6F773FC3603DB4A9ULL}, {0xC4CE17B399107C22ULL, 0xCB550FB4384D21D3ULL},
+    {0xF6019DA07F549B2BULL, 0x7E2A53A146606A48ULL}, {0x99C102844F94E0FBULL, 0x2EDA7444CBFC426DULL},
+    {0xC0314325637A1939ULL, 0xFA911155FEFB5308ULL}, {0xF03D93EEBC589F88ULL, 0x793555AB7EBA27CAULL},
+    {0x96267C7535B763B5ULL, 0x4BC1558B2F3458DEULL}, {0xBBB01B9283253CA2ULL, 0x9EB1AAEDFB016F16ULL},
+    {0xEA9C227723EE8BCBULL, 0x465E15A979C1CADCULL}, {0x92A1958A7675175FULL, 0x0BFACD89EC191EC9ULL},
+    {0xB749FAED14125D36ULL, 0xCEF980EC671F667BULL}, {0xE51C79A85916F484ULL, 0x82B7E12780E7401AULL},
+    {0x8F31CC0937AE58D2ULL, 0xD1B2ECB8B0908810ULL}, {0xB2FE3F0B8599EF07ULL, 0x861FA7E6DCB4AA15ULL},
+    {0xDFBDCECE67006AC9ULL, 0x67A791E093E1D49AULL}, {0x8BD6A141006042BDULL, 0xE0C8BB2C5C6D24E0ULL},
+    {0xAECC49914078536DULL, 0x58FAE9F773886E18ULL}, {0xDA7F5BF590966848ULL, 0xAF39A475506A899EULL},
+    {0x888F99797A5E012DULL, 0x6D8406C952429603ULL}, {0xAAB37FD7D8F58178ULL, 0xC8E5087BA6D33B83ULL},
+    {0xD5605FCDCF32E1D6ULL, 0xFB1E4A9A90880A64ULL}, {0x855C3BE0A17FCD26ULL, 0x5CF2EEA09A55067FULL},
+    {0xA6B34AD8C9DFC06FULL, 0xF42FAA48C0EA481EULL}, {0xD0601D8EFC57B08BULL, 0xF13B94DAF124DA26ULL},
+    {0x823C12795DB6CE57ULL, 0x76C53D08D6B70858ULL}, {0xA2CB1717B52481EDULL, 0x54768C4B0C64CA6EULL},
+    {0xCB7DDCDDA26DA268ULL, 0xA9942F5DCF7DFD09ULL}, {0xFE5D54150B090B02ULL, 0xD3F93B35435D7C4CULL},
+    {0x9EFA548D26E5A6E1ULL, 0xC47BC5014A1A6DAFULL}, {0xC6B8E9B0709F109AULL, 0x359AB6419CA1091BULL},
+    {0xF867241C8CC6D4C0ULL, 0xC30163D203C94B62ULL}, {0x9B407691D7FC44F8ULL, 0x79E0DE63425DCF1DULL},
+    {0xC21094364DFB5636ULL, 0x985915FC12F542E4ULL}, {0xF294B943E17A2BC4ULL, 0x3E6F5B7B17B2939DULL},
+    {0x979CF3CA6CEC5B5AULL, 0xA705992CEECF9C42ULL}, {0xBD8430BD08277231ULL, 0x50C6FF782A838353ULL},
+    {0xECE53CEC4A314EBDULL, 0xA4F8BF5635246428ULL}, {0x940F4613AE5ED136ULL, 0x871B7795E136BE99ULL},
+    {0xB913179899F68584ULL, 0x28E2557B59846E3FULL}, {0xE757DD7EC07426E5ULL, 0x331AEADA2FE589CFULL},
+    {0x9096EA6F3848984FULL, 0x3FF0D2C85DEF7621ULL}, {0xB4BCA50B065ABE63ULL, 0x0FED077A756B53A9ULL},
+    {0xE1EBCE4DC7F16DFBULL, 0xD3E8495912C62894ULL}, {0x8D3360F09CF6E4BDULL, 0x64712DD7ABBBD95CULL},
+    {0xB080392CC4349DECULL, 0xBD8D794D96AACFB3ULL}, {0xDCA04777F541C567ULL, 0xECF0D7A0FC5583A0ULL},
+    {0x89E42CAAF9491B60ULL, 0xF41686C49DB57244ULL}, {0xAC5D37D5B79B6239ULL, 0x311C2875C522CED5ULL},
+    {0xD77485CB25823AC7ULL, 0x7D633293366B828BULL}, {0x86A8D39EF77164BCULL, 0xAE5DFF9C02033197ULL},
+    {0xA8530886B54DBDEBULL, 0xD9F57F830283FDFCULL}, {0xD267CAA862A12D66ULL, 0xD072DF63C324FD7BULL},
+    {0x8380DEA93DA4BC60ULL, 0x4247CB9E59F71E6DULL}, {0xA46116538D0DEB78ULL, 0x52D9BE85F074E608ULL},
+    {0xCD795BE870516656ULL, 0x67902E276C921F8BULL}, {0x806BD9714632DFF6ULL, 0x00BA1CD8A3DB53B6ULL},
+    {0xA086CFCD97BF97F3ULL, 0x80E8A40ECCD228A4ULL}, {0xC8A883C0FDAF7DF0ULL, 0x6122CD128006B2CDULL},
+    {0xFAD2A4B13D1B5D6CULL, 0x796B805720085F81ULL}, {0x9CC3A6EEC6311A63ULL, 0xCBE3303674053BB0ULL},
+    {0xC3F490AA77BD60FCULL, 0xBEDBFC4411068A9CULL}, {0xF4F1B4D515ACB93BULL, 0xEE92FB5515482D44ULL},
+    {0x991711052D8BF3C5ULL, 0x751BDD152D4D1C4AULL}, {0xBF5CD54678EEF0B6ULL, 0xD262D45A78A0635DULL},
+    {0xEF340A98172AACE4ULL, 0x86FB897116C87C34ULL}, {0x9580869F0E7AAC0EULL, 0xD45D35E6AE3D4DA0ULL},
+    {0xBAE0A846D2195712ULL, 0x8974836059CCA109ULL}, {0xE998D258869FACD7ULL, 0x2BD1A438703FC94BULL},
+    {0x91FF83775423CC06ULL, 0x7B6306A34627DDCFULL}, {0xB67F6455292CBF08ULL, 0x1A3BC84C17B1D542ULL},
+    {0xE41F3D6A7377EECAULL, 0x20CABA5F1D9E4A93ULL}, {0x8E938662882AF53EULL, 0x547EB47B7282EE9CULL},
+    {0xB23867FB2A35B28DULL, 0xE99E619A4F23AA43ULL}, {0xDEC681F9F4C31F31ULL, 0x6405FA00E2EC94D4ULL},
+    {0x8B3C113C38F9F37EULL, 0xDE83BC408DD3DD04ULL}, {0xAE0B158B4738705EULL, 0x9624AB50B148D445ULL},
+    {0xD98DDAEE19068C76ULL, 0x3BADD624DD9B0957ULL}, {0x87F8A8D4CFA417C9ULL, 0xE54CA5D70A80E5D6ULL},
+    {0xA9F6D30A038D1DBCULL, 0x5E9FCF4CCD211F4CULL}, {0xD47487CC8470652BULL, 0x7647C3200069671FULL},
+    {0x84C8D4DFD2C63F3BULL, 0x29ECD9F40041E073ULL}, {0xA5FB0A17C777CF09ULL, 0xF468107100525890ULL},
+    {0xCF79CC9DB955C2CCULL, 0x7182148D4066EEB4ULL}, {0x81AC1FE293D599BFULL, 0xC6F14CD848405530ULL},
+    {0xA21727DB38CB002FULL, 0xB8ADA00E5A506A7CULL}, {0xCA9CF1D206FDC03BULL, 0xA6D90811F0E4851CULL},
+    {0xFD442E4688BD304AULL, 0x908F4A166D1DA663ULL}, {0x9E4A9CEC15763E2EULL, 0x9A598E4E043287FEULL},
+    {0xC5DD44271AD3CDBAULL, 0x40EFF1E1853F29FDULL}, {0xF7549530E188C128ULL, 0xD12BEE59E68EF47CULL},
+    {0x9A94DD3E8CF578B9ULL, 0x82BB74F8301958CEULL}, {0xC13A148E3032D6E7ULL, 0xE36A52363C1FAF01ULL},
+    {0xF18899B1BC3F8CA1ULL, 0xDC44E6C3CB279AC1ULL}, {0x96F5600F15A7B7E5ULL, 0x29AB103A5EF8C0B9ULL},
+    {0xBCB2B812DB11A5DEULL, 0x7415D448F6B6F0E7ULL}, {0xEBDF661791D60F56ULL, 0x111B495B3464AD21ULL},
+    {0x936B9FCEBB25C995ULL, 0xCAB10DD900BEEC34ULL}, {0xB84687C269EF3BFBULL, 0x3D5D514F40EEA742ULL},
+    {0xE65829B3046B0AFAULL, 0x0CB4A5A3112A5112ULL}, {0x8FF71A0FE2C2E6DCULL, 0x47F0E785EABA72ABULL},
+    {0xB3F4E093DB73A093ULL, 0x59ED216765690F56ULL}, {0xE0F218B8D25088B8ULL, 0x306869C13EC3532CULL},
+    {0x8C974F7383725573ULL, 0x1E414218C73A13FBULL}, {0xAFBD2350644EEACFULL, 0xE5D1929EF90898FAULL},
+    {0xDBAC6C247D62A583ULL, 0xDF45F746B74ABF39ULL}, {0x894BC396CE5DA772ULL, 0x6B8BBA8C328EB783ULL},
+    {0xAB9EB47C81F5114FULL, 0x066EA92F3F326564ULL}, {0xD686619BA27255A2ULL, 0xC80A537B0EFEFEBDULL},
+    {0x8613FD0145877585ULL, 0xBD06742CE95F5F36ULL}, {0xA798FC4196E952E7ULL, 0x2C48113823B73704ULL},
+    {0xD17F3B51FCA3A7A0ULL, 0xF75A15862CA504C5ULL}, {0x82EF85133DE648C4ULL, 0x9A984D73DBE722FBULL},
+    {0xA3AB66580D5FDAF5ULL, 0xC13E60D0D2E0EBBAULL}, {0xCC963FEE10B7D1B3ULL, 0x318DF905079926A8ULL},
+    {0xFFBBCFE994E5C61FULL, 0xFDF17746497F7052ULL}, {0x9FD561F1FD0F9BD3ULL, 0xFEB6EA8BEDEFA633ULL},
+    {0xC7CABA6E7C5382C8ULL, 0xFE64A52EE96B8FC0ULL}, {0xF9BD690A1B68637BULL, 0x3DFDCE7AA3C673B0ULL},
+    {0x9C1661A651213E2DULL, 0x06BEA10CA65C084EULL}, {0xC31BFA0FE5698DB8ULL, 0x486E494FCFF30A62ULL},
+    {0xF3E2F893DEC3F126ULL, 0x5A89DBA3C3EFCCFAULL}, {0x986DDB5C6B3A76B7ULL, 0xF89629465A75E01CULL},
+    {0xBE89523386091465ULL, 0xF6BBB397F1135823ULL}, {0xEE2BA6C0678B597FULL, 0x746AA07DED582E2CULL},
+    {0x94DB483840B717EFULL, 0xA8C2A44EB4571CDCULL}, {0xBA121A4650E4DDEBULL, 0x92F34D62616CE413ULL},
+    {0xE896A0D7E51E1566ULL, 0x77B020BAF9C81D17ULL}, {0x915E2486EF32CD60ULL, 0x0ACE1474DC1D122EULL},
+    {0xB5B5ADA8AAFF80B8ULL, 0x0D819992132456BAULL}, {0xE3231912D5BF60E6ULL, 0x10E1FFF697ED6C69ULL},
+    {0x8DF5EFABC5979C8FULL, 0xCA8D3FFA1EF463C1ULL}, {0xB1736B96B6FD83B3ULL, 0xBD308FF8A6B17CB2ULL},
+    {0xDDD0467C64BCE4A0ULL, 0xAC7CB3F6D05DDBDEULL}, {0x8AA22C0DBEF60EE4ULL, 0x6BCDF07A423AA96BULL},
+    {0xAD4AB7112EB3929DULL, 0x86C16C98D2C953C6ULL}, {0xD89D64D57A607744ULL, 0xE871C7BF077BA8B7ULL},
+    {0x87625F056C7C4A8BULL, 0x11471CD764AD4972ULL}, {0xA93AF6C6C79B5D2DULL, 0xD598E40D3DD89BCFULL},
+    {0xD389B47879823479ULL, 0x4AFF1D108D4EC2C3ULL}, {0x843610CB4BF160CBULL, 0xCEDF722A585139BAULL},
+    {0xA54394FE1EEDB8FEULL, 0xC2974EB4EE658828ULL}, {0xCE947A3DA6A9273EULL, 0x733D226229FEEA32ULL},
+    {0x811CCC668829B887ULL, 0x0806357D5A3F525FULL}, {0xA163FF802A3426A8ULL, 0xCA07C2DCB0CF26F7ULL},
+    {0xC9BCFF6034C13052ULL, 0xFC89B393DD02F0B5ULL}, {0xFC2C3F3841F17C67ULL, 0xBBAC2078D443ACE2ULL},
+    {0x9D9BA7832936EDC0ULL, 0xD54B944B84AA4C0DULL}, {0xC5029163F384A931ULL, 0x0A9E795E65D4DF11ULL},
+    {0xF64335BCF065D37DULL, 0x4D4617B5FF4A16D5ULL}, {0x99EA0196163FA42EULL, 0x504BCED1BF8E4E45ULL},
+    {0xC06481FB9BCF8D39ULL, 0xE45EC2862F71E1D6ULL}, {0xF07DA27A82C37088ULL, 0x5D767327BB4E5A4CULL},
+    {0x964E858C91BA2655ULL, 0x3A6A07F8D510F86FULL}, {0xBBE226EFB628AFEAULL, 0x890489F70A55368BULL},
+    {0xEADAB0ABA3B2DBE5ULL, 0x2B45AC74CCEA842EULL}, {0x92C8AE6B464FC96FULL, 0x3B0B8BC90012929DULL},
+    {0xB77ADA0617E3BBCBULL, 0x09CE6EBB40173744ULL}, {0xE55990879DDCAABDULL, 0xCC420A6A101D0515ULL},
+    {0x8F57FA54C2A9EAB6ULL, 0x9FA946824A12232DULL}, {0xB32DF8E9F3546564ULL, 0x47939822DC96ABF9ULL},
+    {0xDFF9772470297EBDULL, 0x59787E2B93BC56F7ULL}, {0x8BFBEA76C619EF36ULL, 0x57EB4EDB3C55B65AULL},
+    {0xAEFAE51477A06B03ULL, 0xEDE622920B6B23F1ULL}, {0xDAB99E59958885C4ULL, 0xE95FAB368E45ECEDULL},
+    {0x88B402F7FD75539BULL, 0x11DBCB0218EBB414ULL}, {0xAAE103B5FCD2A881ULL, 0xD652BDC29F26A119ULL},
+    {0xD59944A37C0752A2ULL, 0x4BE76D3346F0495FULL}, {0x857FCAE62D8493A5ULL, 0x6F70A4400C562DDBULL},
+    {0xA6DFBD9FB8E5B88EULL, 0xCB4CCD500F6BB952ULL}, {0xD097AD07A71F26B2ULL, 0x7E2000A41346A7A7ULL},
+    {0x825ECC24C873782FULL, 0x8ED400668C0C28C8ULL}, {0xA2F67F2DFA90563BULL, 0x728900802F0F32FAULL},
+    {0xCBB41EF979346BCAULL, 0x4F2B40A03AD2FFB9ULL}, {0xFEA126B7D78186BCULL, 0xE2F610C84987BFA8ULL},
+    {0x9F24B832E6B0F436ULL, 0x0DD9CA7D2DF4D7C9ULL}, {0xC6EDE63FA05D3143ULL, 0x91503D1C79720DBBULL},
+    {0xF8A95FCF88747D94ULL, 0x75A44C6397CE912AULL}, {0x9B69DBE1B548CE7CULL, 0xC986AFBE3EE11ABAULL},
+    {0xC24452DA229B021BULL, 0xFBE85BADCE996168ULL}, {0xF2D56790AB41C2A2ULL, 0xFAE27299423FB9C3ULL},
+    {0x97C560BA6B0919A5ULL, 0xDCCD879FC967D41AULL}, {0xBDB6B8E905CB600FULL, 0x5400E987BBC1C920ULL},
+    {0xED246723473E3813ULL, 0x290123E9AAB23B68ULL}, {0x9436C0760C86E30BULL, 0xF9A0B6720AAF6521ULL},
+    {0xB94470938FA89BCEULL, 0xF808E40E8D5B3E69ULL}, {0xE7958CB87392C2C2ULL, 0xB60B1D1230B20E04ULL},
+    {0x90BD77F3483BB9B9ULL, 0xB1C6F22B5E6F48C2ULL}, {0xB4ECD5F01A4AA828ULL, 0x1E38AEB6360B1AF3ULL},
+    {0xE2280B6C20DD5232ULL, 0x25C6DA63C38DE1B0ULL}, {0x8D590723948A535FULL, 0x579C487E5A38AD0EULL},
+    {0xB0AF48EC79ACE837ULL, 0x2D835A9DF0C6D851ULL}, {0xDCDB1B2798182244ULL, 0xF8E431456CF88E65ULL},
+    {0x8A08F0F8BF0F156BULL, 0x1B8E9ECB641B58FFULL}, {0xAC8B2D36EED2DAC5ULL, 0xE272467E3D222F3FULL},
+    {0xD7ADF884AA879177ULL, 0x5B0ED81DCC6ABB0FULL}, {0x86CCBB52EA94BAEAULL, 0x98E947129FC2B4E9ULL},
+    {0xA87FEA27A539E9A5ULL, 0x3F2398D747B36224ULL}, {0xD29FE4B18E88640EULL, 0x8EEC7F0D19A03AADULL},
+    {0x83A3EEEEF9153E89ULL, 0x1953CF68300424ACULL}, {0xA48CEAAAB75A8E2BULL, 0x5FA8C3423C052DD7ULL},
+    {0xCDB02555653131B6ULL, 0x3792F412CB06794DULL}, {0x808E17555F3EBF11ULL, 0xE2BBD88BBEE40BD0ULL},
+    {0xA0B19D2AB70E6ED6ULL, 0x5B6ACEAEAE9D0EC4ULL}, {0xC8DE047564D20A8BULL, 0xF245825A5A445275ULL},
+    {0xFB158592BE068D2EULL, 0xEED6E2F0F0D56712ULL}, {0x9CED737BB6C4183DULL, 0x55464DD69685606BULL},
+    {0xC428D05AA4751E4CULL, 0xAA97E14C3C26B886ULL}, {0xF53304714D9265DFULL, 0xD53DD99F4B3066A8ULL},
+    {0x993FE2C6D07B7FABULL, 0xE546A8038EFE4029ULL}, {0xBF8FDB78849A5F96ULL, 0xDE98520472BDD033ULL},
+    {0xEF73D256A5C0F77CULL, 0x963E66858F6D4440ULL}, {0x95A8637627989AADULL, 0xDDE7001379A44AA8ULL},
+    {0xBB127C53B17EC159ULL, 0x5560C018580D5D52ULL}, {0xE9D71B689DDE71AFULL, 0xAAB8F01E6E10B4A6ULL},
+    {0x9226712162AB070DULL, 0xCAB3961304CA70E8ULL}, {0xB6B00D69BB55C8D1ULL, 0x3D607B97C5FD0D22ULL},
+    {0xE45C10C42A2B3B05ULL, 0x8CB89A7DB77C506AULL}, {0x8EB98A7A9A5B04E3ULL, 0x77F3608E92ADB242ULL},
+    {0xB267ED1940F1C61CULL, 0x55F038B237591ED3ULL}, {0xDF01E85F912E37A3ULL, 0x6B6C46DEC52F6688ULL},
+    {0x8B61313BBABCE2C6ULL, 0x2323AC4B3B3DA015ULL}, {0xAE397D8AA96C1B77ULL, 0xABEC975E0A0D081AULL},
+    {0xD9C7DCED53C72255ULL, 0x96E7BD358C904A21ULL}, {0x881CEA14545C7575ULL, 0x7E50D64177DA2E54ULL},
+    {0xAA242499697392D2ULL, 0xDDE50BD1D5D0B9E9ULL}, {0xD4AD2DBFC3D07787ULL, 0x955E4EC64B44E864ULL},
+    {0x84EC3C97DA624AB4ULL, 0xBD5AF13BEF0B113EULL}, {0xA6274BBDD0FADD61ULL, 0xECB1AD8AEACDD58EULL},
+    {0xCFB11EAD453994BAULL, 0x67DE18EDA5814AF2ULL}, {0x81CEB32C4B43FCF4ULL, 0x80EACF948770CED7ULL},
+    {0xA2425FF75E14FC31ULL, 0xA1258379A94D028DULL}, {0xCAD2F7F5359A3B3EULL, 0x096EE45813A04330ULL},
+    {0xFD87B5F28300CA0DULL, 0x8BCA9D6E188853FCULL}, {0x9E74D1B791E07E48ULL, 0x775EA264CF55347DULL},
+    {0xC612062576589DDAULL, 0x95364AFE032A819DULL}, {0xF79687AED3EEC551ULL, 0x3A83DDBD83F52204ULL},
+    {0x9ABE14CD44753B52ULL, 0xC4926A9672793542ULL}, {0xC16D9A0095928A27ULL, 0x75B7053C0F178293ULL},
+    {0xF1C90080BAF72CB1ULL, 0x5324C68B12DD6338ULL}, {0x971DA05074DA7BEEULL, 0xD3F6FC16EBCA5E03ULL},
+    {0xBCE5086492111AEAULL, 0x88F4BB1CA6BCF584ULL}, {0xEC1E4A7DB69561A5ULL, 0x2B31E9E3D06C32E5ULL},
+    {0x9392EE8E921D5D07ULL, 0x3AFF322E62439FCFULL}, {0xB877AA3236A4B449ULL, 0x09BEFEB9FAD487C2ULL},
+    {0xE69594BEC44DE15BULL, 0x4C2EBE687989A9B3ULL}, {0x901D7CF73AB0ACD9ULL, 0x0F9D37014BF60A10ULL},
+    {0xB424DC35095CD80FULL, 0x538484C19EF38C94ULL}, {0xE12E13424BB40E13ULL, 0x2865A5F206B06FB9ULL},
+    {0x8CBCCC096F5088CBULL, 0xF93F87B7442E45D3ULL}, {0xAFEBFF0BCB24AAFEULL, 0xF78F69A51539D748ULL},
+    {0xDBE6FECEBDEDD5BEULL, 0xB573440E5A884D1BULL}, {0x89705F4136B4A597ULL, 0x31680A88F8953030ULL},
+    {0xABCC77118461CEFCULL, 0xFDC20D2B36BA7C3DULL}, {0xD6BF94D5E57A42BCULL, 0x3D32907604691B4CULL},
+    {0x8637BD05AF6C69B5ULL, 0xA63F9A49C2C1B10FULL}, {0xA7C5AC471B478423ULL, 0x0FCF80DC33721D53ULL},
+    {0xD1B71758E219652BULL, 0xD3C36113404EA4A8ULL}, {0x83126E978D4FDF3BULL, 0x645A1CAC083126E9ULL},
+    {0xA3D70A3D70A3D70AULL, 0x3D70A3D70A3D70A3ULL}, {0xCCCCCCCCCCCCCCCCULL, 0xCCCCCCCCCCCCCCCCULL},
+    {0x8000000000000000ULL, 0x0000000000000000ULL}, {0xA000000000000000ULL, 0x0000000000000000ULL},
+    {0xC800000000000000ULL, 0x0000000000000000ULL}, {0xFA00000000000000ULL, 0x0000000000000000ULL},
+    {0x9C40000000000000ULL, 0x0000000000000000ULL}, {0xC350000000000000ULL, 0x0000000000000000ULL},
+    {0xF424000000000000ULL, 0x0000000000000000ULL}, {0x9896800000000000ULL, 0x0000000000000000ULL},
+    {0xBEBC200000000000ULL, 0x0000000000000000ULL}, {0xEE6B280000000000ULL, 0x0000000000000000ULL},
+    {0x9502F90000000000ULL, 0x0000000000000000ULL}, {0xBA43B74000000000ULL, 0x0000000000000000ULL},
+    {0xE8D4A51000000000ULL, 0x0000000000000000ULL}, {0x9184E72A00000000ULL, 0x0000000000000000ULL},
+    {0xB5E620F480000000ULL, 0x0000000000000000ULL}, {0xE35FA931A0000000ULL, 0x0000000000000000ULL},
+    {0x8E1BC9BF04000000ULL, 0x0000000000000000ULL}, {0xB1A2BC2EC5000000ULL, 0x0000000000000000ULL},
+    {0xDE0B6B3A76400000ULL, 0x0000000000000000ULL}, {0x8AC7230489E80000ULL, 0x0000000000000000ULL},
+    {0xAD78EBC5AC620000ULL, 0x0000000000000000ULL}, {0xD8D726B7177A8000ULL, 0x0000000000000000ULL},
+    {0x878678326EAC9000ULL, 0x0000000000000000ULL}, {0xA968163F0A57B400ULL, 0x0000000000000000ULL},
+    {0xD3C21BCECCEDA100ULL, 0x0000000000000000ULL}, {0x84595161401484A0ULL, 0x0000000000000000ULL},
+    {0xA56FA5B99019A5C8ULL, 0x0000000000000000ULL}, {0xCECB8F27F4200F3AULL, 0x0000000000000000ULL},
+    {0x813F3978F8940984ULL, 0x4000000000000000ULL}, {0xA18F07D736B90BE5ULL, 0x5000000000000000ULL},
+    {0xC9F2C9CD04674EDEULL, 0xA400000000000000ULL}, {0xFC6F7C4045812296ULL, 0x4D00000000000000ULL},
+    {0x9DC5ADA82B70B59DULL, 0xF020000000000000ULL}, {0xC5371912364CE305ULL, 0x6C28000000000000ULL},
+    {0xF684DF56C3E01BC6ULL, 0xC732000000000000ULL}, {0x9A130B963A6C115CULL, 0x3C7F400000000000ULL},
+    {0xC097CE7BC90715B3ULL, 0x4B9F100000000000ULL}, {0xF0BDC21ABB48DB20ULL, 0x1E86D40000000000ULL},
+    {0x96769950B50D88F4ULL, 0x1314448000000000ULL}, {0xBC143FA4E250EB31ULL, 0x17D955A000000000ULL},
+    {0xEB194F8E1AE525FDULL, 0x5DCFAB0800000000ULL}, {0x92EFD1B8D0CF37BEULL, 0x5AA1CAE500000000ULL},
+    {0xB7ABC627050305ADULL, 0xF14A3D9E40000000ULL}, {0xE596B7B0C643C719ULL, 0x6D9CCD05D0000000ULL},
+    {0x8F7E32CE7BEA5C6FULL, 0xE4820023A2000000ULL}, {0xB35DBF821AE4F38BULL, 0xDDA2802C8A800000ULL},
+    {0xE0352F62A19E306EULL, 0xD50B2037AD200000ULL}, {0x8C213D9DA502DE45ULL, 0x4526F422CC340000ULL},
+    {0xAF298D050E4395D6ULL, 0x9670B12B7F410000ULL}, {0xDAF3F04651D47B4CULL, 0x3C0CDD765F114000ULL},
+    {0x88D8762BF324CD0FULL, 0xA5880A69FB6AC800ULL}, {0xAB0E93B6EFEE0053ULL, 0x8EEA0D047A457A00ULL},
+    {0xD5D238A4ABE98068ULL, 0x72A4904598D6D880ULL}, {0x85A36366EB71F041ULL, 0x47A6DA2B7F864750ULL},
+    {0xA70C3C40A64E6C51ULL, 0x999090B65F67D924ULL}, {0xD0CF4B50CFE20765ULL, 0xFFF4B4E3F741CF6DULL},
+    {0x82818F1281ED449FULL, 0xBFF8F10E7A8921A4ULL}, {0xA321F2D7226895C7ULL, 0xAFF72D52192B6A0DULL},
+    {0xCBEA6F8CEB02BB39ULL, 0x9BF4F8A69F764490ULL}, {0xFEE50B7025C36A08ULL, 0x02F236D04753D5B4ULL},
+    {0x9F4F2726179A2245ULL, 0x01D762422C946590ULL}, {0xC722F0EF9D80AAD6ULL, 0x424D3AD2B7B97EF5ULL},
+    {0xF8EBAD2B84E0D58BULL, 0xD2E0898765A7DEB2ULL}, {0x9B934C3B330C8577ULL, 0x63CC55F49F88EB2FULL},
+    {0xC2781F49FFCFA6D5ULL, 0x3CBF6B71C76B25FBULL}, {0xF316271C7FC3908AULL, 0x8BEF464E3945EF7AULL},
+    {0x97EDD871CFDA3A56ULL, 0x97758BF0E3CBB5ACULL}, {0xBDE94E8E43D0C8ECULL, 0x3D52EEED1CBEA317ULL},
+    {0xED63A231D4C4FB27ULL, 0x4CA7AAA863EE4BDDULL}, {0x945E455F24FB1CF8ULL, 0x8FE8CAA93E74EF6AULL},
+    {0xB975D6B6EE39E436ULL, 0xB3E2FD538E122B44ULL}, {0xE7D34C64A9C85D44ULL, 0x60DBBCA87196B616ULL},
+    {0x90E40FBEEA1D3A4AULL, 0xBC8955E946FE31CDULL}, {0xB51D13AEA4A488DDULL, 0x6BABAB6398BDBE41ULL},
+    {0xE264589A4DCDAB14ULL, 0xC696963C7EED2DD1ULL}, {0x8D7EB76070A08AECULL, 0xFC1E1DE5CF543CA2ULL},
+    {0xB0DE65388CC8ADA8ULL, 0x3B25A55F43294BCBULL}, {0xDD15FE86AFFAD912ULL, 0x49EF0EB713F39EBEULL},
+    {0x8A2DBF142DFCC7ABULL, 0x6E3569326C784337ULL}, {0xACB92ED9397BF996ULL, 0x49C2C37F07965404ULL},
+    {0xD7E77A8F87DAF7FBULL, 0xDC33745EC97BE906ULL}, {0x86F0AC99B4E8DAFDULL, 0x69A028BB3DED71A3ULL},
+    {0xA8ACD7C0222311BCULL, 0xC40832EA0D68CE0CULL}, {0xD2D80DB02AABD62BULL, 0xF50A3FA490C30190ULL},
+    {0x83C7088E1AAB65DBULL, 0x792667C6DA79E0FAULL}, {0xA4B8CAB1A1563F52ULL, 0x577001B891185938ULL},
+    {0xCDE6FD5E09ABCF26ULL, 0xED4C0226B55E6F86ULL}, {0x80B05E5AC60B6178ULL, 0x544F8158315B05B4ULL},
+    {0xA0DC75F1778E39D6ULL, 0x696361AE3DB1C721ULL}, {0xC913936DD571C84CULL, 0x03BC3A19CD1E38E9ULL},
+    {0xFB5878494ACE3A5FULL, 0x04AB48A04065C723ULL}, {0x9D174B2DCEC0E47BULL, 0x62EB0D64283F9C76ULL},
+    {0xC45D1DF942711D9AULL, 0x3BA5D0BD324F8394ULL}, {0xF5746577930D6500ULL, 0xCA8F44EC7EE36479ULL},
+    {0x9968BF6ABBE85F20ULL, 0x7E998B13CF4E1ECBULL}, {0xBFC2EF456AE276E8ULL, 0x9E3FEDD8C321A67EULL},
+    {0xEFB3AB16C59B14A2ULL, 0xC5CFE94EF3EA101EULL}, {0x95D04AEE3B80ECE5ULL, 0xBBA1F1D158724A12ULL},
+    {0xBB445DA9CA61281FULL, 0x2A8A6E45AE8EDC97ULL}, {0xEA1575143CF97226ULL, 0xF52D09D71A3293BDULL},
+    {0x924D692CA61BE758ULL, 0x593C2626705F9C56ULL}, {0xB6E0C377CFA2E12EULL, 0x6F8B2FB00C77836CULL},
+    {0xE498F455C38B997AULL, 0x0B6DFB9C0F956447ULL}, {0x8EDF98B59A373FECULL, 0x4724BD4189BD5EACULL},
+    {0xB2977EE300C50FE7ULL, 0x58EDEC91EC2CB657ULL}, {0xDF3D5E9BC0F653E1ULL, 0x2F2967B66737E3EDULL},
+    {0x8B865B215899F46CULL, 0xBD79E0D20082EE74ULL}, {0xAE67F1E9AEC07187ULL, 0xECD8590680A3AA11ULL},
+    {0xDA01EE641A708DE9ULL, 0xE80E6F4820CC9495ULL}, {0x884134FE908658B2ULL, 0x3109058D147FDCDDULL},
+    {0xAA51823E34A7EEDEULL, 0xBD4B46F0599FD415ULL}, {0xD4E5E2CDC1D1EA96ULL, 0x6C9E18AC7007C91AULL},
+    {0x850FADC09923329EULL, 0x03E2CF6BC604DDB0ULL}, {0xA6539930BF6BFF45ULL, 0x84DB8346B786151CULL},
+    {0xCFE87F7CEF46FF16ULL, 0xE612641865679A63ULL}, {0x81F14FAE158C5F6EULL, 0x4FCB7E8F3F60C07EULL},
+    {0xA26DA3999AEF7749ULL, 0xE3BE5E330F38F09DULL}, {0xCB090C8001AB551CULL, 0x5CADF5BFD3072CC5ULL},
+    {0xFDCB4FA002162A63ULL, 0x73D9732FC7C8F7F6ULL}, {0x9E9F11C4014DDA7EULL, 0x2867E7FDDCDD9AFAULL},
+    {0xC646D63501A1511DULL, 0xB281E1FD541501B8ULL}, {0xF7D88BC24209A565ULL, 0x1F225A7CA91A4226ULL},
+    {0x9AE757596946075FULL, 0x3375788DE9B06958ULL}, {0xC1A12D2FC3978937ULL, 0x0052D6B1641C83AEULL},
+    {0xF209787BB47D6B84ULL, 0xC0678C5DBD23A49AULL}, {0x9745EB4D50CE6332ULL, 0xF840B7BA963646E0ULL},
+    {0xBD176620A501FBFFULL, 0xB650E5A93BC3D898ULL}, {0xEC5D3FA8CE427AFFULL, 0xA3E51F138AB4CEBEULL},
+    {0x93BA47C980E98CDFULL, 0xC66F336C36B10137ULL}, {0xB8A8D9BBE123F017ULL, 0xB80B0047445D4184ULL},
+    {0xE6D3102AD96CEC1DULL, 0xA60DC059157491E5ULL}, {0x9043EA1AC7E41392ULL, 0x87C89837AD68DB2FULL},
+    {0xB454E4A179DD1877ULL, 0x29BABE4598C311FBULL}, {0xE16A1DC9D8545E94ULL, 0xF4296DD6FEF3D67AULL},
+    {0x8CE2529E2734BB1DULL, 0x1899E4A65F58660CULL}, {0xB01AE745B101E9E4ULL, 0x5EC05DCFF72E7F8FULL},
+    {0xDC21A1171D42645DULL, 0x76707543F4FA1F73ULL}, {0x899504AE72497EBAULL, 0x6A06494A791C53A8ULL},
+    {0xABFA45DA0EDBDE69ULL, 0x0487DB9D17636892ULL}, {0xD6F8D7509292D603ULL, 0x45A9D2845D3C42B6ULL},
+    {0x865B86925B9BC5C2ULL, 0x0B8A2392BA45A9B2ULL}, {0xA7F26836F282B732ULL, 0x8E6CAC7768D7141EULL},
+    {0xD1EF0244AF2364FFULL, 0x3207D795430CD926ULL}, {0x8335616AED761F1FULL, 0x7F44E6BD49E807B8ULL},
+    {0xA402B9C5A8D3A6E7ULL, 0x5F16206C9C6209A6ULL}, {0xCD036837130890A1ULL, 0x36DBA887C37A8C0FULL},
+    {0x802221226BE55A64ULL, 0xC2494954DA2C9789ULL}, {0xA02AA96B06DEB0FDULL, 0xF2DB9BAA10B7BD6CULL},
+    {0xC83553C5C8965D3DULL, 0x6F92829494E5ACC7ULL}, {0xFA42A8B73ABBF48CULL, 0xCB772339BA1F17F9ULL},
+    {0x9C69A97284B578D7ULL, 0xFF2A760414536EFBULL}, {0xC38413CF25E2D70DULL, 0xFEF5138519684ABAULL},
+    {0xF46518C2EF5B8CD1ULL, 0x7EB258665FC25D69ULL}, {0x98BF2F79D5993802ULL, 0xEF2F773FFBD97A61ULL},
+    {0xBEEEFB584AFF8603ULL, 0xAAFB550FFACFD8FAULL}, {0xEEAABA2E5DBF6784ULL, 0x95BA2A53F983CF38ULL},
+    {0x952AB45CFA97A0B2ULL, 0xDD945A747BF26183ULL}, {0xBA756174393D88DFULL, 0x94F971119AEEF9E4ULL},
+    {0xE912B9D1478CEB17ULL, 0x7A37CD5601AAB85DULL}, {0x91ABB422CCB812EEULL, 0xAC62E055C10AB33AULL},
+    {0xB616A12B7FE617AAULL, 0x577B986B314D6009ULL}, {0xE39C49765FDF9D94ULL, 0xED5A7E85FDA0B80BULL},
+    {0x8E41ADE9FBEBC27DULL, 0x14588F13BE847307ULL}, {0xB1D219647AE6B31CULL, 0x596EB2D8AE258FC8ULL},
+    {0xDE469FBD99A05FE3ULL, 0x6FCA5F8ED9AEF3BBULL}, {0x8AEC23D680043BEEULL, 0x25DE7BB9480D5854ULL},
+    {0xADA72CCC20054AE9ULL, 0xAF561AA79A10AE6AULL}, {0xD910F7FF28069DA4ULL, 0x1B2BA1518094DA04ULL},
+    {0x87AA9AFF79042286ULL, 0x90FB44D2F05D0842ULL}, {0xA99541BF57452B28ULL, 0x353A1607AC744A53ULL},
+    {0xD3FA922F2D1675F2ULL, 0x42889B8997915CE8ULL}, {0x847C9B5D7C2E09B7ULL, 0x69956135FEBADA11ULL},
+    {0xA59BC234DB398C25ULL, 0x43FAB9837E699095ULL}, {0xCF02B2C21207EF2EULL, 0x94F967E45E03F4BBULL},
+    {0x8161AFB94B44F57DULL, 0x1D1BE0EEBAC278F5ULL}, {0xA1BA1BA79E1632DCULL, 0x6462D92A69731732ULL},
+    {0xCA28A291859BBF93ULL, 0x7D7B8F7503CFDCFEULL}, {0xFCB2CB35E702AF78ULL, 0x5CDA735244C3D43EULL},
+    {0x9DEFBF01B061ADABULL, 0x3A0888136AFA64A7ULL}, {0xC56BAEC21C7A1916ULL, 0x088AAA1845B8FDD0ULL},
+    {0xF6C69A72A3989F5BULL, 0x8AAD549E57273D45ULL}, {0x9A3C2087A63F6399ULL, 0x36AC54E2F678864BULL},
+    {0xC0CB28A98FCF3C7FULL, 0x84576A1BB416A7DDULL}, {0xF0FDF2D3F3C30B9FULL, 0x656D44A2A11C51D5ULL},
+    {0x969EB7C47859E743ULL, 0x9F644AE5A4B1B325ULL}, {0xBC4665B596706114ULL, 0x873D5D9F0DDE1FEEULL},
+    {0xEB57FF22FC0C7959ULL, 0xA90CB506D155A7EAULL}, {0x9316FF75DD87CBD8ULL, 0x09A7F12442D588F2ULL},
+    {0xB7DCBF5354E9BECEULL, 0x0C11ED6D538AEB2FULL}, {0xE5D3EF282A242E81ULL, 0x8F1668C8A86DA5FAULL},
+    {0x8FA475791A569D10ULL, 0xF96E017D694487BCULL}, {0xB38D92D760EC4455ULL, 0x37C981DCC395A9ACULL},
+    {0xE070F78D3927556AULL, 0x85BBE253F47B1417ULL}, {0x8C469AB843B89562ULL, 0x93956D7478CCEC8EULL},
+    {0xAF58416654A6BABBULL, 0x387AC8D1970027B2ULL}, {0xDB2E51BFE9D0696AULL, 0x06997B05FCC0319EULL},
+    {0x88FCF317F22241E2ULL, 0x441FECE3BDF81F03ULL}, {0xAB3C2FDDEEAAD25AULL, 0xD527E81CAD7626C3ULL},
+    {0xD60B3BD56A5586F1ULL, 0x8A71E223D8D3B074ULL}, {0x85C7056562757456ULL, 0xF6872D5667844E49ULL},
+    {0xA738C6BEBB12D16CULL, 0xB428F8AC016561DBULL}, {0xD106F86E69D785C7ULL, 0xE13336D701BEBA52ULL},
+    {0x82A45B450226B39CULL, 0xECC0024661173473ULL}, {0xA34D721642B06084ULL, 0x27F002D7F95D0190ULL},
+    {0xCC20CE9BD35C78A5ULL, 0x31EC038DF7B441F4ULL}, {0xFF290242C83396CEULL, 0x7E67047175A15271ULL},
+    {0x9F79A169BD203E41ULL, 0x0F0062C6E984D386ULL}, {0xC75809C42C684DD1ULL, 0x52C07B78A3E60868ULL},
+    {0xF92E0C3537826145ULL, 0xA7709A56CCDF8A82ULL}, {0x9BBCC7A142B17CCBULL, 0x88A66076400BB691ULL},
+    {0xC2ABF989935DDBFEULL, 0x6ACFF893D00EA435ULL}, {0xF356F7EBF83552FEULL, 0x0583F6B8C4124D43ULL},
+    {0x98165AF37B2153DEULL, 0xC3727A337A8B704AULL}, {0xBE1BF1B059E9A8D6ULL, 0x744F18C0592E4C5CULL},
+    {0xEDA2EE1C7064130CULL, 0x1162DEF06F79DF73ULL}, {0x9485D4D1C63E8BE7ULL, 0x8ADDCB5645AC2BA8ULL},
+    {0xB9A74A0637CE2EE1ULL, 0x6D953E2BD7173692ULL}, {0xE8111C87C5C1BA99ULL, 0xC8FA8DB6CCDD0437ULL},
+    {0x910AB1D4DB9914A0ULL, 0x1D9C9892400A22A2ULL}, {0xB54D5E4A127F59C8ULL, 0x2503BEB6D00CAB4BULL},
+    {0xE2A0B5DC971F303AULL, 0x2E44AE64840FD61DULL}, {0x8DA471A9DE737E24ULL, 0x5CEAECFED289E5D2ULL},
+    {0xB10D8E1456105DADULL, 0x7425A83E872C5F47ULL}, {0xDD50F1996B947518ULL, 0xD12F124E28F77719ULL},
+    {0x8A5296FFE33CC92FULL, 0x82BD6B70D99AAA6FULL}, {0xACE73CBFDC0BFB7BULL, 0x636CC64D1001550BULL},
+    {0xD8210BEFD30EFA5AULL, 0x3C47F7E05401AA4EULL}, {0x8714A775E3E95C78ULL, 0x65ACFAEC34810A71ULL},
+    {0xA8D9D1535CE3B396ULL, 0x7F1839A741A14D0DULL}, {0xD31045A8341CA07CULL, 0x1EDE48111209A050ULL},
+    {0x83EA2B892091E44DULL, 0x934AED0AAB460432ULL}, {0xA4E4B66B68B65D60ULL, 0xF81DA84D5617853FULL},
+    {0xCE1DE40642E3F4B9ULL, 0x36251260AB9D668EULL}, {0x80D2AE83E9CE78F3ULL, 0xC1D72B7C6B426019ULL},
+    {0xA1075A24E4421730ULL, 0xB24CF65B8612F81FULL}, {0xC94930AE1D529CFCULL, 0xDEE033F26797B627ULL},
+    {0xFB9B7CD9A4A7443CULL, 0x169840EF017DA3B1ULL}, {0x9D412E0806E88AA5ULL, 0x8E1F289560EE864EULL},
+    {0xC491798A08A2AD4EULL, 0xF1A6F2BAB92A27E2ULL}, {0xF5B5D7EC8ACB58A2ULL, 0xAE10AF696774B1DBULL},
+    {0x9991A6F3D6BF1765ULL, 0xACCA6DA1E0A8EF29ULL}, {0xBFF610B0CC6EDD3FULL, 0x17FD090A58D32AF3ULL},
+    {0xEFF394DCFF8A948EULL, 0xDDFC4B4CEF07F5B0ULL}, {0x95F83D0A1FB69CD9ULL, 0x4ABDAF101564F98EULL},
+    {0xBB764C4CA7A4440FULL, 0x9D6D1AD41ABE37F1ULL}, {0xEA53DF5FD18D5513ULL, 0x84C86189216DC5EDULL},
+    {0x92746B9BE2F8552CULL, 0x32FD3CF5B4E49BB4ULL}, {0xB7118682DBB66A77ULL, 0x3FBC8C33221DC2A1ULL},
+    {0xE4D5E82392A40515ULL, 0x0FABAF3FEAA5334AULL}, {0x8F05B1163BA6832DULL, 0x29CB4D87F2A7400EULL},
+    {0xB2C71D5BCA9023F8ULL, 0x743E20E9EF511012ULL}, {0xDF78E4B2BD342CF6ULL, 0x914DA9246B255416ULL},
+    {0x8BAB8EEFB6409C1AULL, 0x1AD089B6C2F7548EULL}, {0xAE9672ABA3D0C320ULL, 0xA184AC2473B529B1ULL},
+    {0xDA3C0F568CC4F3E8ULL, 0xC9E5D72D90A2741EULL}, {0x8865899617FB1871ULL, 0x7E2FA67C7A658892ULL},
+    {0xAA7EEBFB9DF9DE8DULL, 0xDDBB901B98FEEAB7ULL}, {0xD51EA6FA85785631ULL, 0x552A74227F3EA565ULL},
+    {0x8533285C936B35DEULL, 0xD53A88958F87275FULL}, {0xA67FF273B8460356ULL, 0x8A892ABAF368F137ULL},
+    {0xD01FEF10A657842CULL, 0x2D2B7569B0432D85ULL}, {0x8213F56A67F6B29BULL, 0x9C3B29620E29FC73ULL},
+    {0xA298F2C501F45F42ULL, 0x8349F3BA91B47B8FULL}, {0xCB3F2F7642717713ULL, 0x241C70A936219A73ULL},
+    {0xFE0EFB53D30DD4D7ULL, 0xED238CD383AA0110ULL}, {0x9EC95D1463E8A506ULL, 0xF4363804324A40AAULL},
+    {0xC67BB4597CE2CE48ULL, 0xB143C6053EDCD0D5ULL}, {0xF81AA16FDC1B81DAULL, 0xDD94B7868E94050AULL},
+    {0x9B10A4E5E9913128ULL, 0xCA7CF2B4191C8326ULL}, {0xC1D4CE1F63F57D72ULL, 0xFD1C2F611F63A3F0ULL},
+    {0xF24A01A73CF2DCCFULL, 0xBC633B39673C8CECULL}, {0x976E41088617CA01ULL, 0xD5BE0503E085D813ULL},
+    {0xBD49D14AA79DBC82ULL, 0x4B2D8644D8A74E18ULL}, {0xEC9C459D51852BA2ULL, 0xDDF8E7D60ED1219EULL},
+    {0x93E1AB8252F33B45ULL, 0xCABB90E5C942B503ULL}, {0xB8DA1662E7B00A17ULL, 0x3D6A751F3B936243ULL},
+    {0xE7109BFBA19C0C9DULL, 0x0CC512670A783AD4ULL}, {0x906A617D450187E2ULL, 0x27FB2B80668B24C5ULL},
+    {0xB484F9DC9641E9DAULL, 0xB1F9F660802DEDF6ULL}, {0xE1A63853BBD26451ULL, 0x5E7873F8A0396973ULL},
+    {0x8D07E33455637EB2ULL, 0xDB0B487B6423E1E8ULL}, {0xB049DC016ABC5E5FULL, 0x91CE1A9A3D2CDA62ULL},
+    {0xDC5C5301C56B75F7ULL, 0x7641A140CC7810FBULL}, {0x89B9B3E11B6329BAULL, 0xA9E904C87FCB0A9DULL},
+    {0xAC2820D9623BF429ULL, 0x546345FA9FBDCD44ULL}, {0xD732290FBACAF133ULL, 0xA97C177947AD4095ULL},
+    {0x867F59A9D4BED6C0ULL, 0x49ED8EABCCCC485DULL}, {0xA81F301449EE8C70ULL, 0x5C68F256BFFF5A74ULL},
+    {0xD226FC195C6A2F8CULL, 0x73832EEC6FFF3111ULL}, {0x83585D8FD9C25DB7ULL, 0xC831FD53C5FF7EABULL},
+    {0xA42E74F3D032F525ULL, 0xBA3E7CA8B77F5E55ULL}, {0xCD3A1230C43FB26FULL, 0x28CE1BD2E55F35EBULL},
+    {0x80444B5E7AA7CF85ULL, 0x7980D163CF5B81B3ULL}, {0xA0555E361951C366ULL, 0xD7E105BCC332621FULL},
+    {0xC86AB5C39FA63440ULL, 0x8DD9472BF3FEFAA7ULL}, {0xFA856334878FC150ULL, 0xB14F98F6F0FEB951ULL},
+    {0x9C935E00D4B9D8D2ULL, 0x6ED1BF9A569F33D3ULL}, {0xC3B8358109E84F07ULL, 0x0A862F80EC4700C8ULL},
+    {0xF4A642E14C6262C8ULL, 0xCD27BB612758C0FAULL}, {0x98E7E9CCCFBD7DBDULL, 0x8038D51CB897789CULL},
+    {0xBF21E44003ACDD2CULL, 0xE0470A63E6BD56C3ULL}, {0xEEEA5D5004981478ULL, 0x1858CCFCE06CAC74ULL},
+    {0x95527A5202DF0CCBULL, 0x0F37801E0C43EBC8ULL}, {0xBAA718E68396CFFDULL, 0xD30560258F54E6BAULL},
+    {0xE950DF20247C83FDULL, 0x47C6B82EF32A2069ULL}, {0x91D28B7416CDD27EULL, 0x4CDC331D57FA5441ULL},
+    {0xB6472E511C81471DULL, 0xE0133FE4ADF8E952ULL}, {0xE3D8F9E563A198E5ULL, 0x58180FDDD97723A6ULL},
+    {0x8E679C2F5E44FF8FULL, 0x570F09EAA7EA7648ULL}, {0xB201833B35D63F73ULL, 0x2CD2CC6551E513DAULL},
+    {0xDE81E40A034BCF4FULL, 0xF8077F7EA65E58D1ULL}, {0x8B112E86420F6191ULL, 0xFB04AFAF27FAF782ULL},
+    {0xADD57A27D29339F6ULL, 0x79C5DB9AF1F9B563ULL}, {0xD94AD8B1C7380874ULL, 0x18375281AE7822BCULL},
+    {0x87CEC76F1C830548ULL, 0x8F2293910D0B15B5ULL}, {0xA9C2794AE3A3C69AULL, 0xB2EB3875504DDB22ULL},
+    {0xD433179D9C8CB841ULL, 0x5FA60692A46151EBULL}, {0x849FEEC281D7F328ULL, 0xDBC7C41BA6BCD333ULL},
+    {0xA5C7EA73224DEFF3ULL, 0x12B9B522906C0800ULL}, {0xCF39E50FEAE16BEFULL, 0xD768226B34870A00ULL},
+    {0x81842F29F2CCE375ULL, 0xE6A1158300D46640ULL}, {0xA1E53AF46F801C53ULL, 0x60495AE3C1097FD0ULL},
+    {0xCA5E89B18B602368ULL, 0x385BB19CB14BDFC4ULL}, {0xFCF62C1DEE382C42ULL, 0x46729E03DD9ED7B5ULL},
+    {0x9E19DB92B4E31BA9ULL, 0x6C07A2C26A8346D1ULL}, {0xC5A05277621BE293ULL, 0xC7098B7305241885ULL},
+    {0xF70867153AA2DB38ULL, 0xB8CBEE4FC66D1EA7ULL}, {0x9A65406D44A5C903ULL, 0x737F74F1DC043328ULL},
+    {0xC0FE908895CF3B44ULL, 0x505F522E53053FF2ULL}, {0xF13E34AABB430A15ULL, 0x647726B9E7C68FEFULL},
+    {0x96C6E0EAB509E64DULL, 0x5ECA783430DC19F5ULL}, {0xBC789925624C5FE0ULL, 0xB67D16413D132072ULL},
+    {0xEB96BF6EBADF77D8ULL, 0xE41C5BD18C57E88FULL}, {0x933E37A534CBAAE7ULL, 0x8E91B962F7B6F159ULL},
+    {0xB80DC58E81FE95A1ULL, 0x723627BBB5A4ADB0ULL}, {0xE61136F2227E3B09ULL, 0xCEC3B1AAA30DD91CULL},
+    {0x8FCAC257558EE4E6ULL, 0x213A4F0AA5E8A7B1ULL}, {0xB3BD72ED2AF29E1FULL, 0xA988E2CD4F62D19DULL},
+    {0xE0ACCFA875AF45A7ULL, 0x93EB1B80A33B8605ULL}, {0x8C6C01C9498D8B88ULL, 0xBC72F130660533C3ULL},
+    {0xAF87023B9BF0EE6AULL, 0xEB8FAD7C7F8680B4ULL}, {0xDB68C2CA82ED2A05ULL, 0xA67398DB9F6820E1ULL},
+    {0x892179BE91D43A43ULL, 0x88083F8943A1148CULL}, {0xAB69D82E364948D4ULL, 0x6A0A4F6B948959B0ULL},
+    {0xD6444E39C3DB9B09ULL, 0x848CE34679ABB01CULL}, {0x85EAB0E41A6940E5ULL, 0xF2D80E0C0C0B4E11ULL},
+    {0xA7655D1D2103911FULL, 0x6F8E118F0F0E2195ULL}, {0xD13EB46469447567ULL, 0x4B7195F2D2D1A9FBULL},
+};
 
-#ifdef _TEST
-static char* load_file_alloc(char* filename)
+// Convert `mantissa` times 10 to the power of `exponent` with a 128-bit multiplication
+// (Eisel-Lemire), which rounds correctly unless the product is too close to a halfway point. Fail
+// in this case, and for subnormal and infinite results.
+static bool _json_eisel_lemire(uint64_t mantissa, int64_t exponent, bool is_negative, double* out_p)
 {
-    FILE* json_file = fopen(filename, "r");
-    if (json_file == NULL)
+    if (mantissa == 0)
     {
-        LOG_PERROR("Could not read file");
+        *out_p = is_negative ? -0.0 : 0.0;
+        return true;
     }
-    int c;
-    size_t chars_read = 0;
-    size_t size       = 4096;
-    char* ret_str     = my_memory_malloc(__FILENAME__, __LINE__, size);
-    if (ret_str == NULL)
+    if ((exponent < JSON_POW10_128_MIN_EXPONENT) || (exponent > JSON_POW10_128_MAX_EXPONENT))
     {
-        LOG_PERROR("out of memory");
-        exit(1);
+        return false;
     }
-    while ((c = fgetc(json_file)) != EOF)
+    const uint64_t* pow10_p = _json_pow10_128[exponent - JSON_POW10_128_MIN_EXPONENT];
+    const int shift         = __builtin_clzll(mantissa);
+    mantissa <<= shift;
+    // 217706 / 2^16 is log2(10): the exponent of the power of 10, biased as in a double.
+    uint64_t binary_exponent = (uint64_t)(((217706 * exponent) >> 16) + 64 + 1023 - shift);
+
+    unsigned __int128 product = (unsigned __int128)mantissa * pow10_p[0];
+    uint64_t high             = (uint64_t)(product >> 64);
+    uint64_t low              = (uint64_t)product;
+    // The low half of the power of 10 may carry into the bits to round.
+    if (((high & 0x1FFULL) == 0x1FFULL) && (low + mantissa < mantissa))
     {
-        if (chars_read >= size - 1)
+        const unsigned __int128 low_product = (unsigned __int128)mantissa * pow10_p[1];
+        const uint64_t low_high             = (uint64_t)(low_product >> 64);
+        uint64_t merged_high                = high;
+        const uint64_t merged_low           = low + low_high;
+        if (merged_low < low)
         {
-            /* time to make it bigger */
-            size    = (size_t)(size * 1.5);
-            ret_str = realloc(ret_str, size);
-            if (ret_str == NULL)
-            {
-                LOG_PERROR("out of memory");
-                exit(1);
-            }
+            merged_high++;
         }
-        ret_str[chars_read++] = c;
+        if (((merged_high & 0x1FFULL) == 0x1FFULL) && (merged_low + 1 == 0)
+            && ((uint64_t)low_product + mantissa < mantissa))
+        {
+            return false;
+        }
+        high = merged_high;
+        low  = merged_low;
     }
-    ret_str[chars_read++] = '\0';
-    fclose(json_file);
-    return ret_str;
+    // Keep 54 bits, then round to 53.
+    const uint64_t msb   = high >> 63;
+    uint64_t significand = high >> (msb + 9);
+    binary_exponent -= 1 ^ msb;
+    if ((low == 0) && ((high & 0x1FFULL) == 0) && ((significand & 3) == 1))
+    {
+        return false;
+    }
+    significand += significand & 1;
+    significand >>= 1;
+    if (significand >> 53)
+    {
+        significand >>= 1;
+        binary_exponent++;
+    }
+    // Subnormal or infinite.
+    if (binary_exponent - 1 >= 0x7FFULL - 1)
+    {
+        return false;
+    }
+    uint64_t bits = (binary_exponent << 52) | (significand & 0x000FFFFFFFFFFFFFULL);
+    if (is_negative)
+    {
+        bits |= 0x8000000000000000ULL;
+    }
+    memcpy(out_p, &bits, sizeof(bits));
+    return true;
 }
 
-void test_class_json(void)
+// Digits kept by a `JsonDecimal`: beyond them, only whether the rest is zero matters, which is
+// enough to round any double correctly.
+#define JSON_DECIMAL_MAX_DIGITS (800)
+// Largest shift done at once, which keeps a digit shifted left within 64 bits.
+#define JSON_DECIMAL_MAX_SHIFT (60)
+
+// Number as 0.d1d2d3... times 10 to the power of `decimal_point`, with digits from 0 to 9.
+typedef struct
 {
-    PRINT_BANNER();
-    PRINT_TEST_TITLE("Validate tokens");
+    uint8_t digits[JSON_DECIMAL_MAX_DIGITS];
+    int len;
+    int decimal_point;
+    bool is_negative;
+    bool is_truncated; // Non-zero digits dropped past `JSON_DECIMAL_MAX_DIGITS`.
+} JsonDecimal;
+
+// Read the digits of the number `len` chars long at `number_cstr`, already validated.
+static void _JsonDecimal_init(JsonDecimal* decimal_p, const char* number_cstr, size_t len)
+{
+    const char* end_p        = number_cstr + len;
+    bool has_point           = false;
+    decimal_p->len           = 0;
+    decimal_p->decimal_point = 0;
+    decimal_p->is_truncated  = false;
+    decimal_p->is_negative   = (*number_cstr == '-');
+    number_cstr += decimal_p->is_negative;
+    for (; (number_cstr < end_p) && (*number_cstr != 'e') && (*number_cstr != 'E'); number_cstr++)
     {
-        { // TODO: this should fail
-            char json_char_p[] = "{[}]";
-            ASSERT_OK(_validate_tokens(json_char_p), "Valid JSON");
+        if (*number_cstr == '.')
+        {
+            has_point                = true;
+            decimal_p->decimal_point = decimal_p->len;
         }
+        else if ((*number_cstr == '0') && (decimal_p->len == 0))
         {
-            char json_char_p[] = "{[][[]]{}{{}}}";
-            ASSERT_OK(_validate_tokens(json_char_p), "Valid JSON");
+            // Leading zeros only move the decimal point.
+            decimal_p->decimal_point--;
         }
+        else if (decimal_p->len < JSON_DECIMAL_MAX_DIGITS)
         {
-            char json_char_p[] = "{";
-            ASSERT_ERR(_validate_tokens(json_char_p), "Missing }.");
+            decimal_p->digits[decimal_p->len++] = (uint8_t)(*number_cstr - '0');
         }
+        else if (*number_cstr != '0')
         {
-            char json_char_p[] = "}";
-            ASSERT_ERR(_validate_tokens(json_char_p), "Extra }.");
+            decimal_p->is_truncated = true;
         }
+    }
+    if (!has_point)
+    {
+        decimal_p->decimal_point = decimal_p->len;
+    }
+    if (number_cstr < end_p)
+    {
+        number_cstr++;
+        const bool is_exponent_negative = (*number_cstr == '-');
+        number_cstr += (*number_cstr == '-') || (*number_cstr == '+');
+        int exponent = 0;
+        for (; number_cstr < end_p; number_cstr++)
         {
-            char json_char_p[] = "[}";
-            ASSERT_ERR(_validate_tokens(json_char_p), "Extra }.");
+            // Way past the range of a double, as in `_scan_number()`.
+            if (exponent < JSON_MAX_EXPONENT)
+            {
+                exponent = 10 * exponent + (*number_cstr - '0');
+            }
         }
+        decimal_p->decimal_point += is_exponent_negative ? -exponent : exponent;
+    }
+}
+
+// Drop the trailing zeros.
+static void _JsonDecimal_trim(JsonDecimal* decimal_p)
+{
+    while ((decimal_p->len > 0) && (decimal_p->digits[decimal_p->len - 1] == 0))
+    {
+        decimal_p->len--;
+    }
+    if (decimal_p->len == 0)
+    {
+        decimal_p->decimal_point = 0;
+    }
+}
+
+// Multiply by 2 to the power of `shift`, at most `JSON_DECIMAL_MAX_SHIFT`, from the last digit on.
+static void _JsonDecimal_shift_left(JsonDecimal* decimal_p, unsigned shift)
+{
+    // 1233 / 2^12 is log10(2): an upper bound of the number of digits added.
+    const int num_of_new_digits = (int)((shift * 1233) >> 12) + 1;
+    int read                    = decimal_p->len;
+    int write                   = decimal_p->len + num_of_new_digits;
+    uint64_t n                  = 0;
+    while ((read > 0) || (n > 0))
+    {
+        if (read > 0)
         {
-            char json_char_p[] = "[";
-            ASSERT_ERR(_validate_tokens(json_char_p), "Missing ].");
+            n += (uint64_t)decimal_p->digits[--read] << shift;
         }
+        const uint64_t quotient = n / 10;
+        const uint64_t digit    = n - 10 * quotient;
+        write--;
+        if (write < JSON_DECIMAL_MAX_DIGITS)
         {
-            char json_char_p[] = "]";
-            ASSERT_ERR(_validate_tokens(json_char_p), "Extra ].");
+            decimal_p->digits[write] = (uint8_t)digit;
         }
+        else if (digit != 0)
         {
-            char json_char_p[] = "{]";
-            ASSERT_ERR(_validate_tokens(json_char_p), "Extra ].");
+            decimal_p->is_truncated = true;
         }
+        n = quotient;
     }
-    PRINT_TEST_TITLE("Empty object");
+    const int end = (decimal_p->len + num_of_new_digits < JSON_DECIMAL_MAX_DIGITS)
+                      ? decimal_p->len + num_of_new_digits
+                      : JSON_DECIMAL_MAX_DIGITS;
+    decimal_p->decimal_point += num_of_new_digits - write;
+    decimal_p->len = end - write;
+    memmove(decimal_p->digits, decimal_p->digits + write, (size_t)decimal_p->len);
+    _JsonDecimal_trim(decimal_p);
+}
+
+// Divide by 2 to the power of `shift`, at most `JSON_DECIMAL_MAX_SHIFT`, from the first digit on.
+static void _JsonDecimal_shift_right(JsonDecimal* decimal_p, unsigned shift)
+{
+    const uint64_t mask = ((uint64_t)1 << shift) - 1;
+    int read            = 0;
+    int write           = 0;
+    uint64_t n          = 0;
+    // Gather enough leading digits for the first one of the result.
+    for (; (n >> shift) == 0; read++)
     {
-        __autodestroy_json__ JsonObj json_obj;
-        JsonItem* json_item_p;
-        const char* json_char_p = "{}";
-        lld_t a;
-        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Empty JSON created");
-        ASSERT_ERR(Json_get(&json_obj, "missing key", &json_item_p), "Fix NULL on key");
-        ASSERT_ERR(Json_get(&json_obj, "missing key", &a), "Fix NULL on key");
+        if (read >= decimal_p->len)
+        {
+            if (n == 0)
+            {
+                decimal_p->len = 0;
+                return;
+            }
+            while ((n >> shift) == 0)
+            {
+                n *= 10;
+                read++;
+            }
+            break;
+        }
+        n = 10 * n + decimal_p->digits[read];
     }
-    PRINT_TEST_TITLE("Wrong object");
+    decimal_p->decimal_point -= read - 1;
+    for (; read < decimal_p->len; read++)
     {
-        JsonObj json_obj;
-        const char* json_char_p = "{:}";
-        ASSERT_ERR(JsonObj_new(json_char_p, &json_obj), "Invalid JSON");
-        // This does not cause an error, even though the object was not created because of parsing errors.
-        JsonObj_destroy(&json_obj);
+        const uint8_t digit        = decimal_p->digits[read];
+        decimal_p->digits[write++] = (uint8_t)(n >> shift);
+        n                          = 10 * (n & mask) + digit;
     }
-    PRINT_TEST_TITLE("Empty nested object");
+    while (n > 0)
     {
-        __autodestroy_json__ JsonObj json_obj;
-        const char* value_cstr;
-        const char* json_char_p = "{\"key\":{}}";
-        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Empty nested JSON");
-        ASSERT_ERR(Json_get(&json_obj, "key", &value_cstr), "Key found but value cannot be retrieved");
+        const uint8_t digit = (uint8_t)(n >> shift);
+        n                   = 10 * (n & mask);
+        if (write < JSON_DECIMAL_MAX_DIGITS)
+        {
+            decimal_p->digits[write++] = digit;
+        }
+        else if (digit > 0)
+        {
+            decimal_p->is_truncated = true;
+        }
     }
-    PRINT_TEST_TITLE("Key-value pair");
+    decimal_p->len = write;
+    _JsonDecimal_trim(decimal_p);
+}
+
+// Multiply by 2 to the power of `shift`, which may be negative.
+static void _JsonDecimal_shift(JsonDecimal* decimal_p, int shift)
+{
+    if (decimal_p->len == 0)
     {
-        __autodestroy_json__ JsonObj json_obj;
-        const char* value_cstr;
-        const char* json_char_p = " {\"key\": \"value string\"}";
-        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
-        Json_get(&json_obj, "key", &value_cstr);
-        ASSERT_EQ("value string", value_cstr, "Key for root found with correct value STRING");
-        ASSERT_ERR(Json_get(&json_obj, "missing key", &value_cstr), "Missing key detected.");
-        ASSERT_EQ(value_cstr == NULL, true, "Returned null due to missing key.");
+        return;
     }
-    PRINT_TEST_TITLE("Sibling key-value pair");
+    for (; shift > JSON_DECIMAL_MAX_SHIFT; shift -= JSON_DECIMAL_MAX_SHIFT)
     {
-        __autodestroy_json__ JsonObj json_obj;
-        const char* value_cstr;
-        llu_t value_llu;
-        const char* json_char_p = " {\"key\": \"value string\", \"sibling\": 56}";
-        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
-        Json_get(&json_obj, "key", &value_cstr);
-        Json_get(&json_obj, "sibling", &value_llu);
-        ASSERT_EQ("value string", value_cstr, "Key for root value STRING");
-        ASSERT_EQ(56, value_llu, "Key for root found with correct value INT");
+        _JsonDecimal_shift_left(decimal_p, JSON_DECIMAL_MAX_SHIFT);
     }
-    PRINT_TEST_TITLE("Simple array");
+    for (; shift < -JSON_DECIMAL_MAX_SHIFT; shift += JSON_DECIMAL_MAX_SHIFT)
     {
-        __autodestroy_json__ JsonObj json_obj;
-        const char* value_cstr;
-        llu_t value_llu;
-        JsonArray* json_array;
-        const char* json_char_p = " {\"key\": [\"array value\", 56]}";
-        printf("\n%s\n", json_char_p);
-        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
-        Json_get(&json_obj, "key", &json_array);
-        Json_get(json_array, 0, &value_cstr);
-        ASSERT_EQ("array value", value_cstr, "Array STRING element retrieved.");
-        Json_get(json_array, 1, &value_llu);
-        ASSERT_EQ(56, value_llu, "Array LLU element retrieved.");
+        _JsonDecimal_shift_right(decimal_p, JSON_DECIMAL_MAX_SHIFT);
     }
-    PRINT_TEST_TITLE("Array of objects");
+    if (shift > 0)
     {
-        __autodestroy_json__ JsonObj json_obj;
+        _JsonDecimal_shift_left(decimal_p, (unsigned)shift);
+    }
+    else if (shift < 0)
+    {
+        _JsonDecimal_shift_right(decimal_p, (unsigned)-shift);
+    }
+}
+
+// Return the integer part, rounded half to even on the first dropped digit.
+static uint64_t _JsonDecimal_round(const JsonDecimal* decimal_p)
+{
+    const int decimal_point = decimal_p->decimal_point;
+    uint64_t n              = 0;
+    int i                   = 0;
+    for (; (i < decimal_point) && (i < decimal_p->len); i++)
+    {
+        n = 10 * n + decimal_p->digits[i];
+    }
+    for (; i < decimal_point; i++)
+    {
+        n *= 10;
+    }
+    if ((decimal_point < 0) || (decimal_point >= decimal_p->len))
+    {
+        return n;
+    }
+    const uint8_t first_dropped = decimal_p->digits[decimal_point];
+    if ((first_dropped == 5) && (decimal_point + 1 == decimal_p->len) && !decimal_p->is_truncated)
+    {
+        return n + (n & 1);
+    }
+    return n + (first_dropped >= 5);
+}
+
+// Powers of 2 by which the first powers of 10 are at least as large, to scale a decimal towards
+// [0.5, 1) in few shifts.
+static const int _json_pow10_shifts[] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+
+#define JSON_DOUBLE_EXPONENT_BIAS (-1023)
+#define JSON_DOUBLE_MANTISSA_BITS (52)
+
+// Convert the decimal exactly, however many digits it has, by shifting it in binary until its
+// integer part holds the 53 bits of the double. Return false if out of range.
+static bool _JsonDecimal_to_double(JsonDecimal* decimal_p, double* out_p)
+{
+    const int num_of_shifts = (int)sizeof_array(_json_pow10_shifts);
+    int binary_exponent     = 0;
+    uint64_t mantissa       = 0;
+    if ((decimal_p->len == 0) || (decimal_p->decimal_point < -330))
+    {
+        binary_exponent = JSON_DOUBLE_EXPONENT_BIAS;
+    }
+    else if (decimal_p->decimal_point > 310)
+    {
+        return false;
+    }
+    else
+    {
+        while (decimal_p->decimal_point > 0)
+        {
+            const int shift = (decimal_p->decimal_point >= num_of_shifts)
+                                ? 27
+                                : _json_pow10_shifts[decimal_p->decimal_point];
+            _JsonDecimal_shift(decimal_p, -shift);
+            binary_exponent += shift;
+        }
+        while ((decimal_p->decimal_point < 0)
+               || ((decimal_p->decimal_point == 0) && (decimal_p->digits[0] < 5)))
+        {
+            const int shift = (-decimal_p->decimal_point >= num_of_shifts)
+                                ? 27
+                                : _json_pow10_shifts[-decimal_p->decimal_point];
+            _JsonDecimal_shift(decimal_p, shift);
+            binary_exponent -= shift;
+        }
+        // From [0.5, 1) to [1, 2), then up to the smallest exponent of a double, as a subnormal.
+        binary_exponent--;
+        if (binary_exponent < JSON_DOUBLE_EXPONENT_BIAS + 1)
+        {
+            const int shift = JSON_DOUBLE_EXPONENT_BIAS + 1 - binary_exponent;
+            _JsonDecimal_shift(decimal_p, -shift);
+            binary_exponent += shift;
+        }
+        if (binary_exponent - JSON_DOUBLE_EXPONENT_BIAS >= 0x7FF)
+        {
+            return false;
+        }
+        _JsonDecimal_shift(decimal_p, 1 + JSON_DOUBLE_MANTISSA_BITS);
+        mantissa = _JsonDecimal_round(decimal_p);
+        // Rounding up may add a bit.
+        if (mantissa == (uint64_t)2 << JSON_DOUBLE_MANTISSA_BITS)
+        {
+            mantissa >>= 1;
+            binary_exponent++;
+            if (binary_exponent - JSON_DOUBLE_EXPONENT_BIAS >= 0x7FF)
+            {
+                return false;
+            }
+        }
+        if ((mantissa & ((uint64_t)1 << JSON_DOUBLE_MANTISSA_BITS)) == 0)
+        {
+            binary_exponent = JSON_DOUBLE_EXPONENT_BIAS;
+        }
+    }
+    uint64_t bits = mantissa & (((uint64_t)1 << JSON_DOUBLE_MANTISSA_BITS) - 1);
+    bits |= (uint64_t)((binary_exponent - JSON_DOUBLE_EXPONENT_BIAS) & 0x7FF)
+            << JSON_DOUBLE_MANTISSA_BITS;
+    if (decimal_p->is_negative)
+    {
+        bits |= 0x8000000000000000ULL;
+    }
+    memcpy(out_p, &bits, sizeof(bits));
+    return true;
+}
+
+static Error _JsonItem_set_number(JsonItem* item_p, const JsonToken* token_p)
+{
+    const JsonNumber* number_p = &token_p->number;
+    if (number_p->is_integer && !number_p->is_truncated)
+    {
+        if (!number_p->is_negative)
+        {
+            item_p->value.value_type = VALUE_LLU;
+            item_p->value.value_llu  = number_p->mantissa;
+            return ERR_ALL_GOOD;
+        }
+        if (number_p->mantissa <= (uint64_t)LLONG_MAX + 1)
+        {
+            item_p->value.value_type = VALUE_LLD;
+            item_p->value.value_lld  = (number_p->mantissa == 0)
+                                         ? 0
+                                         : -(lld_t)(number_p->mantissa - 1) - 1;
+            return ERR_ALL_GOOD;
+        }
+    }
+    if (number_p->is_integer)
+    {
+        LOG_ERROR("Integer out of range: %.*s", (int)token_p->len, token_p->start_p);
+        return number_p->is_negative ? ERR_PARSE_STRING_TO_LLD : ERR_PARSE_STRING_TO_LLU;
+    }
+    item_p->value.value_type = VALUE_DOUBLE;
+    if (_JsonNumber_to_double_fast(number_p, &item_p->value.value_double))
+    {
+        return ERR_ALL_GOOD;
+    }
+    // E.g. 17 significant digits. With more digits than the mantissa takes, the result is known
+    // once rounding the mantissa and the mantissa plus one give the same double.
+    double value_double;
+    double upper_double;
+    if (_json_eisel_lemire(
+            number_p->mantissa, number_p->exponent, number_p->is_negative, &value_double)
+        && (!number_p->is_truncated
+            || ((number_p->mantissa < UINT64_MAX)
+                && _json_eisel_lemire(
+                    number_p->mantissa + 1,
+                    number_p->exponent,
+                    number_p->is_negative,
+                    &upper_double)
+                && (value_double == upper_double))))
+    {
+        item_p->value.value_double = value_double;
+        return ERR_ALL_GOOD;
+    }
+    // Halfway cases, subnormals and overflows are rare enough to be read digit by digit.
+    JsonDecimal decimal;
+    _JsonDecimal_init(&decimal, token_p->start_p, token_p->len);
+    if (!_JsonDecimal_to_double(&decimal, &item_p->value.value_double))
+    {
+        LOG_ERROR("Double out of range: %.*s", (int)token_p->len, token_p->start_p);
+        return ERR_PARSE_STRING_TO_DOUBLE;
+    }
+    return ERR_ALL_GOOD;
+}
+
+// Create a new item as the last child of `parent_p`, whose current last child is `prev_p`.
+static JsonItem* _JsonItem_append(
+    const char* file,
+    const int line,
+    JsonArena* arena_p,
+    JsonItem* parent_p,
+    JsonItem* prev_p)
+{
+    JsonItem* new_item = _JsonItem_new(file, line, arena_p);
+    new_item->parent   = parent_p;
+    if (parent_p->value.value_type == VALUE_ARRAY)
+    {
+        parent_p->value.value_array_p->len++;
+    }
+    if (prev_p != NULL)
+    {
+        prev_p->next_sibling = new_item;
+        if (parent_p->value.value_type == VALUE_ARRAY)
+        {
+            new_item->index = prev_p->index + 1;
+        }
+    }
+    else if (parent_p->value.value_type == VALUE_ARRAY)
+    {
+        parent_p->value.value_array_p->element = new_item;
+    }
+    else if (parent_p == parent_p->parent)
+    {
+        // The first actual item is the first sibling of root.
+        parent_p->next_sibling = new_item;
+    }
+    else
+    {
+        parent_p->value.value_child_p = new_item;
+    }
+    return new_item;
+}
+
+static void _JsonItem_open_container(
+    const char* file,
+    const int line,
+    JsonArena* arena_p,
+    JsonItem* item_p,
+    JsonTokenType token_type)
+{
+    if (token_type == TOKEN_OBJECT_BEGIN)
+    {
+        item_p->value.value_type    = VALUE_ITEM;
+        item_p->value.value_child_p = NULL;
+        return;
+    }
+    JsonArray* json_array_p   = _JsonArena_alloc(file, line, arena_p, sizeof(JsonArray));
+    json_array_p->element     = NULL;
+    json_array_p->len         = 0;
+    json_array_p->elements_pp       = NULL;
+    json_array_p->elements_capacity = 0;
+    json_array_p->owner_p           = item_p;
+
+    item_p->value.value_type    = VALUE_ARRAY;
+    item_p->value.value_array_p = json_array_p;
+}
+
+static Error _JsonTokenizer_error(const JsonTokenizer* tokenizer_p)
+{
+    LOG_ERROR(
+        "Unexpected char at offset %zu", (size_t)(tokenizer_p->curr_p - tokenizer_p->begin_p));
+    return ERR_JSON_INVALID;
+}
+
+// Tokenize the container just opened up to its end, without building anything.
+static bool _JsonTokenizer_validate_container(JsonTokenizer* tokenizer_p)
+{
+    const size_t depth = tokenizer_p->depth;
+    JsonToken token;
+    while (tokenizer_p->depth >= depth)
+    {
+        if (_JsonTokenizer_next(tokenizer_p, &token) == TOKEN_INVALID)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Move past the container just opened, whose content has been validated already. Only brackets
+// and strings matter here, hence whole blocks are skipped by looking at their masks.
+static void _JsonTokenizer_skip_container(JsonTokenizer* tokenizer_p)
+{
+    const char* curr_p = tokenizer_p->curr_p;
+    size_t level       = 1;
+    bool has_escapes;
+    JsonBlockMasks masks;
+    while (level > 0)
+    {
+        const size_t available = _JsonTokenizer_masks(tokenizer_p, curr_p, &masks);
+        const char* next_p     = curr_p + available;
+        uint64_t candidates    = masks.quote | masks.structural;
+        while (candidates != 0)
+        {
+            const char* char_p = curr_p + __builtin_ctzll(candidates);
+            candidates &= candidates - 1;
+            if (*char_p == '"')
+            {
+                // Strings may contain brackets: resume from their closing quote.
+                next_p = _JsonTokenizer_scan_string(tokenizer_p, char_p + 1, &has_escapes) + 1;
+                break;
+            }
+            if ((*char_p == '{') || (*char_p == '['))
+            {
+                level++;
+            }
+            else if (((*char_p == '}') || (*char_p == ']')) && (--level == 0))
+            {
+                next_p = char_p + 1;
+                break;
+            }
+        }
+        curr_p = next_p;
+    }
+    tokenizer_p->depth--;
+    tokenizer_p->expect = tokenizer_p->depth ? EXPECT_COMMA_OR_END : EXPECT_NOTHING;
+    tokenizer_p->curr_p = curr_p;
+}
+
+static inline uint32_t _json_hex4(const char* hex_p)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; i++)
+    {
+        const char c = hex_p[i];
+        value        = (value << 4)
+              | (uint32_t)(_is_digit(c) ? c - '0' : (c | 0x20) - 'a' + 10);
+    }
+    return value;
+}
+
+// Write the UTF-8 encoding of `code_point` at `out_p` and return its length.
+static size_t _json_utf8_encode(uint32_t code_point, char* out_p)
+{
+    if (code_point < 0x80)
+    {
+        out_p[0] = (char)code_point;
+        return 1;
+    }
+    if (code_point < 0x800)
+    {
+        out_p[0] = (char)(0xC0 | (code_point >> 6));
+        out_p[1] = (char)(0x80 | (code_point & 0x3F));
+        return 2;
+    }
+    if (code_point < 0x10000)
+    {
+        out_p[0] = (char)(0xE0 | (code_point >> 12));
+        out_p[1] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        out_p[2] = (char)(0x80 | (code_point & 0x3F));
+        return 3;
+    }
+    out_p[0] = (char)(0xF0 | (code_point >> 18));
+    out_p[1] = (char)(0x80 | ((code_point >> 12) & 0x3F));
+    out_p[2] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+    out_p[3] = (char)(0x80 | (code_point & 0x3F));
+    return 4;
+}
+
+// Decode in place the escape sequences of the `len` chars at `cstr`, validated by the tokenizer,
+// and return the new length. A decoded sequence is never longer than the sequence itself. Surrogates
+// which are not part of a pair become U+FFFD.
+static size_t _json_unescape(char* cstr, size_t len)
+{
+    const char* end_p = cstr + len;
+    const char* in_p  = memchr(cstr, '\\', len);
+    char* out_p       = (char*)in_p;
+    while (in_p != NULL)
+    {
+        uint32_t code_point;
+        switch (in_p[1])
+        {
+        case 'b':
+            code_point = '\b';
+            break;
+        case 'f':
+            code_point = '\f';
+            break;
+        case 'n':
+            code_point = '\n';
+            break;
+        case 'r':
+            code_point = '\r';
+            break;
+        case 't':
+            code_point = '\t';
+            break;
+        case 'u':
+            code_point = _json_hex4(in_p + 2);
+            if ((code_point >= 0xD800) && (code_point < 0xDC00) && (end_p - in_p >= 12)
+                && (in_p[6] == '\\') && (in_p[7] == 'u'))
+            {
+                const uint32_t low_surrogate = _json_hex4(in_p + 8);
+                if ((low_surrogate >= 0xDC00) && (low_surrogate < 0xE000))
+                {
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low_surrogate - 0xDC00);
+                    in_p += 6;
+                }
+            }
+            if ((code_point >= 0xD800) && (code_point < 0xE000))
+            {
+                code_point = 0xFFFD;
+            }
+            in_p += 4;
+            break;
+        default: // One of `"\/`
+            code_point = (uint32_t)in_p[1];
+            break;
+        }
+        in_p += 2;
+        out_p += _json_utf8_encode(code_point, out_p);
+        // Move the chars up to the next escape sequence.
+        const char* next_p = memchr(in_p, '\\', (size_t)(end_p - in_p));
+        const size_t chunk = (size_t)((next_p ? next_p : end_p) - in_p);
+        memmove(out_p, in_p, chunk);
+        out_p += chunk;
+        in_p = next_p;
+    }
+    return (out_p == NULL) ? len : (size_t)(out_p - cstr);
+}
+
+// Decode the key or string of `token_p` in place and null-terminate it, hence it can be returned as
+// is. Return its length, which a string with escape sequences loses.
+static size_t _JsonToken_terminate(const JsonToken* token_p)
+{
+    char* cstr       = (char*)token_p->start_p;
+    const size_t len = token_p->has_escapes ? _json_unescape(cstr, token_p->len) : token_p->len;
+    cstr[len]        = '\0';
+    return len;
+}
+
+// Set the value of `item_p` from a token which is neither a key nor the beginning of a container.
+static Error _JsonItem_set_scalar(JsonItem* item_p, const JsonToken* token_p)
+{
+    switch (token_p->type)
+    {
+    case TOKEN_STRING:
+        if (token_p->len > UINT32_MAX)
+        {
+            LOG_ERROR("String too long");
+            return ERR_JSON_INVALID;
+        }
+        item_p->value.value_type = VALUE_CSTR;
+        item_p->value.cstr_len   = (uint32_t)_JsonToken_terminate(token_p);
+        item_p->value.value_cstr = token_p->start_p;
+        return ERR_ALL_GOOD;
+    case TOKEN_NUMBER:
+        return _JsonItem_set_number(item_p, token_p);
+    case TOKEN_TRUE:
+    case TOKEN_FALSE:
+        item_p->value.value_type = VALUE_BOOL;
+        item_p->value.value_bool = (token_p->type == TOKEN_TRUE);
+        return ERR_ALL_GOOD;
+    case TOKEN_NULL:
+        item_p->value.value_type = VALUE_NULL;
+        return ERR_ALL_GOOD;
+    default:
+        LOG_ERROR("Unexpected token %d", token_p->type);
+        return ERR_JSON_INVALID;
+    }
+}
+
+#define JSON_KEY_TABLE_MIN_CAPACITY (64)
+
+typedef struct
+{
+    uint64_t hash;
+    size_t len;
+    char key[];
+} JsonInternedKey;
+
+// Open addressing table of keys. When full, it is replaced by a larger one, while threads may still
+// be reading it, hence the previous tables are only released with the whole `JsonKeyTable`.
+struct JsonKeySlots
+{
+    size_t capacity; // Power of 2.
+    JsonKeySlots* prev_p;
+    JsonInternedKey* keys_pp[];
+};
+
+static inline uint64_t _json_hash(const char* key, size_t len)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash = (hash ^ (unsigned char)key[i]) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+static JsonKeySlots* _JsonKeySlots_new(size_t capacity, JsonKeySlots* prev_p)
+{
+    const size_t size     = sizeof(JsonKeySlots) + capacity * sizeof(JsonInternedKey*);
+    JsonKeySlots* slots_p = my_memory_malloc(__FILENAME__, __LINE__, size);
+    memset(slots_p, 0, size);
+    slots_p->capacity = capacity;
+    slots_p->prev_p   = prev_p;
+    return slots_p;
+}
+
+// Return the slot holding `key`, or the empty slot where it would go.
+static JsonInternedKey** _JsonKeySlots_probe(
+    JsonKeySlots* slots_p,
+    const char* key,
+    size_t len,
+    uint64_t hash)
+{
+    const size_t mask = slots_p->capacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask)
+    {
+        JsonInternedKey* interned_p = __atomic_load_n(&slots_p->keys_pp[i], __ATOMIC_ACQUIRE);
+        if ((interned_p == NULL)
+            || ((interned_p->hash == hash) && (interned_p->len == len)
+                && (memcmp(interned_p->key, key, len) == 0)))
+        {
+            return &slots_p->keys_pp[i];
+        }
+    }
+}
+
+Error _JsonKeyTable_new(const char* file, const int line, JsonKeyTable* out_table_p)
+{
+    UNUSED(file);
+    UNUSED(line);
+    out_table_p->slots_p = _JsonKeySlots_new(JSON_KEY_TABLE_MIN_CAPACITY, NULL);
+    out_table_p->len     = 0;
+    pthread_mutex_init(&out_table_p->mutex, NULL);
+    return ERR_ALL_GOOD;
+}
+
+void JsonKeyTable_destroy(JsonKeyTable* table_p)
+{
+    if ((table_p == NULL) || (table_p->slots_p == NULL))
+    {
+        return;
+    }
+    for (size_t i = 0; i < table_p->slots_p->capacity; i++)
+    {
+        my_memory_free(table_p->slots_p->keys_pp[i]);
+    }
+    while (table_p->slots_p != NULL)
+    {
+        JsonKeySlots* prev_p = table_p->slots_p->prev_p;
+        my_memory_free(table_p->slots_p);
+        table_p->slots_p = prev_p;
+    }
+    table_p->len = 0;
+    pthread_mutex_destroy(&table_p->mutex);
+}
+
+// Return the stored copy of `key`, or NULL if no object parsed with the table has it.
+static const char* _JsonKeyTable_find(JsonKeyTable* table_p, const char* key, uint64_t hash)
+{
+    JsonKeySlots* slots_p       = __atomic_load_n(&table_p->slots_p, __ATOMIC_ACQUIRE);
+    JsonInternedKey* interned_p = *_JsonKeySlots_probe(slots_p, key, strlen(key), hash);
+    return interned_p ? interned_p->key : NULL;
+}
+
+// Double the capacity, rehashing the stored keys into new slots.
+static void _JsonKeyTable_grow(JsonKeyTable* table_p)
+{
+    JsonKeySlots* old_slots_p = table_p->slots_p;
+    JsonKeySlots* slots_p     = _JsonKeySlots_new(2 * old_slots_p->capacity, old_slots_p);
+    for (size_t i = 0; i < old_slots_p->capacity; i++)
+    {
+        JsonInternedKey* interned_p = old_slots_p->keys_pp[i];
+        if (interned_p != NULL)
+        {
+            *_JsonKeySlots_probe(slots_p, interned_p->key, interned_p->len, interned_p->hash)
+                = interned_p;
+        }
+    }
+    __atomic_store_n(&table_p->slots_p, slots_p, __ATOMIC_RELEASE);
+}
+
+// Return the stored copy of the `len` chars at `key`, adding it if missing. Stored keys never
+// change, hence they are found without locking, which only adding a key requires.
+static const char* _JsonKeyTable_intern(JsonKeyTable* table_p, const char* key, size_t len)
+{
+    const uint64_t hash   = _json_hash(key, len);
+    JsonKeySlots* slots_p = __atomic_load_n(&table_p->slots_p, __ATOMIC_ACQUIRE);
+    JsonInternedKey** slot_pp = _JsonKeySlots_probe(slots_p, key, len, hash);
+    if (*slot_pp != NULL)
+    {
+        return (*slot_pp)->key;
+    }
+    pthread_mutex_lock(&table_p->mutex);
+    // Another thread may have added the key, or replaced the slots, in the meantime.
+    slots_p = table_p->slots_p;
+    slot_pp = _JsonKeySlots_probe(slots_p, key, len, hash);
+    if (*slot_pp == NULL)
+    {
+        if (4 * (table_p->len + 1) > 3 * slots_p->capacity)
+        {
+            _JsonKeyTable_grow(table_p);
+            slot_pp = _JsonKeySlots_probe(table_p->slots_p, key, len, hash);
+        }
+        JsonInternedKey* interned_p
+            = my_memory_malloc(__FILENAME__, __LINE__, sizeof(JsonInternedKey) + len + 1);
+        interned_p->hash = hash;
+        interned_p->len  = len;
+        memcpy(interned_p->key, key, len);
+        interned_p->key[len] = '\0';
+        __atomic_store_n(slot_pp, interned_p, __ATOMIC_RELEASE);
+        table_p->len++;
+    }
+    const char* interned_key = (*slot_pp)->key;
+    pthread_mutex_unlock(&table_p->mutex);
+    return interned_key;
+}
+
+// Terminate the key of `token_p` and return it, from the key table if the arena has one.
+static inline const char* _JsonArena_key(JsonArena* arena_p, const JsonToken* token_p)
+{
+    const size_t key_len = _JsonToken_terminate(token_p);
+    if (arena_p->key_table_p != NULL)
+    {
+        return _JsonKeyTable_intern(arena_p->key_table_p, token_p->start_p, key_len);
+    }
+    return token_p->start_p;
+}
+
+typedef enum
+{
+    JSON_BUILD_ALL,       // Build every nested container.
+    JSON_BUILD_LAZY,      // Validate nested containers, but leave them unparsed.
+    JSON_BUILD_LAZY_SKIP, // Leave nested containers unparsed, knowing they are valid.
+} JsonBuildMode;
+
+// Where the building of a container is, so that it can be resumed when the input comes in chunks.
+typedef struct
+{
+    JsonItem* parent_p;    // Innermost container being built.
+    JsonItem* curr_item_p; // Last child of `parent_p`.
+    size_t depth;          // Nesting level of the outermost container.
+} JsonBuilder;
+
+// Build the content of the container just opened by the tokenizer up to its end, or up to the end
+// of partial input, in which case the tokenizer is still inside the container. Keys and strings
+// are null-terminated in place, which is safe because the tokenizer has already moved past their
+// closing quote.
+static Error _JsonItem_build_resume(
+    const char* file,
+    const int line,
+    JsonArena* arena_p,
+    JsonTokenizer* tokenizer_p,
+    JsonBuilder* builder_p,
+    JsonBuildMode mode)
+{
+    const size_t depth    = builder_p->depth;
+    JsonItem* parent_p    = builder_p->parent_p;
+    JsonItem* curr_item_p = builder_p->curr_item_p;
+    JsonToken token;
+    while (tokenizer_p->depth >= depth)
+    {
+        switch (_JsonTokenizer_next(tokenizer_p, &token))
+        {
+        case TOKEN_END:
+        case TOKEN_INVALID:
+            return _JsonTokenizer_error(tokenizer_p);
+        case TOKEN_INCOMPLETE:
+            builder_p->parent_p    = parent_p;
+            builder_p->curr_item_p = curr_item_p;
+            return ERR_ALL_GOOD;
+        case TOKEN_KEY:
+            curr_item_p        = _JsonItem_append(file, line, arena_p, parent_p, curr_item_p);
+            curr_item_p->key_p = _JsonArena_key(arena_p, &token);
+            continue;
+        case TOKEN_ARRAY_END:
+        case TOKEN_OBJECT_END:
+            curr_item_p = parent_p;
+            parent_p    = parent_p->parent;
+            continue;
+        default:
+            break;
+        }
+        // If we are here, it's a value. Object members were created together with their key, while
+        // array elements need a new item.
+        if (parent_p->value.value_type == VALUE_ARRAY)
+        {
+            curr_item_p = _JsonItem_append(file, line, arena_p, parent_p, curr_item_p);
+        }
+        switch (token.type)
+        {
+        case TOKEN_OBJECT_BEGIN:
+        case TOKEN_ARRAY_BEGIN:
+            if ((mode != JSON_BUILD_ALL) && (tokenizer_p->depth > depth))
+            {
+                // Only remember where the container starts: see `_JsonItem_materialize()`.
+                curr_item_p->value.value_type = VALUE_LAZY;
+                curr_item_p->value.value_cstr = token.start_p;
+                if (mode == JSON_BUILD_LAZY_SKIP)
+                {
+                    _JsonTokenizer_skip_container(tokenizer_p);
+                }
+                else if (!_JsonTokenizer_validate_container(tokenizer_p))
+                {
+                    return _JsonTokenizer_error(tokenizer_p);
+                }
+                break;
+            }
+            _JsonItem_open_container(file, line, arena_p, curr_item_p, token.type);
+            parent_p    = curr_item_p;
+            curr_item_p = NULL;
+            break;
+        default:
+            if (is_err(_JsonItem_set_scalar(curr_item_p, &token)))
+            {
+                return ERR_JSON_INVALID;
+            }
+            break;
+        }
+    }
+    return ERR_ALL_GOOD;
+}
+
+// Build the content of the container just opened by the tokenizer, whose item is `parent_p`.
+static Error _JsonItem_build(
+    const char* file,
+    const int line,
+    JsonArena* arena_p,
+    JsonTokenizer* tokenizer_p,
+    JsonItem* parent_p,
+    JsonBuildMode mode)
+{
+    JsonBuilder builder = {
+        .parent_p    = parent_p,
+        .curr_item_p = NULL,
+        .depth       = tokenizer_p->depth,
+    };
+    return _JsonItem_build_resume(file, line, arena_p, tokenizer_p, &builder, mode);
+}
+
+// Build the next value, whatever its type, into `item_p`.
+static Error _JsonItem_build_value(
+    const char* file,
+    const int line,
+    JsonArena* arena_p,
+    JsonTokenizer* tokenizer_p,
+    JsonItem* item_p,
+    JsonBuildMode mode)
+{
+    JsonToken token;
+    switch (_JsonTokenizer_next(tokenizer_p, &token))
+    {
+    case TOKEN_END:
+    case TOKEN_INVALID:
+        return _JsonTokenizer_error(tokenizer_p);
+    case TOKEN_OBJECT_BEGIN:
+    case TOKEN_ARRAY_BEGIN:
+        _JsonItem_open_container(file, line, arena_p, item_p, token.type);
+        return _JsonItem_build(file, line, arena_p, tokenizer_p, item_p, mode);
+    default:
+        return is_err(_JsonItem_set_scalar(item_p, &token)) ? ERR_JSON_INVALID : ERR_ALL_GOOD;
+    }
+}
+
+// Largest top-level object whose shape is remembered.
+#define JSON_SHAPE_MAX_MEMBERS (256)
+
+typedef struct
+{
+    const char* key; // Stored after the members of the shape, without terminator.
+    size_t key_len;
+    ValueType value_type;
+} JsonShapeMember;
+
+// Keys and value types of the members of a top-level object, in order.
+struct JsonShape
+{
+    size_t len;
+    JsonShapeMember members[];
+};
+
+// Whether `key` can be compared verbatim with the input, i.e. it was not escaped there.
+static bool _json_is_plain_key(const char* key, size_t* out_len_p)
+{
+    const char* c_p = key;
+    for (; *c_p != '\0'; c_p++)
+    {
+        if ((*c_p == '"') || (*c_p == '\\') || ((unsigned char)*c_p < 0x20))
+        {
+            return false;
+        }
+    }
+    *out_len_p = (size_t)(c_p - key);
+    return true;
+}
+
+// Record the members following `first_item_p`, or return NULL if the object cannot be predicted.
+static JsonShape* _JsonShape_new(const char* file, const int line, const JsonItem* first_item_p)
+{
+    size_t len       = 0;
+    size_t keys_size = 0;
+    for (const JsonItem* item_p = first_item_p; item_p != NULL; item_p = item_p->next_sibling)
+    {
+        size_t key_len;
+        if ((++len > JSON_SHAPE_MAX_MEMBERS) || !_json_is_plain_key(item_p->key_p, &key_len))
+        {
+            return NULL;
+        }
+        keys_size += key_len;
+    }
+    JsonShape* shape_p = my_memory_malloc(
+        file, line, sizeof(JsonShape) + len * sizeof(JsonShapeMember) + keys_size);
+    JsonShapeMember* member_p = shape_p->members;
+    char* key_p               = (char*)&shape_p->members[len];
+    shape_p->len              = len;
+    for (const JsonItem* item_p = first_item_p; item_p != NULL; item_p = item_p->next_sibling)
+    {
+        _json_is_plain_key(item_p->key_p, &member_p->key_len);
+        memcpy(key_p, item_p->key_p, member_p->key_len);
+        member_p->key        = key_p;
+        member_p->value_type = item_p->value.value_type;
+        key_p += member_p->key_len;
+        member_p++;
+    }
+    return shape_p;
+}
+
+Error _JsonShapeCache_new(const char* file, const int line, JsonShapeCache* out_cache_p)
+{
+    UNUSED(file);
+    UNUSED(line);
+    for (size_t i = 0; i < JSON_SHAPE_CACHE_SIZE; i++)
+    {
+        out_cache_p->shapes_pp[i] = NULL;
+    }
+    out_cache_p->next_slot = 0;
+    out_cache_p->hits      = 0;
+    out_cache_p->misses    = 0;
+    return ERR_ALL_GOOD;
+}
+
+void JsonShapeCache_destroy(JsonShapeCache* cache_p)
+{
+    if (cache_p == NULL)
+    {
+        return;
+    }
+    for (size_t i = 0; i < JSON_SHAPE_CACHE_SIZE; i++)
+    {
+        my_memory_free(cache_p->shapes_pp[i]);
+        cache_p->shapes_pp[i] = NULL;
+    }
+}
+
+// Read the first key of the object just opened if a shape starts with it, and return the slot of
+// that shape. Otherwise return JSON_SHAPE_CACHE_SIZE, with the tokenizer left where it was.
+static size_t _JsonShapeCache_find(
+    const JsonShapeCache* cache_p,
+    JsonTokenizer* tokenizer_p,
+    JsonToken* out_token_p)
+{
+    for (size_t i = 0; i < JSON_SHAPE_CACHE_SIZE; i++)
+    {
+        const JsonShape* shape_p = cache_p->shapes_pp[i];
+        if ((shape_p != NULL)
+            && _JsonTokenizer_match_key(
+                tokenizer_p, shape_p->members[0].key, shape_p->members[0].key_len, out_token_p))
+        {
+            return i;
+        }
+    }
+    return JSON_SHAPE_CACHE_SIZE;
+}
+
+// Remember `shape_p` in place of the shape in `slot`, or of the oldest one if `slot` is not valid.
+static void _JsonShapeCache_store(JsonShapeCache* cache_p, size_t slot, JsonShape* shape_p)
+{
+    if (slot >= JSON_SHAPE_CACHE_SIZE)
+    {
+        slot               = cache_p->next_slot;
+        cache_p->next_slot = (cache_p->next_slot + 1) % JSON_SHAPE_CACHE_SIZE;
+    }
+    my_memory_free(cache_p->shapes_pp[slot]);
+    cache_p->shapes_pp[slot] = shape_p;
+}
+
+// Build the members of the top-level object just opened by the tokenizer. If a shape of the cache
+// starts with the first key, the members it predicts are built into one block of items, each key
+// being matched against the input rather than scanned, until a member differs. The rest is built
+// as usual, and the cache learns the new shape unless the prediction was exact.
+static Error _JsonItem_build_shaped(
+    const char* file,
+    const int line,
+    JsonArena* arena_p,
+    JsonTokenizer* tokenizer_p,
+    JsonItem* root_p)
+{
+    JsonShapeCache* cache_p = arena_p->shape_cache_p;
+    JsonBuilder builder     = {
+        .parent_p    = root_p,
+        .curr_item_p = NULL,
+        .depth       = tokenizer_p->depth,
+    };
+    JsonToken token;
+    Error ret_err     = ERR_ALL_GOOD;
+    const size_t slot = _JsonShapeCache_find(cache_p, tokenizer_p, &token);
+    bool is_predicted = false;
+    if (slot < JSON_SHAPE_CACHE_SIZE)
+    {
+        const JsonShape* shape_p = cache_p->shapes_pp[slot];
+        JsonItem* items_p
+            = _JsonArena_alloc(file, line, arena_p, shape_p->len * sizeof(JsonItem));
+        size_t i     = 0;
+        is_predicted = true;
+        do
+        {
+            JsonItem* item_p         = &items_p[i];
+            item_p->key_p            = _JsonArena_key(arena_p, &token);
+            item_p->index            = 0;
+            item_p->value.value_type = VALUE_UNDEFINED;
+            item_p->parent           = root_p;
+            item_p->next_sibling     = NULL;
+            if (builder.curr_item_p == NULL)
+            {
+                root_p->next_sibling = item_p;
+            }
+            else
+            {
+                builder.curr_item_p->next_sibling = item_p;
+            }
+            builder.curr_item_p = item_p;
+            ret_err             = _JsonItem_build_value(
+                file, line, arena_p, tokenizer_p, item_p, JSON_BUILD_ALL);
+            if (is_err(ret_err))
+            {
+                return ret_err;
+            }
+            is_predicted = is_predicted
+                        && (item_p->value.value_type == shape_p->members[i].value_type);
+            i++;
+        } while ((i < shape_p->len)
+                 && _JsonTokenizer_match_key(
+                     tokenizer_p, shape_p->members[i].key, shape_p->members[i].key_len, &token));
+        is_predicted = is_predicted && (i == shape_p->len);
+    }
+    const JsonItem* last_predicted_p = builder.curr_item_p;
+    ret_err = _JsonItem_build_resume(file, line, arena_p, tokenizer_p, &builder, JSON_BUILD_ALL);
+    if (is_err(ret_err))
+    {
+        return ret_err;
+    }
+    if (is_predicted && (last_predicted_p->next_sibling == NULL))
+    {
+        cache_p->hits++;
+        return ERR_ALL_GOOD;
+    }
+    cache_p->misses++;
+    JsonShape* shape_p
+        = (root_p->next_sibling != NULL) ? _JsonShape_new(file, line, root_p->next_sibling) : NULL;
+    if (shape_p != NULL)
+    {
+        _JsonShapeCache_store(cache_p, slot, shape_p);
+    }
+    return ERR_ALL_GOOD;
+}
+
+static Error _deserialize(
+    const char* file,
+    const int line,
+    JsonObj* json_obj_p,
+    JsonTokenizer* tokenizer_p,
+    JsonBuildMode mode)
+{
+    JsonArena* arena_p  = &json_obj_p->arena;
+    JsonItem* root_p    = &json_obj_p->root;
+    const char* first_p = _JsonTokenizer_skip_whitespace(tokenizer_p, tokenizer_p->curr_p);
+    Error ret_err       = ERR_ALL_GOOD;
+    JsonToken token;
+    if ((first_p < tokenizer_p->end_p) && (*first_p == '{'))
+    {
+        // The members of a top-level object are the children of root.
+        _JsonTokenizer_next(tokenizer_p, &token);
+        ret_err = (arena_p->shape_cache_p != NULL)
+                    ? _JsonItem_build_shaped(file, line, arena_p, tokenizer_p, root_p)
+                    : _JsonItem_build(file, line, arena_p, tokenizer_p, root_p, mode);
+    }
+    else if ((first_p < tokenizer_p->end_p) && (*first_p == '['))
+    {
+        // A top-level array is the only child of root, without a key.
+        JsonItem* array_item_p = _JsonItem_append(file, line, arena_p, root_p, NULL);
+        ret_err                = _JsonItem_build_value(
+            file, line, arena_p, tokenizer_p, array_item_p, mode);
+    }
+    else
+    {
+        LOG_ERROR("Invalid JSON string.");
+        return ERR_JSON_INVALID;
+    }
+    if (is_err(ret_err))
+    {
+        return ret_err;
+    }
+    if (_JsonTokenizer_next(tokenizer_p, &token) != TOKEN_END)
+    {
+        return _JsonTokenizer_error(tokenizer_p);
+    }
+    return ERR_ALL_GOOD;
+}
+
+// Objects whose lookups walk at least this many siblings get a hashed key index.
+#define JSON_KEY_INDEX_THRESHOLD (16)
+
+typedef struct
+{
+    const JsonItem* parent_p; // NULL for empty slots.
+    const JsonItem* item_p;   // NULL for the entry marking `parent_p` as indexed.
+    uint64_t hash;
+} JsonKeyIndexEntry;
+
+// Open-addressing hash table shared by all the indexed objects of a `JsonObj`. Entries are keyed
+// by the parent item and the key, so that members of different objects never clash. Entries are
+// added under the mutex of the object and published by storing `parent_p` last, hence lookups can
+// run without locking. A table outgrown is kept until the object is destroyed, as lookups started
+// before it was replaced may still be reading it.
+typedef struct JsonKeyIndex
+{
+    size_t capacity; // Always a power of 2.
+    size_t size;
+    struct JsonKeyIndex* retired_p; // Table replaced by this one.
+    JsonKeyIndexEntry entries[];
+} JsonKeyIndex;
+
+static void _JsonKeyIndex_destroy(JsonKeyIndex* index_p)
+{
+    while (index_p != NULL)
+    {
+        JsonKeyIndex* retired_p = index_p->retired_p;
+        my_memory_free(index_p);
+        index_p = retired_p;
+    }
+}
+
+// Leave the object in a state that can be safely destroyed, whatever happens next.
+static void _JsonObj_clear(JsonObj* json_obj_p, size_t arena_size_hint)
+{
+    json_obj_p->json_cstr             = NULL;
+    json_obj_p->json_len              = 0;
+    json_obj_p->root.key_p            = NULL;
+    json_obj_p->root.index            = 0;
+    json_obj_p->root.value.value_type = VALUE_UNDEFINED;
+    json_obj_p->root.next_sibling     = NULL;
+    json_obj_p->root.parent           = &json_obj_p->root;
+    json_obj_p->key_index_p           = NULL;
+    json_obj_p->mapped_size           = 0;
+    pthread_mutex_init(&json_obj_p->mutex, NULL);
+    _JsonArena_init(&json_obj_p->arena, arena_size_hint);
+}
+
+// Parse `json_obj_p->json_cstr`, which is terminated in place, into the items of `json_obj_p`.
+static Error _JsonObj_parse(
+    const char* file,
+    const int line,
+    JsonObj* json_obj_p,
+    JsonBuildMode mode)
+{
+    JsonTokenizer tokenizer;
+    _JsonTokenizer_init(&tokenizer, json_obj_p->json_cstr, json_obj_p->json_len);
+
+    // Create a dummy root item as the entry point of the JSON object. The first actual item is the
+    // first sibling of root. This prevents root's value type from being overwritten, hence causing
+    // errors. The parent is set to root itself to recognize it.
+    json_obj_p->root.value.value_type = VALUE_ROOT;
+    json_obj_p->root.next_sibling     = NULL;
+
+    LOG_DEBUG("JSON deserialization started.");
+    if (is_err(_deserialize(file, line, json_obj_p, &tokenizer, mode)))
+    {
+        LOG_ERROR("Failed to deserialize JSON");
+        return ERR_JSON_INVALID;
+    }
+    LOG_DEBUG("JSON deserialization ended successfully.")
+
+    return ERR_ALL_GOOD;
+}
+
+// Parse `json_len` chars at `json_p` in place into an object which does not own them, reusing the
+// memory of the previous parse. Such an object must have its `json_cstr` reset before destruction.
+static Error _JsonObj_reparse(
+    const char* file,
+    const int line,
+    JsonObj* json_obj_p,
+    char* json_p,
+    size_t json_len)
+{
+    _JsonArena_reset(&json_obj_p->arena);
+    _JsonKeyIndex_destroy(json_obj_p->key_index_p);
+    json_obj_p->key_index_p = NULL;
+    json_obj_p->json_cstr   = json_p;
+    json_obj_p->json_len    = json_len;
+    return _JsonObj_parse(file, line, json_obj_p, JSON_BUILD_ALL);
+}
+
+static Error _JsonObj_init(
+    const char* file,
+    const int line,
+    const char* json_cstr,
+    JsonKeyTable* key_table_p,
+    JsonShapeCache* shape_cache_p,
+    JsonObj* out_json_obj_p,
+    JsonBuildMode mode)
+{
+    _JsonObj_clear(out_json_obj_p, 0);
+    const size_t json_len = strlen(json_cstr);
+    if (json_len == 0)
+    {
+        LOG_ERROR("Empty JSON string detected");
+        return ERR_EMPTY_STRING;
+    }
+    // Keys and strings are returned as pointers to null-terminated strings that must outlive the
+    // input, hence the tokenizer runs on a private copy which is terminated in place.
+    out_json_obj_p->json_cstr = my_memory_malloc(file, line, json_len + 1);
+    out_json_obj_p->json_len  = json_len;
+    memcpy(out_json_obj_p->json_cstr, json_cstr, json_len + 1);
+    // A lazy object builds a small fraction of the items, if any.
+    _JsonArena_init(&out_json_obj_p->arena, (mode == JSON_BUILD_ALL) ? json_len : 0);
+    out_json_obj_p->arena.key_table_p   = key_table_p;
+    out_json_obj_p->arena.shape_cache_p = shape_cache_p;
+
+    if (is_err(_JsonObj_parse(file, line, out_json_obj_p, mode)))
+    {
+        JsonObj_destroy(out_json_obj_p);
+        return ERR_JSON_INVALID;
+    }
+    return ERR_ALL_GOOD;
+}
+
+Error _JsonObj_new(
+    const char* file,
+    const int line,
+    const char* json_cstr,
+    JsonObj* out_json_obj_p)
+{
+    return _JsonObj_init(file, line, json_cstr, NULL, NULL, out_json_obj_p, JSON_BUILD_ALL);
+}
+
+// Validate the whole input, but only build the top-level members. Nested objects and arrays are
+// built one level at a time, when accessed for the first time.
+Error _JsonObj_new_lazy(
+    const char* file,
+    const int line,
+    const char* json_cstr,
+    JsonObj* out_json_obj_p)
+{
+    return _JsonObj_init(file, line, json_cstr, NULL, NULL, out_json_obj_p, JSON_BUILD_LAZY);
+}
+
+Error _JsonObj_new_interned(
+    const char* file,
+    const int line,
+    const char* json_cstr,
+    JsonKeyTable* key_table_p,
+    JsonObj* out_json_obj_p)
+{
+    return _JsonObj_init(
+        file, line, json_cstr, key_table_p, NULL, out_json_obj_p, JSON_BUILD_ALL);
+}
+
+// Only top-level objects are predicted. The cache must not be used while another object is parsed
+// with it, but it may be destroyed before the objects.
+Error _JsonObj_new_shaped(
+    const char* file,
+    const int line,
+    const char* json_cstr,
+    JsonShapeCache* shape_cache_p,
+    JsonObj* out_json_obj_p)
+{
+    return _JsonObj_init(
+        file, line, json_cstr, NULL, shape_cache_p, out_json_obj_p, JSON_BUILD_ALL);
+}
+
+// Map the file copy-on-write and parse it in place: the pages are read from the page cache as the
+// tokenizer gets to them, and only those where a key or a string is terminated get copied.
+Error _JsonObj_new_from_file(
+    const char* file,
+    const int line,
+    const char* path,
+    JsonObj* out_json_obj_p)
+{
+    _JsonObj_clear(out_json_obj_p, 0);
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+    {
+        LOG_PERROR("Failed to open `%s`.", path);
+        return ERR_FS_INTERNAL;
+    }
+    struct stat st = {0};
+    if (fstat(fd, &st) == -1)
+    {
+        LOG_PERROR("Failed to stat `%s`.", path);
+        close(fd);
+        return ERR_FS_INTERNAL;
+    }
+    if (st.st_size == 0)
+    {
+        LOG_ERROR("Empty JSON file detected");
+        close(fd);
+        return ERR_EMPTY_STRING;
+    }
+    const size_t json_len = (size_t)st.st_size;
+    char* json_p = mmap(NULL, json_len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (json_p == MAP_FAILED)
+    {
+        LOG_PERROR("Failed to map `%s`.", path);
+        return ERR_FS_INTERNAL;
+    }
+    madvise(json_p, json_len, MADV_SEQUENTIAL);
+    out_json_obj_p->json_cstr   = json_p;
+    out_json_obj_p->json_len    = json_len;
+    out_json_obj_p->mapped_size = json_len;
+    _JsonArena_init(&out_json_obj_p->arena, json_len);
+    if (is_err(_JsonObj_parse(file, line, out_json_obj_p, JSON_BUILD_ALL)))
+    {
+        JsonObj_destroy(out_json_obj_p);
+        return ERR_JSON_INVALID;
+    }
+    return ERR_ALL_GOOD;
+}
+
+void JsonObj_destroy(JsonObj* json_obj_p)
+{
+    // Root is its own parent from construction to destruction.
+    if ((json_obj_p == NULL) || (json_obj_p->root.parent == NULL))
+    {
+        return;
+    }
+    // All the items live in the arena, hence there is no need to walk the tree.
+    _JsonArena_destroy(&json_obj_p->arena);
+    json_obj_p->root.value.value_type = VALUE_UNDEFINED;
+    json_obj_p->root.next_sibling     = NULL;
+    json_obj_p->root.parent           = NULL;
+    _JsonKeyIndex_destroy(json_obj_p->key_index_p);
+    json_obj_p->key_index_p = NULL;
+    pthread_mutex_destroy(&json_obj_p->mutex);
+    if (json_obj_p->mapped_size > 0)
+    {
+        munmap(json_obj_p->json_cstr, json_obj_p->mapped_size);
+    }
+    else
+    {
+        my_memory_free(json_obj_p->json_cstr);
+    }
+    json_obj_p->json_cstr   = NULL;
+    json_obj_p->json_len    = 0;
+    json_obj_p->mapped_size = 0;
+    json_obj_p              = NULL;
+}
+
+// Run the tokenizer over the whole input without building or allocating anything. Numbers are
+// checked against the grammar only, not against the range of the C types they would be read into.
+Error JsonObj_validate(const char* json_p, size_t json_len, size_t* out_error_offset_p)
+{
+    if (json_len == 0)
+    {
+        return ERR_EMPTY_STRING;
+    }
+    JsonTokenizer tokenizer;
+    JsonToken token;
+    JsonTokenType token_type;
+    _JsonTokenizer_init(&tokenizer, json_p, json_len);
+    // As for `JsonObj_new()`, the top-level value must be an object or an array.
+    const char* first_p = _JsonTokenizer_skip_whitespace(&tokenizer, json_p);
+    if ((first_p == tokenizer.end_p) || ((*first_p != '{') && (*first_p != '[')))
+    {
+        tokenizer.curr_p = first_p;
+        token_type       = TOKEN_INVALID;
+    }
+    else
+    {
+        do
+        {
+            token_type = _JsonTokenizer_next(&tokenizer, &token);
+        } while ((token_type != TOKEN_END) && (token_type != TOKEN_INVALID));
+    }
+    if (token_type == TOKEN_INVALID)
+    {
+        if (out_error_offset_p != NULL)
+        {
+            *out_error_offset_p = (size_t)(tokenizer.curr_p - json_p);
+        }
+        return ERR_JSON_INVALID;
+    }
+    return ERR_ALL_GOOD;
+}
+
+// Store `value_p` into the field at `field_p`, of type `value_type`. Integers are converted when
+// the field can represent them, as `Json_get()` does.
+static bool _JsonValue_store(const JsonValue* value_p, ValueType value_type, void* field_p)
+{
+    switch (value_type)
+    {
+    case VALUE_CSTR:
+        if (value_p->value_type != VALUE_CSTR)
+        {
+            return false;
+        }
+        *(const char**)field_p = value_p->value_cstr;
+        return true;
+    case VALUE_BOOL:
+        if (value_p->value_type != VALUE_BOOL)
+        {
+            return false;
+        }
+        *(bool*)field_p = value_p->value_bool;
+        return true;
+    case VALUE_LLD:
+        if ((value_p->value_type == VALUE_LLU) && (value_p->value_llu > (llu_t)LLONG_MAX))
+        {
+            return false;
+        }
+        if ((value_p->value_type != VALUE_LLD) && (value_p->value_type != VALUE_LLU))
+        {
+            return false;
+        }
+        *(lld_t*)field_p = value_p->value_lld;
+        return true;
+    case VALUE_LLU:
+        if ((value_p->value_type == VALUE_LLD) && (value_p->value_lld < 0))
+        {
+            return false;
+        }
+        if ((value_p->value_type != VALUE_LLD) && (value_p->value_type != VALUE_LLU))
+        {
+            return false;
+        }
+        *(llu_t*)field_p = value_p->value_llu;
+        return true;
+    case VALUE_DOUBLE:
+        if (value_p->value_type == VALUE_DOUBLE)
+        {
+            *(double*)field_p = value_p->value_double;
+        }
+        else if (value_p->value_type == VALUE_LLD)
+        {
+            *(double*)field_p = (double)value_p->value_lld;
+        }
+        else if (value_p->value_type == VALUE_LLU)
+        {
+            *(double*)field_p = (double)value_p->value_llu;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Return the binding of the decoded key in `token_p`, or -1. The keys of the bindings are
+// `key_lens` long. Keys usually come in the order they are bound, hence the binding following the
+// previous match, `*next_p`, is tried first. A decoded key may hold a null character, hence the
+// length is compared before the bytes.
+static int _JsonBinding_find(
+    const JsonBinding* bindings_p,
+    const size_t* key_lens,
+    size_t num_of_bindings,
+    const JsonToken* token_p,
+    size_t* next_p)
+{
+    for (size_t n = 0; n < num_of_bindings; n++)
+    {
+        const size_t i = (*next_p + n) % num_of_bindings;
+        if ((key_lens[i] == token_p->len)
+            && (memcmp(bindings_p[i].key, token_p->start_p, token_p->len) == 0))
+        {
+            *next_p = i + 1;
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Fill the fields of the struct at `out_struct_p` from the members of the top-level object in a
+// single pass, without building any item. Bit `i` of `*out_missing_p` is set if the key of binding
+// `i` is missing, and of `*out_mismatch_p` if its value cannot be stored into the field. String
+// fields point into `json_cstr`, whose strings are null-terminated in place. Members which are not
+// bound are validated and skipped.
+Error Json_decode(
+    char* json_cstr,
+    const JsonBinding* bindings_p,
+    size_t num_of_bindings,
+    void* out_struct_p,
+    uint64_t* out_missing_p,
+    uint64_t* out_mismatch_p)
+{
+    if ((json_cstr == NULL) || (num_of_bindings > JSON_MAX_BINDINGS))
+    {
+        LOG_ERROR("Invalid input: at most %d bindings are supported.", JSON_MAX_BINDINGS);
+        return ERR_INVALID;
+    }
+    size_t key_lens[JSON_MAX_BINDINGS];
+    for (size_t i = 0; i < num_of_bindings; i++)
+    {
+        key_lens[i] = strlen(bindings_p[i].key);
+    }
+    uint64_t found_mask = 0;
+    *out_mismatch_p     = 0;
+    *out_missing_p      = (num_of_bindings == JSON_MAX_BINDINGS)
+                            ? UINT64_MAX
+                            : (((uint64_t)1 << num_of_bindings) - 1);
+    JsonTokenizer tokenizer;
+    JsonToken token;
+    _JsonTokenizer_init(&tokenizer, json_cstr, strlen(json_cstr));
+    if (_JsonTokenizer_next(&tokenizer, &token) != TOKEN_OBJECT_BEGIN)
+    {
+        LOG_ERROR("Only objects can be decoded.");
+        return ERR_JSON_INVALID;
+    }
+    size_t next_binding = 0;
+    int binding         = -1;
+    while (tokenizer.depth > 0)
+    {
+        JsonItem item;
+        switch (_JsonTokenizer_next(&tokenizer, &token))
+        {
+        case TOKEN_KEY:
+            token.len = _JsonToken_terminate(&token);
+            binding   = _JsonBinding_find(
+                bindings_p, key_lens, num_of_bindings, &token, &next_binding);
+            // With duplicate keys, the first one wins as it does in a lookup.
+            if ((binding >= 0) && (found_mask & ((uint64_t)1 << binding)))
+            {
+                binding = -1;
+            }
+            continue;
+        case TOKEN_OBJECT_END:
+            continue;
+        case TOKEN_OBJECT_BEGIN:
+        case TOKEN_ARRAY_BEGIN:
+            if (!_JsonTokenizer_validate_container(&tokenizer))
+            {
+                return _JsonTokenizer_error(&tokenizer);
+            }
+            item.value.value_type = VALUE_ITEM;
+            break;
+        case TOKEN_END:
+        case TOKEN_INVALID:
+        case TOKEN_INCOMPLETE:
+            return _JsonTokenizer_error(&tokenizer);
+        default:
+            if (binding < 0)
+            {
+                continue;
+            }
+            if (is_err(_JsonItem_set_scalar(&item, &token)))
+            {
+                // A number out of range.
+                item.value.value_type = VALUE_INVALID;
+            }
+            break;
+        }
+        if (binding < 0)
+        {
+            continue;
+        }
+        const JsonBinding* binding_p = &bindings_p[binding];
+        const uint64_t bit           = (uint64_t)1 << binding;
+        found_mask |= bit;
+        *out_missing_p &= ~bit;
+        if (!_JsonValue_store(
+                &item.value, binding_p->value_type, (char*)out_struct_p + binding_p->offset))
+        {
+            *out_mismatch_p |= bit;
+        }
+        binding = -1;
+    }
+    if (_JsonTokenizer_next(&tokenizer, &token) != TOKEN_END)
+    {
+        return _JsonTokenizer_error(&tokenizer);
+    }
+    if (*out_missing_p != 0)
+    {
+        return ERR_JSON_MISSING_ENTRY;
+    }
+    return (*out_mismatch_p != 0) ? ERR_TYPE_MISMATCH : ERR_ALL_GOOD;
+}
+
+// Whether to go on after calling `callback`, if set.
+#define JSON_SAX_CALL(callback, ...) (((callback) == NULL) || (callback)(__VA_ARGS__))
+
+// Report each token to `handler_p` as soon as the tokenizer has validated it. Scalars are read into
+// an item on the stack, hence nothing is allocated. Keys and strings are decoded and terminated in
+// place, as in `JsonObj_new()`.
+Error Json_sax(char* json_cstr, const JsonSaxHandler* handler_p, void* context_p)
+{
+    if ((json_cstr == NULL) || (handler_p == NULL))
+    {
+        LOG_ERROR("Invalid input");
+        return ERR_NULL;
+    }
+    // As in `JsonObj_new()`, the top-level value is an object or an array.
+    const char* first_p = json_cstr + strspn(json_cstr, " \t\r\n");
+    if ((*first_p != '{') && (*first_p != '['))
+    {
+        LOG_ERROR("Invalid JSON string.");
+        return ERR_JSON_INVALID;
+    }
+    JsonTokenizer tokenizer;
+    JsonToken token;
+    JsonItem item;
+    bool go_on = true;
+    _JsonTokenizer_init(&tokenizer, json_cstr, strlen(json_cstr));
+    while (go_on)
+    {
+        switch (_JsonTokenizer_next(&tokenizer, &token))
+        {
+        case TOKEN_END:
+            return ERR_ALL_GOOD;
+        case TOKEN_INVALID:
+        case TOKEN_INCOMPLETE:
+            return _JsonTokenizer_error(&tokenizer);
+        case TOKEN_OBJECT_BEGIN:
+            go_on = JSON_SAX_CALL(handler_p->on_object_begin, context_p);
+            continue;
+        case TOKEN_OBJECT_END:
+            go_on = JSON_SAX_CALL(handler_p->on_object_end, context_p);
+            continue;
+        case TOKEN_ARRAY_BEGIN:
+            go_on = JSON_SAX_CALL(handler_p->on_array_begin, context_p);
+            continue;
+        case TOKEN_ARRAY_END:
+            go_on = JSON_SAX_CALL(handler_p->on_array_end, context_p);
+            continue;
+        case TOKEN_KEY:
+            token.len = _JsonToken_terminate(&token);
+            go_on     = JSON_SAX_CALL(handler_p->on_key, context_p, token.start_p, token.len);
+            continue;
+        default:
+            break;
+        }
+        if (is_err(_JsonItem_set_scalar(&item, &token)))
+        {
+            return ERR_JSON_INVALID;
+        }
+        switch (item.value.value_type)
+        {
+        case VALUE_CSTR:
+            go_on = JSON_SAX_CALL(
+                handler_p->on_cstr, context_p, item.value.value_cstr, item.value.cstr_len);
+            break;
+        case VALUE_LLD:
+            go_on = JSON_SAX_CALL(handler_p->on_lld, context_p, item.value.value_lld);
+            break;
+        case VALUE_LLU:
+            go_on = JSON_SAX_CALL(handler_p->on_llu, context_p, item.value.value_llu);
+            break;
+        case VALUE_DOUBLE:
+            go_on = JSON_SAX_CALL(handler_p->on_double, context_p, item.value.value_double);
+            break;
+        case VALUE_BOOL:
+            go_on = JSON_SAX_CALL(handler_p->on_bool, context_p, item.value.value_bool);
+            break;
+        default:
+            go_on = JSON_SAX_CALL(handler_p->on_null, context_p);
+            break;
+        }
+    }
+    return ERR_INTERRUPTION;
+}
+
+// Number of bytes requested to the file descriptor by a `JsonReader` at a time.
+#define JSON_READER_CHUNK_SIZE (1 << 16)
+
+// Read from the file descriptor at the end of the buffer, which is made large enough to take
+// `JSON_READER_CHUNK_SIZE` more bytes. Consumed bytes are dropped first, hence the buffer only
+// grows when a record does not fit.
+static Error _JsonReader_fill(JsonReader* reader_p)
+{
+    if (reader_p->begin > 0)
+    {
+        memmove(
+            reader_p->buffer_p,
+            reader_p->buffer_p + reader_p->begin,
+            reader_p->end - reader_p->begin);
+        reader_p->end -= reader_p->begin;
+        reader_p->scan -= reader_p->begin;
+        reader_p->begin = 0;
+    }
+    // Keep one spare byte to terminate the last record, which may not end with a newline.
+    if (reader_p->size - reader_p->end < JSON_READER_CHUNK_SIZE + 1)
+    {
+        reader_p->size     = 2 * reader_p->size + JSON_READER_CHUNK_SIZE + 1;
+        reader_p->buffer_p
+            = my_memory_realloc(__FILENAME__, __LINE__, reader_p->buffer_p, reader_p->size);
+    }
+    ssize_t bytes_read;
+    do
+    {
+        bytes_read
+            = read(reader_p->fd, reader_p->buffer_p + reader_p->end, JSON_READER_CHUNK_SIZE);
+    } while ((bytes_read == -1) && (errno == EINTR));
+    if (bytes_read == -1)
+    {
+        LOG_PERROR("Failed to read from fd `%d`", reader_p->fd);
+        return ERR_FS_INTERNAL;
+    }
+    reader_p->end += (size_t)bytes_read;
+    reader_p->eof = (bytes_read == 0);
+    return ERR_ALL_GOOD;
+}
+
+Error _JsonReader_new(const char* file, const int line, int fd, JsonReader* out_reader_p)
+{
+    out_reader_p->fd       = fd;
+    out_reader_p->size     = JSON_READER_CHUNK_SIZE + 1;
+    out_reader_p->buffer_p = my_memory_malloc(file, line, out_reader_p->size);
+    out_reader_p->begin    = 0;
+    out_reader_p->scan     = 0;
+    out_reader_p->end      = 0;
+    out_reader_p->eof      = false;
+    _JsonObj_clear(&out_reader_p->json_obj, JSON_READER_CHUNK_SIZE);
+    return ERR_ALL_GOOD;
+}
+
+// Parse the next non-blank record. `*out_json_obj_pp` is set to NULL at the end of the stream.
+// An invalid record is reported as such and skipped, so that the caller can carry on.
+Error JsonReader_next(JsonReader* reader_p, JsonObj** out_json_obj_pp)
+{
+    *out_json_obj_pp = NULL;
+    while (true)
+    {
+        char* record_p  = reader_p->buffer_p + reader_p->begin;
+        char* newline_p = memchr(
+            reader_p->buffer_p + reader_p->scan, '\n', reader_p->end - reader_p->scan);
+        if ((newline_p == NULL) && !reader_p->eof)
+        {
+            // Do not look at the same bytes twice, however long the record is.
+            reader_p->scan = reader_p->end;
+            if (is_err(_JsonReader_fill(reader_p)))
+            {
+                return ERR_FS_INTERNAL;
+            }
+            continue;
+        }
+        if (newline_p == NULL)
+        {
+            // The last record may not be followed by a newline.
+            newline_p = reader_p->buffer_p + reader_p->end;
+            if (newline_p == record_p)
+            {
+                return ERR_ALL_GOOD;
+            }
+        }
+        *newline_p      = '\0';
+        reader_p->begin = (size_t)(newline_p - reader_p->buffer_p);
+        if (reader_p->begin < reader_p->end)
+        {
+            reader_p->begin++;
+        }
+        reader_p->scan = reader_p->begin;
+
+        const size_t record_len = (size_t)(newline_p - record_p);
+        if (_is_blank(record_p, record_len))
+        {
+            continue;
+        }
+        // Parse the record in place: the items are valid until the next call.
+        JsonObj* json_obj_p = &reader_p->json_obj;
+        if (is_err(_JsonObj_reparse(__FILENAME__, __LINE__, json_obj_p, record_p, record_len)))
+        {
+            return ERR_JSON_INVALID;
+        }
+        *out_json_obj_pp = json_obj_p;
+        return ERR_ALL_GOOD;
+    }
+}
+
+void JsonReader_destroy(JsonReader* reader_p)
+{
+    if (reader_p == NULL)
+    {
+        return;
+    }
+    // The JSON object borrows its string from the buffer.
+    reader_p->json_obj.json_cstr = NULL;
+    JsonObj_destroy(&reader_p->json_obj);
+    my_memory_free(reader_p->buffer_p);
+    reader_p->buffer_p = NULL;
+}
+
+// Size of the first buffer of a `JsonParser`, which doubles whenever the input does not fit.
+#define JSON_PARSER_MIN_SIZE (4096)
+
+struct JsonPushState
+{
+    size_t size; // Allocated bytes for `json_obj.json_cstr`.
+    JsonTokenizer tokenizer;
+    JsonBuilder builder;
+    bool started;
+    bool complete;
+    bool failed;
+};
+
+// Make the keys and strings of all the items point into `new_json_p`, a copy of the input they
+// currently point into.
+static void _JsonObj_move_input(JsonObj* json_obj_p, char* new_json_p)
+{
+    const char* old_json_p = json_obj_p->json_cstr;
+    JsonItem* root_p       = &json_obj_p->root;
+    JsonItem* item_p       = root_p->next_sibling;
+    while (item_p != NULL)
+    {
+        JsonItem* child_p = NULL;
+        if (item_p->key_p != NULL)
+        {
+            item_p->key_p = new_json_p + (item_p->key_p - old_json_p);
+        }
+        switch (item_p->value.value_type)
+        {
+        case VALUE_CSTR:
+        case VALUE_LAZY:
+            item_p->value.value_cstr = new_json_p + (item_p->value.value_cstr - old_json_p);
+            break;
+        case VALUE_ITEM:
+            child_p = item_p->value.value_child_p;
+            break;
+        case VALUE_ARRAY:
+            child_p = item_p->value.value_array_p->element;
+            break;
+        default:
+            break;
+        }
+        if (child_p != NULL)
+        {
+            item_p = child_p;
+            continue;
+        }
+        // Go back up until an item has a following sibling.
+        while ((item_p != root_p) && (item_p->next_sibling == NULL))
+        {
+            item_p = item_p->parent;
+        }
+        item_p = (item_p == root_p) ? NULL : item_p->next_sibling;
+    }
+    json_obj_p->json_cstr = new_json_p;
+}
+
+static void _JsonParser_append(JsonParser* parser_p, const char* chunk_p, size_t chunk_len)
+{
+    JsonPushState* state_p     = parser_p->state_p;
+    JsonObj* json_obj_p        = &parser_p->json_obj;
+    JsonTokenizer* tokenizer_p = &state_p->tokenizer;
+    const size_t needed_size   = json_obj_p->json_len + chunk_len + 1;
+    if (needed_size > state_p->size)
+    {
+        // Move to a larger buffer: the items built so far point into the old one.
+        char* old_json_p = json_obj_p->json_cstr;
+        while (state_p->size < needed_size)
+        {
+            state_p->size *= 2;
+        }
+        char* new_json_p = my_memory_malloc(__FILENAME__, __LINE__, state_p->size);
+        memcpy(new_json_p, old_json_p, json_obj_p->json_len);
+        _JsonObj_move_input(json_obj_p, new_json_p);
+        tokenizer_p->begin_p = new_json_p;
+        tokenizer_p->curr_p  = new_json_p + (tokenizer_p->curr_p - old_json_p);
+        if (tokenizer_p->cut_string_p != NULL)
+        {
+            tokenizer_p->cut_string_p = new_json_p + (tokenizer_p->cut_string_p - old_json_p);
+            tokenizer_p->cut_scan_p   = new_json_p + (tokenizer_p->cut_scan_p - old_json_p);
+        }
+        my_memory_free(old_json_p);
+    }
+    memcpy(json_obj_p->json_cstr + json_obj_p->json_len, chunk_p, chunk_len);
+    json_obj_p->json_len += chunk_len;
+    json_obj_p->json_cstr[json_obj_p->json_len] = '\0';
+    tokenizer_p->end_p = json_obj_p->json_cstr + json_obj_p->json_len;
+    // The current block was padded with zeros where the new bytes are.
+    _JsonTokenizer_load_block(tokenizer_p, tokenizer_p->curr_p);
+}
+
+// Open the top-level container once its first char has arrived.
+static Error _JsonParser_start(JsonParser* parser_p)
+{
+    JsonPushState* state_p     = parser_p->state_p;
+    JsonObj* json_obj_p        = &parser_p->json_obj;
+    JsonTokenizer* tokenizer_p = &state_p->tokenizer;
+    const char* first_p        = _JsonTokenizer_skip_whitespace(tokenizer_p, tokenizer_p->curr_p);
+    JsonItem* parent_p         = &json_obj_p->root;
+    JsonToken token;
+    if (first_p == tokenizer_p->end_p)
+    {
+        return ERR_ALL_GOOD;
+    }
+    if ((*first_p != '{') && (*first_p != '['))
+    {
+        LOG_ERROR("Invalid JSON string.");
+        return ERR_JSON_INVALID;
+    }
+    _JsonTokenizer_next(tokenizer_p, &token);
+    if (token.type == TOKEN_ARRAY_BEGIN)
+    {
+        // A top-level array is the only child of root, without a key.
+        parent_p = _JsonItem_append(__FILENAME__, __LINE__, &json_obj_p->arena, parent_p, NULL);
+        _JsonItem_open_container(
+            __FILENAME__, __LINE__, &json_obj_p->arena, parent_p, TOKEN_ARRAY_BEGIN);
+    }
+    state_p->builder.parent_p    = parent_p;
+    state_p->builder.curr_item_p = NULL;
+    state_p->builder.depth       = tokenizer_p->depth;
+    state_p->started             = true;
+    return ERR_ALL_GOOD;
+}
+
+Error _JsonParser_new(const char* file, const int line, JsonParser* out_parser_p)
+{
+    JsonObj* json_obj_p = &out_parser_p->json_obj;
+    _JsonObj_clear(json_obj_p, 0);
+    json_obj_p->json_cstr             = my_memory_malloc(file, line, JSON_PARSER_MIN_SIZE);
+    json_obj_p->json_cstr[0]          = '\0';
+    json_obj_p->root.value.value_type = VALUE_ROOT;
+
+    JsonPushState* state_p = my_memory_malloc(file, line, sizeof(JsonPushState));
+    state_p->size          = JSON_PARSER_MIN_SIZE;
+    state_p->started       = false;
+    state_p->complete      = false;
+    state_p->failed        = false;
+    _JsonTokenizer_init(&state_p->tokenizer, json_obj_p->json_cstr, 0);
+    state_p->tokenizer.partial = true;
+    out_parser_p->state_p      = state_p;
+    return ERR_ALL_GOOD;
+}
+
+// Add the next chunk of the document. The tokenizer goes on where the previous chunk ended, also in
+// the middle of a string: only a number, a literal or the whitespace following a key cut by the end
+// of the previous chunk are read again from their start. `*out_complete_p` is set once the document
+// is complete, and `json_obj` can be queried from then on.
+Error JsonParser_feed(
+    JsonParser* parser_p,
+    const char* chunk_p,
+    size_t chunk_len,
+    bool* out_complete_p)
+{
+    JsonPushState* state_p     = parser_p->state_p;
+    JsonTokenizer* tokenizer_p = &state_p->tokenizer;
+    *out_complete_p            = state_p->complete;
+    if (state_p->failed)
+    {
+        return ERR_JSON_INVALID;
+    }
+    if (state_p->complete)
+    {
+        if (!_is_blank(chunk_p, chunk_len))
+        {
+            LOG_ERROR("Unexpected data after the end of the JSON document");
+            state_p->failed = true;
+            return ERR_JSON_INVALID;
+        }
+        return ERR_ALL_GOOD;
+    }
+    _JsonParser_append(parser_p, chunk_p, chunk_len);
+    if (!state_p->started && is_err(_JsonParser_start(parser_p)))
+    {
+        state_p->failed = true;
+        return ERR_JSON_INVALID;
+    }
+    if (!state_p->started)
+    {
+        return ERR_ALL_GOOD;
+    }
+    if (is_err(_JsonItem_build_resume(
+            __FILENAME__,
+            __LINE__,
+            &parser_p->json_obj.arena,
+            tokenizer_p,
+            &state_p->builder,
+            JSON_BUILD_ALL)))
+    {
+        state_p->failed = true;
+        return ERR_JSON_INVALID;
+    }
+    if (tokenizer_p->depth >= state_p->builder.depth)
+    {
+        return ERR_ALL_GOOD;
+    }
+    if (!_is_blank(tokenizer_p->curr_p, (size_t)(tokenizer_p->end_p - tokenizer_p->curr_p)))
+    {
+        LOG_ERROR("Unexpected data after the end of the JSON document");
+        state_p->failed = true;
+        return ERR_JSON_INVALID;
+    }
+    state_p->complete = true;
+    *out_complete_p   = true;
+    return ERR_ALL_GOOD;
+}
+
+void JsonParser_destroy(JsonParser* parser_p)
+{
+    if (parser_p == NULL)
+    {
+        return;
+    }
+    JsonObj_destroy(&parser_p->json_obj);
+    my_memory_free(parser_p->state_p);
+    parser_p->state_p = NULL;
+}
+
+// Byte range of an element of a top-level array, or of a line of NDJSON.
+typedef struct
+{
+    size_t begin;
+    size_t end;
+} JsonSpan;
+
+typedef struct
+{
+    JsonSpan* spans_p;
+    size_t len;
+    size_t capacity;
+} JsonSpanList;
+
+// Add the span from `begin_p` to `end_p`, both pointing into the string starting at `base_p`.
+static void _JsonSpanList_push(
+    const char* file,
+    const int line,
+    JsonSpanList* list_p,
+    const char* base_p,
+    const char* begin_p,
+    const char* end_p)
+{
+    if (list_p->spans_p == NULL)
+    {
+        list_p->capacity = 64;
+        list_p->spans_p  = my_memory_malloc(file, line, list_p->capacity * sizeof(JsonSpan));
+    }
+    else if (list_p->len == list_p->capacity)
+    {
+        list_p->capacity *= 2;
+        list_p->spans_p
+            = my_memory_realloc(file, line, list_p->spans_p, list_p->capacity * sizeof(JsonSpan));
+    }
+    list_p->spans_p[list_p->len].begin = (size_t)(begin_p - base_p);
+    list_p->spans_p[list_p->len].end   = (size_t)(end_p - base_p);
+    list_p->len++;
+}
+
+// Find the elements of the top-level array the tokenizer is about to read. Only brackets, commas
+// and strings are looked at, which is enough to find the commas separating the elements: the
+// elements themselves are validated when parsed.
+static Error _json_split_array(
+    const char* file,
+    const int line,
+    JsonTokenizer* tokenizer_p,
+    JsonSpanList* out_list_p)
+{
+    const char* begin_p   = tokenizer_p->begin_p;
+    const char* curr_p    = _JsonTokenizer_skip_whitespace(tokenizer_p, tokenizer_p->curr_p) + 1;
+    const char* element_p = curr_p;
+    size_t level          = 1;
+    JsonBlockMasks masks;
+    while (level > 0)
+    {
+        if (curr_p >= tokenizer_p->end_p)
+        {
+            _JsonTokenizer_invalid(tokenizer_p, curr_p);
+            return _JsonTokenizer_error(tokenizer_p);
+        }
+        const size_t available = _JsonTokenizer_masks(tokenizer_p, curr_p, &masks);
+        const char* next_p     = curr_p + available;
+        uint64_t candidates    = masks.quote | masks.structural;
+        while (candidates != 0)
+        {
+            const char* char_p = curr_p + __builtin_ctzll(candidates);
+            candidates &= candidates - 1;
+            if (*char_p == '"')
+            {
+                bool has_escapes;
+                const char* quote_p
+                    = _JsonTokenizer_scan_string(tokenizer_p, char_p + 1, &has_escapes);
+                if ((quote_p == NULL) || (quote_p == tokenizer_p->end_p))
+                {
+                    _JsonTokenizer_invalid(tokenizer_p, char_p);
+                    return _JsonTokenizer_error(tokenizer_p);
+                }
+                next_p = quote_p + 1;
+                break;
+            }
+            if ((*char_p == '{') || (*char_p == '['))
+            {
+                level++;
+            }
+            else if ((*char_p == ',') && (level == 1))
+            {
+                _JsonSpanList_push(file, line, out_list_p, begin_p, element_p, char_p);
+                element_p = char_p + 1;
+            }
+            else if (((*char_p == '}') || (*char_p == ']')) && (--level == 0))
+            {
+                if (*char_p != ']')
+                {
+                    _JsonTokenizer_invalid(tokenizer_p, char_p);
+                    return _JsonTokenizer_error(tokenizer_p);
+                }
+                // An empty array has no elements rather than a blank one.
+                if ((out_list_p->len > 0) || !_is_blank(element_p, (size_t)(char_p - element_p)))
+                {
+                    _JsonSpanList_push(file, line, out_list_p, begin_p, element_p, char_p);
+                }
+                next_p = char_p + 1;
+                break;
+            }
+        }
+        curr_p = next_p;
+    }
+    // Only whitespace can follow the array.
+    JsonToken token;
+    tokenizer_p->curr_p = curr_p;
+    tokenizer_p->expect = EXPECT_NOTHING;
+    if (_JsonTokenizer_next(tokenizer_p, &token) != TOKEN_END)
+    {
+        return _JsonTokenizer_error(tokenizer_p);
+    }
+    return ERR_ALL_GOOD;
+}
+
+static void _json_split_lines(
+    const char* file,
+    const int line,
+    const char* json_cstr,
+    size_t json_len,
+    JsonSpanList* out_list_p)
+{
+    const char* end_p  = json_cstr + json_len;
+    const char* line_p = json_cstr;
+    while (line_p < end_p)
+    {
+        const char* newline_p = memchr(line_p, '\n', (size_t)(end_p - line_p));
+        if (newline_p == NULL)
+        {
+            newline_p = end_p;
+        }
+        _JsonSpanList_push(file, line, out_list_p, json_cstr, line_p, newline_p);
+        line_p = newline_p + 1;
+    }
+}
+
+// Share of the spans parsed by one thread.
+typedef struct
+{
+    char* json_cstr;
+    const JsonSpan* spans_p;
+    size_t first;
+    size_t last;
+    // Used to build the elements of a top-level array.
+    JsonItem* array_item_p;
+    JsonArena arena;
+    JsonItem* first_item_p;
+    JsonItem* last_item_p;
+    // Used to pass each element to a callback.
+    JsonElementFn element_fn;
+    void* context_p;
+    bool skip_blank;
+    Error result;
+} JsonWorker;
+
+// Build the elements as children of `array_item_p`. They are chained together, but they are only
+// linked to the array, and to the elements of the other workers, once all the workers are done.
+static void* _JsonWorker_build(void* worker_vp)
+{
+    JsonWorker* worker_p = worker_vp;
+    JsonItem* prev_p     = NULL;
+    for (size_t i = worker_p->first; i < worker_p->last; i++)
+    {
+        const JsonSpan* span_p = &worker_p->spans_p[i];
+        JsonTokenizer tokenizer;
+        JsonToken token;
+        _JsonTokenizer_init(
+            &tokenizer, worker_p->json_cstr + span_p->begin, span_p->end - span_p->begin);
+        // The elements are nested in the top-level array.
+        tokenizer.max_depth = JSON_MAX_DEPTH - 1;
+        JsonItem* item_p    = _JsonItem_new(__FILENAME__, __LINE__, &worker_p->arena);
+        item_p->parent   = worker_p->array_item_p;
+        item_p->index    = i;
+        if (is_err(_JsonItem_build_value(
+                __FILENAME__, __LINE__, &worker_p->arena, &tokenizer, item_p, JSON_BUILD_ALL))
+            || (_JsonTokenizer_next(&tokenizer, &token) != TOKEN_END))
+        {
+            worker_p->result = ERR_JSON_INVALID;
+            break;
+        }
+        if (prev_p != NULL)
+        {
+            prev_p->next_sibling = item_p;
+        }
+        else
+        {
+            worker_p->first_item_p = item_p;
+        }
+        prev_p = item_p;
+    }
+    worker_p->last_item_p = prev_p;
+    return NULL;
+}
+
+// Parse each element as a document of its own, reusing the same object, and pass it to the
+// callback. Invalid elements are reported at the end, but do not stop the others.
+static void* _JsonWorker_visit(void* worker_vp)
+{
+    JsonWorker* worker_p = worker_vp;
+    JsonObj json_obj;
+    _JsonObj_clear(&json_obj, 0);
+    for (size_t i = worker_p->first; i < worker_p->last; i++)
+    {
+        char* json_p          = worker_p->json_cstr + worker_p->spans_p[i].begin;
+        const size_t json_len = worker_p->spans_p[i].end - worker_p->spans_p[i].begin;
+        if (worker_p->skip_blank && _is_blank(json_p, json_len))
+        {
+            continue;
+        }
+        if (is_err(_JsonObj_reparse(__FILENAME__, __LINE__, &json_obj, json_p, json_len)))
+        {
+            worker_p->result = ERR_JSON_INVALID;
+            continue;
+        }
+        worker_p->element_fn(&json_obj, i, worker_p->context_p);
+    }
+    json_obj.json_cstr = NULL;
+    JsonObj_destroy(&json_obj);
+    return NULL;
+}
+
+// Give each worker a contiguous share of the spans, of about the same size in bytes, and run them.
+// Return the number of workers used, which is never larger than the number of spans.
+static size_t _JsonWorker_run(
+    JsonWorker* workers_p,
+    size_t num_of_workers,
+    const JsonSpanList* list_p,
+    void* (*routine)(void*))
+{
+    const JsonSpan* spans_p = list_p->spans_p;
+    if (num_of_workers > list_p->len)
+    {
+        num_of_workers = list_p->len;
+    }
+    if (num_of_workers == 0)
+    {
+        return 0;
+    }
+    const size_t total_bytes = spans_p[list_p->len - 1].end - spans_p[0].begin;
+    size_t first             = 0;
+    for (size_t k = 0; k < num_of_workers; k++)
+    {
+        const size_t target = spans_p[0].begin + total_bytes * (k + 1) / num_of_workers;
+        size_t last         = first + 1;
+        while ((last < list_p->len) && (spans_p[last - 1].end < target))
+        {
+            last++;
+        }
+        // Leave at least one span to each of the following workers.
+        if (list_p->len - last < num_of_workers - k - 1)
+        {
+            last = list_p->len - (num_of_workers - k - 1);
+        }
+        if (k == num_of_workers - 1)
+        {
+            last = list_p->len;
+        }
+        workers_p[k].first  = first;
+        workers_p[k].last   = last;
+        workers_p[k].result = ERR_ALL_GOOD;
+        first               = last;
+    }
+    pthread_t* threads_p
+        = my_memory_malloc(__FILENAME__, __LINE__, num_of_workers * sizeof(pthread_t));
+    bool* started_p = my_memory_malloc(__FILENAME__, __LINE__, num_of_workers * sizeof(bool));
+    // The calling thread takes the first share.
+    for (size_t k = 1; k < num_of_workers; k++)
+    {
+        started_p[k] = (pthread_create(&threads_p[k], NULL, routine, &workers_p[k]) == 0);
+        if (!started_p[k])
+        {
+            LOG_WARNING("Failed to start a thread: parsing in the calling one");
+            routine(&workers_p[k]);
+        }
+    }
+    routine(&workers_p[0]);
+    for (size_t k = 1; k < num_of_workers; k++)
+    {
+        if (started_p[k])
+        {
+            pthread_join(threads_p[k], NULL);
+        }
+    }
+    my_memory_free(started_p);
+    my_memory_free(threads_p);
+    return num_of_workers;
+}
+
+// Return the number of workers to allocate: as many as requested, or as there are cores if 0, but
+// never more than the spans to share, which also keeps the allocation of the workers from
+// overflowing.
+static size_t _json_num_of_threads(size_t num_of_threads, size_t num_of_spans)
+{
+    if (num_of_threads == 0)
+    {
+        const long num_of_cores = sysconf(_SC_NPROCESSORS_ONLN);
+        num_of_threads          = (num_of_cores > 0) ? (size_t)num_of_cores : 1;
+    }
+    if (num_of_threads > num_of_spans)
+    {
+        num_of_threads = num_of_spans;
+    }
+    return (num_of_threads > 0) ? num_of_threads : 1;
+}
+
+Error _JsonObj_new_parallel(
+    const char* file,
+    const int line,
+    const char* json_cstr,
+    size_t num_of_threads,
+    JsonObj* out_json_obj_p)
+{
+    const char* first_p = json_cstr;
+    while (_is_whitespace(*first_p))
+    {
+        first_p++;
+    }
+    if (*first_p != '[')
+    {
+        return _JsonObj_init(file, line, json_cstr, NULL, NULL, out_json_obj_p, JSON_BUILD_ALL);
+    }
+    _JsonObj_clear(out_json_obj_p, 0);
+    const size_t json_len     = strlen(json_cstr);
+    out_json_obj_p->json_cstr = my_memory_malloc(file, line, json_len + 1);
+    out_json_obj_p->json_len  = json_len;
+    memcpy(out_json_obj_p->json_cstr, json_cstr, json_len + 1);
+    out_json_obj_p->root.value.value_type = VALUE_ROOT;
+
+    JsonTokenizer tokenizer;
+    JsonSpanList list = {.spans_p = NULL, .len = 0, .capacity = 0};
+    _JsonTokenizer_init(&tokenizer, out_json_obj_p->json_cstr, json_len);
+    if (is_err(_json_split_array(file, line, &tokenizer, &list)))
+    {
+        my_memory_free(list.spans_p);
+        JsonObj_destroy(out_json_obj_p);
+        return ERR_JSON_INVALID;
+    }
+    JsonItem* array_item_p
+        = _JsonItem_append(file, line, &out_json_obj_p->arena, &out_json_obj_p->root, NULL);
+    _JsonItem_open_container(file, line, &out_json_obj_p->arena, array_item_p, TOKEN_ARRAY_BEGIN);
+
+    num_of_threads        = _json_num_of_threads(num_of_threads, list.len);
+    JsonWorker* workers_p = my_memory_malloc(file, line, num_of_threads * sizeof(JsonWorker));
+    for (size_t k = 0; k < num_of_threads; k++)
+    {
+        workers_p[k].json_cstr    = out_json_obj_p->json_cstr;
+        workers_p[k].spans_p      = list.spans_p;
+        workers_p[k].array_item_p = array_item_p;
+        workers_p[k].first_item_p = NULL;
+        workers_p[k].last_item_p  = NULL;
+        _JsonArena_init(&workers_p[k].arena, json_len / num_of_threads);
+    }
+    const size_t num_of_workers
+        = _JsonWorker_run(workers_p, num_of_threads, &list, _JsonWorker_build);
+
+    // Link the elements built by each worker, which hands its memory over to the object.
+    JsonArray* json_array_p = array_item_p->value.value_array_p;
+    JsonItem* prev_p        = NULL;
+    Error ret_err           = ERR_ALL_GOOD;
+    for (size_t k = 0; k < num_of_workers; k++)
+    {
+        _JsonArena_merge(&out_json_obj_p->arena, &workers_p[k].arena);
+        if (is_err(workers_p[k].result))
+        {
+            ret_err = workers_p[k].result;
+            continue;
+        }
+        if (prev_p != NULL)
+        {
+            prev_p->next_sibling = workers_p[k].first_item_p;
+        }
+        else
+        {
+            json_array_p->element = workers_p[k].first_item_p;
+        }
+        prev_p = workers_p[k].last_item_p;
+    }
+    json_array_p->len = list.len;
+    my_memory_free(workers_p);
+    my_memory_free(list.spans_p);
+    if (is_err(ret_err))
+    {
+        LOG_ERROR("Failed to deserialize JSON");
+        JsonObj_destroy(out_json_obj_p);
+        return ERR_JSON_INVALID;
+    }
+    return ERR_ALL_GOOD;
+}
+
+Error _JsonObj_for_each_parallel(
+    const char* file,
+    const int line,
+    const char* json_cstr,
+    JsonSplit split,
+    size_t num_of_threads,
+    JsonElementFn element_fn,
+    void* context_p)
+{
+    const size_t json_len = strlen(json_cstr);
+    if (json_len == 0)
+    {
+        LOG_ERROR("Empty JSON string detected");
+        return ERR_EMPTY_STRING;
+    }
+    char* json_copy_p = my_memory_malloc(file, line, json_len + 1);
+    memcpy(json_copy_p, json_cstr, json_len + 1);
+
+    JsonSpanList list = {.spans_p = NULL, .len = 0, .capacity = 0};
+    Error ret_err     = ERR_ALL_GOOD;
+    if (split == JSON_SPLIT_LINES)
+    {
+        _json_split_lines(file, line, json_copy_p, json_len, &list);
+    }
+    else
+    {
+        JsonTokenizer tokenizer;
+        _JsonTokenizer_init(&tokenizer, json_copy_p, json_len);
+        const char* first_p = _JsonTokenizer_skip_whitespace(&tokenizer, json_copy_p);
+        if ((first_p == tokenizer.end_p) || (*first_p != '['))
+        {
+            LOG_ERROR("A top-level array was expected");
+            ret_err = ERR_JSON_INVALID;
+        }
+        else
+        {
+            ret_err = _json_split_array(file, line, &tokenizer, &list);
+        }
+    }
+    if (is_ok(ret_err))
+    {
+        num_of_threads        = _json_num_of_threads(num_of_threads, list.len);
+        JsonWorker* workers_p = my_memory_malloc(file, line, num_of_threads * sizeof(JsonWorker));
+        for (size_t k = 0; k < num_of_threads; k++)
+        {
+            workers_p[k].json_cstr  = json_copy_p;
+            workers_p[k].spans_p    = list.spans_p;
+            workers_p[k].element_fn = element_fn;
+            workers_p[k].context_p  = context_p;
+            workers_p[k].skip_blank = (split == JSON_SPLIT_LINES);
+        }
+        const size_t num_of_workers
+            = _JsonWorker_run(workers_p, num_of_threads, &list, _JsonWorker_visit);
+        for (size_t k = 0; k < num_of_workers; k++)
+        {
+            if (is_err(workers_p[k].result))
+            {
+                ret_err = workers_p[k].result;
+            }
+        }
+        my_memory_free(workers_p);
+    }
+    my_memory_free(list.spans_p);
+    my_memory_free(json_copy_p);
+    return ret_err;
+}
+
+
+// FNV-1a hash of the key alone, which can be computed once for keys looked up repeatedly.
+static inline uint64_t _json_cstr_hash(const char* key)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    while (*key)
+    {
+        hash = (hash ^ (unsigned char)*key++) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+// Mix the hash of a key with the address of the parent.
+static inline uint64_t _json_key_hash_mix(const JsonItem* parent_p, uint64_t cstr_hash)
+{
+    return (cstr_hash ^ (uint64_t)(uintptr_t)parent_p) * 0x9E3779B97F4A7C15ULL;
+}
+
+static inline uint64_t _json_key_hash(const JsonItem* parent_p, const char* key)
+{
+    return _json_key_hash_mix(parent_p, _json_cstr_hash(key));
+}
+
+static void _JsonKeyIndex_insert(JsonKeyIndex* index_p, const JsonKeyIndexEntry* entry_p)
+{
+    size_t slot = entry_p->hash & (index_p->capacity - 1);
+    while (index_p->entries[slot].parent_p != NULL)
+    {
+        slot = (slot + 1) & (index_p->capacity - 1);
+    }
+    index_p->entries[slot].item_p = entry_p->item_p;
+    index_p->entries[slot].hash   = entry_p->hash;
+    __atomic_store_n(&index_p->entries[slot].parent_p, entry_p->parent_p, __ATOMIC_RELEASE);
+    index_p->size++;
+}
+
+static inline const JsonItem* _JsonKeyIndex_parent_at(const JsonKeyIndex* index_p, size_t slot)
+{
+    return __atomic_load_n(&index_p->entries[slot].parent_p, __ATOMIC_ACQUIRE);
+}
+
+// Parent of the entries of removed members, which matches no item but keeps the slots occupied, so
+// that the entries following them remain reachable.
+static const JsonItem _json_key_index_tombstone;
+
+// Make room for `num_of_new_entries` more entries, keeping the load factor below 1/2.
+static JsonKeyIndex* _JsonKeyIndex_reserve(JsonKeyIndex* index_p, size_t num_of_new_entries)
+{
+    const size_t size = (index_p ? index_p->size : 0) + num_of_new_entries;
+    if ((index_p != NULL) && (2 * size <= index_p->capacity))
+    {
+        return index_p;
+    }
+    size_t capacity = JSON_KEY_INDEX_THRESHOLD * 4;
+    while (capacity < 2 * size)
+    {
+        capacity *= 2;
+    }
+    const size_t bytes        = sizeof(JsonKeyIndex) + capacity * sizeof(JsonKeyIndexEntry);
+    JsonKeyIndex* new_index_p = my_memory_malloc(__FILENAME__, __LINE__, bytes);
+    new_index_p->capacity     = capacity;
+    new_index_p->size         = 0;
+    new_index_p->retired_p    = index_p;
+    memset(new_index_p->entries, 0, capacity * sizeof(JsonKeyIndexEntry));
+    if (index_p != NULL)
+    {
+        for (size_t i = 0; i < index_p->capacity; i++)
+        {
+            if ((index_p->entries[i].parent_p != NULL)
+                && (index_p->entries[i].parent_p != &_json_key_index_tombstone))
+            {
+                _JsonKeyIndex_insert(new_index_p, &index_p->entries[i]);
+            }
+        }
+    }
+    return new_index_p;
+}
+
+static bool _JsonKeyIndex_has_parent(const JsonKeyIndex* index_p, const JsonItem* parent_p)
+{
+    const uint64_t hash = _json_key_hash(parent_p, "");
+    size_t slot         = hash & (index_p->capacity - 1);
+    for (const JsonItem* slot_parent_p; (slot_parent_p = _JsonKeyIndex_parent_at(index_p, slot));
+         slot = (slot + 1) & (index_p->capacity - 1))
+    {
+        if ((slot_parent_p == parent_p) && (index_p->entries[slot].item_p == NULL))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Look for the entry of `key`, whose hash mixed with `parent_p` is `hash`.
+static JsonKeyIndexEntry* _JsonKeyIndex_find(
+    const JsonKeyIndex* index_p,
+    const JsonItem* parent_p,
+    const char* key,
+    uint64_t hash)
+{
+    size_t slot = hash & (index_p->capacity - 1);
+    for (const JsonItem* slot_parent_p; (slot_parent_p = _JsonKeyIndex_parent_at(index_p, slot));
+         slot = (slot + 1) & (index_p->capacity - 1))
+    {
+        const JsonKeyIndexEntry* entry_p = &index_p->entries[slot];
+        if ((entry_p->hash == hash) && (slot_parent_p == parent_p) && (entry_p->item_p != NULL)
+            && (strcmp(entry_p->item_p->key_p, key) == 0))
+        {
+            return (JsonKeyIndexEntry*)entry_p;
+        }
+    }
+    return NULL;
+}
+
+static inline const JsonItem* _JsonKeyIndex_get(
+    const JsonKeyIndex* index_p,
+    const JsonItem* parent_p,
+    const char* key,
+    uint64_t hash)
+{
+    const JsonKeyIndexEntry* entry_p = _JsonKeyIndex_find(index_p, parent_p, key, hash);
+    return entry_p ? entry_p->item_p : NULL;
+}
+
+// Index all the members of the object whose first member is `first_item_p`, unless another thread
+// did it meanwhile. The marker goes last, so that lookups finding it find all the members too.
+static void _JsonObj_index_object(JsonObj* json_obj_p, const JsonItem* first_item_p)
+{
+    const JsonItem* parent_p = first_item_p->parent;
+    pthread_mutex_lock(&json_obj_p->mutex);
+    JsonKeyIndex* index_p = json_obj_p->key_index_p;
+    if ((index_p != NULL) && _JsonKeyIndex_has_parent(index_p, parent_p))
+    {
+        pthread_mutex_unlock(&json_obj_p->mutex);
+        return;
+    }
+    size_t num_of_members = 0;
+    for (const JsonItem* item_p = first_item_p; item_p != NULL; item_p = item_p->next_sibling)
+    {
+        num_of_members++;
+    }
+    index_p = _JsonKeyIndex_reserve(index_p, num_of_members + 1);
+    for (const JsonItem* item_p = first_item_p; item_p != NULL; item_p = item_p->next_sibling)
+    {
+        const uint64_t hash = _json_key_hash(parent_p, item_p->key_p);
+        // With duplicate keys, the first one wins as it does in a linear search.
+        if (_JsonKeyIndex_get(index_p, parent_p, item_p->key_p, hash) == NULL)
+        {
+            const JsonKeyIndexEntry entry = {
+                .parent_p = parent_p,
+                .item_p   = item_p,
+                .hash     = hash,
+            };
+            _JsonKeyIndex_insert(index_p, &entry);
+        }
+    }
+    const JsonKeyIndexEntry marker = {
+        .parent_p = parent_p,
+        .item_p   = NULL,
+        .hash     = _json_key_hash(parent_p, ""),
+    };
+    _JsonKeyIndex_insert(index_p, &marker);
+    __atomic_store_n(&json_obj_p->key_index_p, index_p, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&json_obj_p->mutex);
+}
+
+// Return the object owning `item_p`, whose root is the only item being its own parent.
+static inline JsonObj* _JsonItem_get_obj(const JsonItem* item_p)
+{
+    while (item_p->parent != item_p)
+    {
+        item_p = item_p->parent;
+    }
+    return (JsonObj*)((const char*)item_p - offsetof(JsonObj, root));
+}
+
+static inline bool _JsonItem_is_first_child(const JsonItem* item_p)
+{
+    const JsonItem* parent_p = item_p->parent;
+    return (parent_p == parent_p->parent) ? (parent_p->next_sibling == item_p)
+                                          : (parent_p->value.value_child_p == item_p);
+}
+
+// Build the container left unparsed by `JsonObj_new_lazy()`. The containers nested in it are left
+// unparsed in turn, so that only the path being accessed is ever built. The content is built aside
+// and its type stored last, so that lookups running without locking never see it half built.
+static Error _JsonItem_materialize(JsonObj* json_obj_p, JsonItem* item_p)
+{
+    const char* start_p = item_p->value.value_cstr;
+    const char* end_p   = json_obj_p->json_cstr + json_obj_p->json_len;
+    JsonItem built_item = {.key_p = item_p->key_p, .parent = item_p->parent};
+    JsonTokenizer tokenizer;
+    _JsonTokenizer_init(&tokenizer, start_p, (size_t)(end_p - start_p));
+    if (is_err(_JsonItem_build_value(
+            __FILENAME__,
+            __LINE__,
+            &json_obj_p->arena,
+            &tokenizer,
+            &built_item,
+            JSON_BUILD_LAZY_SKIP)))
+    {
+        // Only numbers out of range can get here, as the structure has been validated already.
+        LOG_ERROR("Failed to materialize JSON value");
+        __atomic_store_n(&item_p->value.value_type, VALUE_INVALID, __ATOMIC_RELEASE);
+        return ERR_JSON_INVALID;
+    }
+    JsonItem* child_p = built_item.value.value_child_p;
+    if (built_item.value.value_type == VALUE_ARRAY)
+    {
+        built_item.value.value_array_p->owner_p = item_p;
+        child_p                                 = built_item.value.value_array_p->element;
+    }
+    for (; child_p != NULL; child_p = child_p->next_sibling)
+    {
+        child_p->parent = item_p;
+    }
+    item_p->value.value_child_p = built_item.value.value_child_p; // Same as `value_array_p`.
+    __atomic_store_n(&item_p->value.value_type, built_item.value.value_type, __ATOMIC_RELEASE);
+    return ERR_ALL_GOOD;
+}
+
+// Several threads may load the same item: the first one builds it, while the others wait for it.
+static inline Error _JsonItem_load(const JsonItem* item_p)
+{
+    if (__atomic_load_n(&item_p->value.value_type, __ATOMIC_ACQUIRE) != VALUE_LAZY)
+    {
+        return ERR_ALL_GOOD;
+    }
+    JsonObj* json_obj_p = _JsonItem_get_obj(item_p);
+    Error ret_err       = ERR_ALL_GOOD;
+    pthread_mutex_lock(&json_obj_p->mutex);
+    if (item_p->value.value_type == VALUE_LAZY)
+    {
+        ret_err = _JsonItem_materialize(json_obj_p, (JsonItem*)item_p);
+    }
+    else if (item_p->value.value_type == VALUE_INVALID)
+    {
+        ret_err = ERR_JSON_INVALID;
+    }
+    pthread_mutex_unlock(&json_obj_p->mutex);
+    return ret_err;
+}
+
+// Look for `key` among `item` and its following siblings. Objects searched from their first
+// member are indexed once they prove large enough, so that the following lookups cost O(1).
+// `cstr_hash_p`, if not NULL, points to the hash of the key computed in advance.
+static Error _JsonItem_find_hashed(
+    const JsonItem* item,
+    const char* key,
+    const uint64_t* cstr_hash_p,
+    const JsonItem** out_item_pp)
+{
+    *out_item_pp = NULL;
+    if (item == NULL)
+    {
+        return ERR_JSON_MISSING_ENTRY;
+    }
+    if (!item->key_p)
+    {
+        return ERR_NULL;
+    }
+    JsonObj* json_obj_p        = NULL;
+    const char* interned_key_p = NULL;
+    uint64_t cstr_hash;
+    if (_JsonItem_is_first_child(item))
+    {
+        json_obj_p = _JsonItem_get_obj(item);
+        if (json_obj_p->arena.key_table_p != NULL)
+        {
+            // All the keys of the object are in the table: one missing there is missing here too.
+            cstr_hash      = cstr_hash_p ? *cstr_hash_p : _json_cstr_hash(key);
+            cstr_hash_p    = &cstr_hash;
+            interned_key_p = _JsonKeyTable_find(json_obj_p->arena.key_table_p, key, cstr_hash);
+            if (interned_key_p == NULL)
+            {
+                return ERR_JSON_MISSING_ENTRY;
+            }
+        }
+        const JsonKeyIndex* index_p = __atomic_load_n(&json_obj_p->key_index_p, __ATOMIC_ACQUIRE);
+        if ((index_p != NULL) && _JsonKeyIndex_has_parent(index_p, item->parent))
+        {
+            const uint64_t hash = cstr_hash_p ? _json_key_hash_mix(item->parent, *cstr_hash_p)
+                                              : _json_key_hash(item->parent, key);
+            *out_item_pp = _JsonKeyIndex_get(index_p, item->parent, key, hash);
+            return *out_item_pp ? ERR_ALL_GOOD : ERR_JSON_MISSING_ENTRY;
+        }
+    }
+    size_t num_of_visited = 0;
+    for (const JsonItem* curr_item_p = item; curr_item_p != NULL;
+         curr_item_p                 = curr_item_p->next_sibling)
+    {
+        if (!curr_item_p->key_p)
+        {
+            return ERR_NULL;
+        }
+        num_of_visited++;
+        if (interned_key_p ? (curr_item_p->key_p == interned_key_p)
+                           : (strcmp(curr_item_p->key_p, key) == 0))
+        {
+            *out_item_pp = curr_item_p;
+            break;
+        }
+    }
+    if ((json_obj_p != NULL) && (num_of_visited >= JSON_KEY_INDEX_THRESHOLD))
+    {
+        _JsonObj_index_object(json_obj_p, item);
+    }
+    return *out_item_pp ? ERR_ALL_GOOD : ERR_JSON_MISSING_ENTRY;
+}
+
+static inline Error _JsonItem_find(
+    const JsonItem* item,
+    const char* key,
+    const JsonItem** out_item_pp)
+{
+    return _JsonItem_find_hashed(item, key, NULL, out_item_pp);
+}
+
+#define OBJ_GET_VALUE_c(suffix, value_token, out_type, ACTION)                      \
+    Error obj_get_##suffix(const JsonObj* obj, const char* key, out_type out_value) \
+    {                                                                               \
+        if (obj)                                                                    \
+        {                                                                           \
+            return get_##suffix(obj->root.next_sibling, key, out_value);            \
+        }                                                                           \
+        else                                                                        \
+        {                                                                           \
+            return ERR_NULL;                                                        \
+        }                                                                           \
+    }
+
+// Read the value of `item`, building it first if left unparsed by `JsonObj_new_lazy()`.
+#define READ_VALUE_c(suffix, value_token, out_type)                                   \
+    static Error _JsonItem_read_##suffix(const JsonItem* item, out_type out_value)    \
+    {                                                                                 \
+        if (is_err(_JsonItem_load(item)))                                             \
+        {                                                                             \
+            return ERR_JSON_INVALID;                                                  \
+        }                                                                             \
+        if (item->value.value_type != value_token)                                    \
+        {                                                                             \
+            LOG_ERROR("Requested " #value_token " for a different value type.");      \
+            return ERR_TYPE_MISMATCH;                                                 \
+        }                                                                             \
+        *out_value = item->value.suffix;                                              \
+        return ERR_ALL_GOOD;                                                          \
+    }
+
+// Read the value of `item`, converting it between numeric types if needed.
+#define READ_NUMBER_c(suffix, value_token, out_type)                                          \
+    static Error _JsonItem_read_##suffix(const JsonItem* item, out_type out_value)            \
+    {                                                                                         \
+        if (item->value.value_type == value_token)                                            \
+        {                                                                                     \
+            *out_value = item->value.suffix;                                                  \
+            return ERR_ALL_GOOD;                                                              \
+        }                                                                                     \
+        else if ((item->value.value_type == VALUE_LLD) && (value_token == VALUE_DOUBLE))      \
+        {                                                                                     \
+            LOG_WARNING("Converting int to double");                                          \
+            *out_value = (double)(1.0 * item->value.value_lld);                               \
+            return ERR_ALL_GOOD;                                                              \
+        }                                                                                     \
+        else if ((item->value.value_type == VALUE_LLU) && (value_token == VALUE_DOUBLE))      \
+        {                                                                                     \
+            LOG_WARNING("Converting size_t to double");                                       \
+            *out_value = (double)(1.0 * item->value.value_llu);                               \
+            return ERR_ALL_GOOD;                                                              \
+        }                                                                                     \
+        else if ((item->value.value_type == VALUE_LLD) && (value_token == VALUE_LLU))         \
+        {                                                                                     \
+            LOG_WARNING("Converting int to size_t");                                          \
+            if (item->value.value_lld < 0)                                                    \
+            {                                                                                 \
+                LOG_ERROR(                                                                    \
+                    "Impossible to convert negative int %lld into size_t",                    \
+                    item->value.value_lld);                                                   \
+                LOG_ERROR("Failed to convert from INT to LLU");                               \
+                return ERR_INVALID;                                                           \
+            };                                                                                \
+            *out_value = (llu_t)item->value.value_lld;                                        \
+            return ERR_ALL_GOOD;                                                              \
+        }                                                                                     \
+        else if ((item->value.value_type == VALUE_LLU) && (value_token == VALUE_LLD))         \
+        {                                                                                     \
+            LOG_WARNING("Converting size_t to int");                                          \
+            *out_value = (lld_t)item->value.value_llu;                                        \
+            /* check for overflow */                                                          \
+            if (*out_value < 0)                                                               \
+            {                                                                                 \
+                LOG_ERROR(                                                                    \
+                    "Overflow while converting %llu into an lld", item->value.value_llu);     \
+                return ERR_INVALID;                                                           \
+            };                                                                                \
+            return ERR_ALL_GOOD;                                                              \
+        }                                                                                     \
+        else                                                                                  \
+        {                                                                                     \
+            LOG_ERROR("Requested " #value_token " for a different value type.")               \
+            return ERR_TYPE_MISMATCH;                                                         \
+        }                                                                                     \
+    }
+
+#define GET_VALUE_c(suffix, value_token, out_type, ACTION)                            \
+    Error get_##suffix(const JsonItem* item, const char* key, out_type out_value)     \
+    {                                                                                 \
+        if (item == NULL)                                                             \
+        {                                                                             \
+            *out_value = NULL;                                                        \
+            LOG_ERROR("Input item is NULL - key `%s`.", key);                         \
+            return ERR_JSON_MISSING_ENTRY;                                            \
+        }                                                                             \
+        const JsonItem* found_item_p = NULL;                                          \
+        Error ret_err                = _JsonItem_find(item, key, &found_item_p);      \
+        if (ret_err == ERR_JSON_MISSING_ENTRY)                                        \
+        {                                                                             \
+            *out_value = NULL;                                                        \
+            LOG_ERROR("Missing entry - key `%s`.", key);                              \
+            return ERR_JSON_MISSING_ENTRY;                                            \
+        }                                                                             \
+        if (is_err(ret_err))                                                          \
+        {                                                                             \
+            return ret_err;                                                           \
+        }                                                                             \
+        ret_err = _JsonItem_read_##suffix(found_item_p, out_value);                   \
+        if (is_ok(ret_err))                                                           \
+        {                                                                             \
+            ACTION;                                                                   \
+        }                                                                             \
+        return ret_err;                                                               \
+    }
+
+#define OBJ_GET_NUMBER_c(suffix, value_token, out_type, ACTION)                     \
+    Error obj_get_##suffix(const JsonObj* obj, const char* key, out_type out_value) \
+    {                                                                               \
+        return get_##suffix(obj->root.next_sibling, key, out_value);                \
+    }
+
+#define GET_NUMBER_c(suffix, value_token, out_type, ACTION)                                   \
+    Error get_##suffix(const JsonItem* item, const char* key, out_type out_value)             \
+    {                                                                                         \
+        if (item == NULL)                                                                     \
+        {                                                                                     \
+            LOG_ERROR("Input item is NULL - key: `%s`.", key);                                \
+            return ERR_NULL;                                                                  \
+        }                                                                                     \
+        const JsonItem* found_item_p = NULL;                                                  \
+        Error ret_err                = _JsonItem_find(item, key, &found_item_p);              \
+        if (ret_err == ERR_JSON_MISSING_ENTRY)                                                \
+        {                                                                                     \
+            LOG_ERROR("Missing entry - key: `%s`.", key);                                     \
+            return ERR_NULL;                                                                  \
+        }                                                                                     \
+        if (is_err(ret_err))                                                                  \
+        {                                                                                     \
+            return ret_err;                                                                   \
+        }                                                                                     \
+        ret_err = _JsonItem_read_##suffix(found_item_p, out_value);                           \
+        if (is_ok(ret_err))                                                                   \
+        {                                                                                     \
+            ACTION;                                                                           \
+        }                                                                                     \
+        return ret_err;                                                                       \
+    }
+
+Error JsonObj_get_array(const JsonObj* json_obj_p, JsonArray** out_json_array_pp)
+{
+    const JsonItem* item_p = json_obj_p->root.next_sibling;
+    if ((item_p == NULL) || (item_p->key_p != NULL) || (item_p->value.value_type != VALUE_ARRAY))
+    {
+        LOG_ERROR("The JSON object is not a top-level array");
+        return ERR_TYPE_MISMATCH;
+    }
+    *out_json_array_pp = item_p->value.value_array_p;
+    return ERR_ALL_GOOD;
+}
+
+size_t JsonArray_len(const JsonArray* json_array_p)
+{
+    return json_array_p ? json_array_p->len : 0;
+}
+
+// Return the element at `index`, or NULL if out of boundaries. Long arrays get an offset table the
+// first time they are accessed by index, so that the following accesses cost O(1). The table is
+// built under the mutex of the object and published once complete, as for the key index.
+static JsonItem* _JsonArray_at(const JsonArray* json_array_p, size_t index)
+{
+    if (index >= json_array_p->len)
+    {
+        return NULL;
+    }
+    JsonItem** elements_pp = __atomic_load_n(&json_array_p->elements_pp, __ATOMIC_ACQUIRE);
+    if (elements_pp != NULL)
+    {
+        return elements_pp[index];
+    }
+    JsonItem* json_item = json_array_p->element;
+    if (json_array_p->len >= JSON_ARRAY_TABLE_THRESHOLD)
+    {
+        JsonArray* mutable_array_p = (JsonArray*)json_array_p;
+        JsonObj* json_obj_p        = _JsonItem_get_obj(json_item);
+        pthread_mutex_lock(&json_obj_p->mutex);
+        elements_pp = json_array_p->elements_pp;
+        if (elements_pp == NULL)
+        {
+            const size_t table_size = json_array_p->len * sizeof(JsonItem*);
+            elements_pp = _JsonArena_alloc(__FILENAME__, __LINE__, &json_obj_p->arena, table_size);
+            for (size_t i = 0; i < json_array_p->len; i++)
+            {
+                elements_pp[i] = json_item;
+                json_item      = json_item->next_sibling;
+            }
+            mutable_array_p->elements_capacity = json_array_p->len;
+            __atomic_store_n(&mutable_array_p->elements_pp, elements_pp, __ATOMIC_RELEASE);
+        }
+        pthread_mutex_unlock(&json_obj_p->mutex);
+        return elements_pp[index];
+    }
+    while (index--)
+    {
+        json_item = json_item->next_sibling;
+    }
+    return json_item;
+}
+
+JsonArrayCursor JsonArray_cursor(const JsonArray* json_array_p)
+{
+    JsonArrayCursor cursor = {.element_p = json_array_p ? json_array_p->element : NULL};
+    return cursor;
+}
+
+bool JsonArrayCursor_next(JsonArrayCursor* cursor_p, const JsonValue** out_value_pp)
+{
+    if (cursor_p->element_p == NULL)
+    {
+        *out_value_pp = NULL;
+        return false;
+    }
+    // A failure leaves the element as VALUE_INVALID, which tells the caller.
+    _JsonItem_load(cursor_p->element_p);
+    *out_value_pp       = &cursor_p->element_p->value;
+    cursor_p->element_p = cursor_p->element_p->next_sibling;
+    return true;
+}
+
+#define GET_ARRAY_VALUE_c(suffix, value_token, out_type)                                    \
+    Error get_array_##suffix(const JsonArray* json_array, size_t index, out_type out_value) \
+    {                                                                                       \
+        if (json_array == NULL)                                                             \
+        {                                                                                   \
+            LOG_ERROR("Input item is NULL");                                                \
+            return ERR_JSON_MISSING_ENTRY;                                                  \
+        }                                                                                   \
+        const JsonItem* json_item = _JsonArray_at(json_array, index);                       \
+        if (json_item == NULL)                                                              \
+        {                                                                                   \
+            LOG_WARNING("Index %lu out of boundaries.", index);                             \
+            return ERR_NULL;                                                                \
+        }                                                                                   \
+        if (is_err(_JsonItem_load(json_item)))                                              \
+        {                                                                                   \
+            return ERR_JSON_INVALID;                                                        \
+        }                                                                                   \
+        if (json_item->value.value_type != value_token)                                     \
+        {                                                                                   \
+            LOG_ERROR(                                                                      \
+                "Incompatible data type - found %d, requested %d",                          \
+                json_item->value.value_type,                                                \
+                value_token);                                                               \
+            return ERR_TYPE_MISMATCH;                                                       \
+        }                                                                                   \
+        *out_value = json_item->value.suffix;                                               \
+        return ERR_ALL_GOOD;                                                                \
+    }
+
+// clang-format off
+READ_VALUE_c(value_cstr, VALUE_CSTR, const char**)
+READ_VALUE_c(value_child_p, VALUE_ITEM, JsonItem**)
+READ_VALUE_c(value_array_p, VALUE_ARRAY, JsonArray**)
+
+READ_NUMBER_c(value_lld, VALUE_LLD, lld_t*)
+READ_NUMBER_c(value_llu, VALUE_LLU, llu_t*)
+READ_NUMBER_c(value_double, VALUE_DOUBLE, double*)
+READ_NUMBER_c(value_bool, VALUE_BOOL, bool*)
+
+OBJ_GET_VALUE_c(value_cstr, VALUE_CSTR, const char**, )
+OBJ_GET_VALUE_c(value_child_p, VALUE_ITEM, JsonItem**, )
+OBJ_GET_VALUE_c(value_array_p, VALUE_ARRAY, JsonArray**, )
+
+OBJ_GET_NUMBER_c(value_lld, VALUE_LLD, lld_t*, )
+OBJ_GET_NUMBER_c(value_llu, VALUE_LLU, llu_t*, )
+OBJ_GET_NUMBER_c(value_double, VALUE_DOUBLE, double*, )
+OBJ_GET_NUMBER_c(value_bool, VALUE_BOOL, bool*, )
+
+GET_VALUE_c(value_cstr, VALUE_CSTR, const char**, )
+GET_VALUE_c(value_child_p, VALUE_ITEM, JsonItem**, )
+GET_VALUE_c(value_array_p, VALUE_ARRAY, JsonArray**, )
+
+GET_NUMBER_c(value_lld, VALUE_LLD, lld_t*, )
+GET_NUMBER_c(value_llu, VALUE_LLU, llu_t *, )
+GET_NUMBER_c(value_double, VALUE_DOUBLE, double*, )
+GET_NUMBER_c(value_bool, VALUE_BOOL, bool*, )
+
+GET_ARRAY_VALUE_c(value_cstr, VALUE_CSTR, const char**)
+GET_ARRAY_VALUE_c(value_lld, VALUE_LLD, lld_t*)
+GET_ARRAY_VALUE_c(value_llu, VALUE_LLU, llu_t*)
+GET_ARRAY_VALUE_c(value_double, VALUE_DOUBLE, double*)
+GET_ARRAY_VALUE_c(value_bool, VALUE_BOOL, bool*)
+GET_ARRAY_VALUE_c(value_child_p, VALUE_ITEM, JsonItem**)
+GET_ARRAY_VALUE_c(value_array_p, VALUE_ARRAY, JsonArray**)
+
+// Slots of the table of keys looked up by `get_many()`, filled at most by half.
+#define JSON_GET_MANY_SLOTS (2 * JSON_MAX_BINDINGS)
+
+// Store the value of `item_p` into `out_p` as `value_type`, as `Json_get()` does.
+static bool _JsonItem_store(const JsonItem* item_p, ValueType value_type, void* out_p)
+{
+    if (is_err(_JsonItem_load(item_p)))
+    {
+        return false;
+    }
+    if (value_type != item_p->value.value_type)
+    {
+        return _JsonValue_store(&item_p->value, value_type, out_p);
+    }
+    if (value_type == VALUE_ITEM)
+    {
+        *(JsonItem**)out_p = item_p->value.value_child_p;
+        return true;
+    }
+    if (value_type == VALUE_ARRAY)
+    {
+        *(JsonArray**)out_p = item_p->value.value_array_p;
+        return true;
+    }
+    return _JsonValue_store(&item_p->value, value_type, out_p);
+}
+
+// Walk the siblings once, looking each key up in a small table of the keys requested, which are
+// hashed in advance. The walk ends as soon as all of them are found. As with a single lookup, the
+// first of duplicate members wins.
+Error get_many(
+    const JsonItem* item,
+    const char* const keys[],
+    const ValueType types[],
+    void* const outs[],
+    size_t num_of_keys)
+{
+    if (num_of_keys > JSON_MAX_BINDINGS)
+    {
+        LOG_ERROR("Invalid input: at most %d keys are supported.", JSON_MAX_BINDINGS);
+        return ERR_INVALID;
+    }
+    const size_t mask = JSON_GET_MANY_SLOTS - 1;
+    uint8_t slots[JSON_GET_MANY_SLOTS] = {0}; // Index of the key plus 1, or 0 if empty.
+    uint64_t hashes[JSON_MAX_BINDINGS];
+    for (size_t i = 0; i < num_of_keys; i++)
+    {
+        hashes[i]   = _json_cstr_hash(keys[i]);
+        size_t slot = hashes[i] & mask;
+        for (; slots[slot] != 0; slot = (slot + 1) & mask)
+        {
+            const size_t other = slots[slot] - 1U;
+            if ((hashes[other] == hashes[i]) && (strcmp(keys[other], keys[i]) == 0))
+            {
+                LOG_ERROR("Invalid input: key `%s` requested twice.", keys[i]);
+                return ERR_INVALID;
+            }
+        }
+        slots[slot] = (uint8_t)(i + 1);
+    }
+    uint64_t missing_mask = (num_of_keys == JSON_MAX_BINDINGS)
+                              ? UINT64_MAX
+                              : (((uint64_t)1 << num_of_keys) - 1);
+    bool has_mismatch     = false;
+    for (const JsonItem* curr_item_p = item; (curr_item_p != NULL) && (missing_mask != 0);
+         curr_item_p                 = curr_item_p->next_sibling)
+    {
+        if (!curr_item_p->key_p)
+        {
+            return ERR_NULL;
+        }
+        const uint64_t hash = _json_cstr_hash(curr_item_p->key_p);
+        for (size_t slot = hash & mask; slots[slot] != 0; slot = (slot + 1) & mask)
+        {
+            const size_t i = slots[slot] - 1U;
+            if ((hashes[i] != hash) || (strcmp(keys[i], curr_item_p->key_p) != 0))
+            {
+                continue;
+            }
+            if (missing_mask & ((uint64_t)1 << i))
+            {
+                missing_mask &= ~((uint64_t)1 << i);
+                has_mismatch |= !_JsonItem_store(curr_item_p, types[i], outs[i]);
+            }
+            break;
+        }
+    }
+    if (missing_mask != 0)
+    {
+        return ERR_JSON_MISSING_ENTRY;
+    }
+    return has_mismatch ? ERR_TYPE_MISMATCH : ERR_ALL_GOOD;
+}
+
+Error obj_get_many(
+    const JsonObj* obj,
+    const char* const keys[],
+    const ValueType types[],
+    void* const outs[],
+    size_t num_of_keys)
+{
+    if (obj == NULL)
+    {
+        return ERR_NULL;
+    }
+    return get_many(obj->root.next_sibling, keys, types, outs, num_of_keys);
+}
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wextra-semi"
+; // ensure clang-format works when turned on again
+#pragma clang diagnostic pop
+                                                                                  // clang-format on
+
+// Key or index of a `JsonPath`. Which one applies depends on the container met while evaluating.
+struct JsonPathSegment
+{
+    const char* key;
+    uint64_t cstr_hash; // See `_json_cstr_hash()`.
+    size_t index;       // SIZE_MAX if the segment is not an index.
+};
+
+// Return the segment as an index, or SIZE_MAX. Leading zeros are not allowed, as in RFC 6901.
+static size_t _json_path_index(const char* key)
+{
+    size_t index = 0;
+    if ((key[0] == '\0') || ((key[0] == '0') && (key[1] != '\0')))
+    {
+        return SIZE_MAX;
+    }
+    for (; *key != '\0'; key++)
+    {
+        if (!_is_digit(*key) || (index > (SIZE_MAX - 9) / 10))
+        {
+            return SIZE_MAX;
+        }
+        index = index * 10 + (size_t)(*key - '0');
+    }
+    return index;
+}
+
+// Compile a path made of segments starting with '/', where "~1" stands for '/' and "~0" for '~'.
+// The segments and the keys they hold share one allocation.
+Error _JsonPath_new(const char* file, const int line, const char* path_cstr, JsonPath* out_path_p)
+{
+    out_path_p->segments_p = NULL;
+    out_path_p->len        = 0;
+    if ((path_cstr == NULL) || (path_cstr[0] != '/'))
+    {
+        LOG_ERROR("A JSON path must start with `/`.");
+        return ERR_INVALID;
+    }
+    size_t num_of_segments = 0;
+    for (const char* char_p = path_cstr; *char_p != '\0'; char_p++)
+    {
+        num_of_segments += (*char_p == '/');
+    }
+    const size_t keys_offset = num_of_segments * sizeof(JsonPathSegment);
+    JsonPathSegment* segments_p
+        = my_memory_malloc(file, line, keys_offset + strlen(path_cstr) + 1);
+    char* key_p = (char*)segments_p + keys_offset;
+    for (size_t i = 0; i < num_of_segments; i++)
+    {
+        segments_p[i].key = key_p;
+        // Skip the '/' starting the segment.
+        for (path_cstr++; (*path_cstr != '/') && (*path_cstr != '\0'); path_cstr++)
+        {
+            if (*path_cstr != '~')
+            {
+                *key_p++ = *path_cstr;
+            }
+            else if ((path_cstr[1] == '0') || (path_cstr[1] == '1'))
+            {
+                *key_p++ = (*++path_cstr == '0') ? '~' : '/';
+            }
+            else
+            {
+                LOG_ERROR("Invalid escape sequence in JSON path.");
+                my_memory_free(segments_p);
+                return ERR_INVALID;
+            }
+        }
+        *key_p++                = '\0';
+        segments_p[i].cstr_hash = _json_cstr_hash(segments_p[i].key);
+        segments_p[i].index     = _json_path_index(segments_p[i].key);
+    }
+    out_path_p->segments_p = segments_p;
+    out_path_p->len        = num_of_segments;
+    return ERR_ALL_GOOD;
+}
+
+void JsonPath_destroy(JsonPath* path_p)
+{
+    if (path_p == NULL)
+    {
+        return;
+    }
+    my_memory_free(path_p->segments_p);
+    path_p->segments_p = NULL;
+    path_p->len        = 0;
+}
+
+// Follow the path from the top-level object or array, one lookup per segment. Keys are never
+// hashed again, and large objects are looked up through the key index.
+static Error _JsonPath_find(
+    const JsonObj* json_obj_p,
+    const JsonPath* path_p,
+    const JsonItem** out_item_pp)
+{
+    const JsonItem* item_p = &json_obj_p->root;
+    if (item_p->value.value_type != VALUE_ROOT)
+    {
+        LOG_ERROR("Uninitialized JSON object");
+        return ERR_NULL;
+    }
+    if ((item_p->next_sibling != NULL) && (item_p->next_sibling->key_p == NULL))
+    {
+        // Top-level array.
+        item_p = item_p->next_sibling;
+    }
+    for (size_t i = 0; i < path_p->len; i++)
+    {
+        const JsonPathSegment* segment_p = &path_p->segments_p[i];
+        const JsonItem* first_item_p     = NULL;
+        if (is_err(_JsonItem_load(item_p)))
+        {
+            return ERR_JSON_INVALID;
+        }
+        switch (item_p->value.value_type)
+        {
+        case VALUE_ARRAY:
+            item_p = (segment_p->index == SIZE_MAX)
+                       ? NULL
+                       : _JsonArray_at(item_p->value.value_array_p, segment_p->index);
+            break;
+        case VALUE_ROOT:
+        case VALUE_ITEM:
+            first_item_p = (item_p->value.value_type == VALUE_ROOT) ? item_p->next_sibling
+                                                                   : item_p->value.value_child_p;
+            item_p       = NULL;
+            if (first_item_p != NULL)
+            {
+                _JsonItem_find_hashed(first_item_p, segment_p->key, &segment_p->cstr_hash, &item_p);
+            }
+            break;
+        default:
+            item_p = NULL;
+            break;
+        }
+        if (item_p == NULL)
+        {
+            LOG_ERROR("Missing entry - path segment `%s`.", segment_p->key);
+            return ERR_JSON_MISSING_ENTRY;
+        }
+    }
+    *out_item_pp = item_p;
+    return ERR_ALL_GOOD;
+}
+
+#define PATH_GET_VALUE_c(suffix, out_type)                                                  \
+    Error path_get_##suffix(const JsonObj* obj, const JsonPath* path_p, out_type out_value) \
+    {                                                                                       \
+        const JsonItem* item_p = NULL;                                                      \
+        if ((obj == NULL) || (path_p == NULL))                                              \
+        {                                                                                   \
+            return ERR_NULL;                                                                \
+        }                                                                                   \
+        return_on_err(_JsonPath_find(obj, path_p, &item_p));                                \
+        return _JsonItem_read_##suffix(item_p, out_value);                                  \
+    }
+
+// clang-format off
+PATH_GET_VALUE_c(value_cstr, const char**)
+PATH_GET_VALUE_c(value_child_p, JsonItem**)
+PATH_GET_VALUE_c(value_array_p, JsonArray**)
+PATH_GET_VALUE_c(value_lld, lld_t*)
+PATH_GET_VALUE_c(value_llu, llu_t*)
+PATH_GET_VALUE_c(value_double, double*)
+PATH_GET_VALUE_c(value_bool, bool*)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wextra-semi"
+; // ensure clang-format works when turned on again
+#pragma clang diagnostic pop
+// clang-format on
+
+#define JSON_TAPE_NO_KEY UINT32_MAX
+// Enclosing container of the top-level value, while the tape is being built.
+#define JSON_TAPE_NO_CONTAINER UINT32_MAX
+
+// Value of a `JsonTape`, in 16 bytes. Keys and strings are offsets into the input, which is
+// null-terminated in place. A container is followed by the entries of its children, hence the next
+// sibling of an entry is `skip` entries after it.
+struct JsonTapeEntry
+{
+    uint32_t key_offset; // JSON_TAPE_NO_KEY for array elements and the top-level value.
+    uint32_t value_type; // One of `ValueType`, with VALUE_ITEM for objects.
+    union
+    {
+        lld_t value_lld;
+        llu_t value_llu;
+        double value_double;
+        bool value_bool;
+        uint64_t cstr_offset;
+        struct
+        {
+            uint32_t skip; // Entries of the container, itself included.
+            uint32_t len;  // Children of the container.
+        } container;
+    };
+};
+
+// Return the index of a new entry at the end of the tape, which doubles when full.
+static size_t _JsonTape_push(JsonTape* tape_p, size_t* capacity_p)
+{
+    if (tape_p->len == *capacity_p)
+    {
+        *capacity_p *= 2;
+        tape_p->entries_p = my_memory_realloc(
+            __FILENAME__, __LINE__, tape_p->entries_p, *capacity_p * sizeof(JsonTapeEntry));
+    }
+    return tape_p->len++;
+}
+
+#define JSON_SNAPSHOT_MAGIC "MYLIBCJT"
+#define JSON_SNAPSHOT_VERSION (1)
+
+// Beginning of a snapshot file. Its size keeps the entries which follow it aligned.
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_size;
+    uint64_t num_of_entries;
+    uint64_t json_len;
+} JsonSnapshotHeader;
+
+// Tokenize the input into entries. While a container is open, its skip holds the index of the
+// container enclosing it, hence the open containers form a stack inside the tape itself.
+static Error _JsonTape_build(JsonTape* tape_p, JsonTokenizer* tokenizer_p, size_t capacity)
+{
+    uint32_t open_index = JSON_TAPE_NO_CONTAINER;
+    uint32_t key_offset = JSON_TAPE_NO_KEY;
+    JsonToken token;
+    do
+    {
+        const JsonTokenType token_type = _JsonTokenizer_next(tokenizer_p, &token);
+        switch (token_type)
+        {
+        case TOKEN_KEY:
+            _JsonToken_terminate(&token);
+            key_offset = (uint32_t)(token.start_p - tape_p->json_cstr);
+            continue;
+        case TOKEN_OBJECT_END:
+        case TOKEN_ARRAY_END:
+        {
+            JsonTapeEntry* container_p  = &tape_p->entries_p[open_index];
+            const uint32_t outer_index  = container_p->container.skip;
+            container_p->container.skip = (uint32_t)(tape_p->len - open_index);
+            open_index                  = outer_index;
+            continue;
+        }
+        case TOKEN_END:
+        case TOKEN_INVALID:
+        case TOKEN_INCOMPLETE:
+            return _JsonTokenizer_error(tokenizer_p);
+        default:
+            break;
+        }
+        const size_t index     = _JsonTape_push(tape_p, &capacity);
+        JsonTapeEntry* entry_p = &tape_p->entries_p[index];
+        entry_p->key_offset    = key_offset;
+        key_offset             = JSON_TAPE_NO_KEY;
+        if (open_index != JSON_TAPE_NO_CONTAINER)
+        {
+            tape_p->entries_p[open_index].container.len++;
+        }
+        if ((token_type == TOKEN_OBJECT_BEGIN) || (token_type == TOKEN_ARRAY_BEGIN))
+        {
+            entry_p->value_type = (token_type == TOKEN_OBJECT_BEGIN) ? VALUE_ITEM : VALUE_ARRAY;
+            entry_p->container.skip = open_index;
+            entry_p->container.len  = 0;
+            open_index              = (uint32_t)index;
+            continue;
+        }
+        JsonItem item = {0};
+        if (is_err(_JsonItem_set_scalar(&item, &token)))
+        {
+            return ERR_JSON_INVALID;
+        }
+        entry_p->value_type = item.value.value_type;
+        if (item.value.value_type == VALUE_CSTR)
+        {
+            entry_p->cstr_offset = (uint64_t)(item.value.value_cstr - tape_p->json_cstr);
+        }
+        else
+        {
+            entry_p->value_llu = item.value.value_llu;
+        }
+    } while (tokenizer_p->depth > 0);
+    if (_JsonTokenizer_next(tokenizer_p, &token) != TOKEN_END)
+    {
+        return _JsonTokenizer_error(tokenizer_p);
+    }
+    return ERR_ALL_GOOD;
+}
+
+// Parse the input into a tape: about a quarter of the memory of a `JsonObj`, in one allocation
+// besides the copy of the input.
+Error _JsonTape_new(const char* file, const int line, const char* json_cstr, JsonTape* out_tape_p)
+{
+    out_tape_p->json_cstr   = NULL;
+    out_tape_p->json_len    = 0;
+    out_tape_p->entries_p   = NULL;
+    out_tape_p->len         = 0;
+    out_tape_p->mapped_size = 0;
+    const size_t json_len = strlen(json_cstr);
+    if (json_len == 0)
+    {
+        LOG_ERROR("Empty JSON string detected");
+        return ERR_EMPTY_STRING;
+    }
+    if (json_len >= JSON_TAPE_NO_KEY)
+    {
+        LOG_ERROR("JSON string too long for a tape");
+        return ERR_INVALID;
+    }
+    const char* first_p = json_cstr + strspn(json_cstr, " \t\r\n");
+    if ((*first_p != '{') && (*first_p != '['))
+    {
+        LOG_ERROR("Invalid JSON string.");
+        return ERR_JSON_INVALID;
+    }
+    // Minified input takes about 8 bytes per value.
+    size_t capacity       = json_len / 8 + 16;
+    out_tape_p->json_cstr = my_memory_malloc(file, line, json_len + 1);
+    out_tape_p->json_len  = json_len;
+    out_tape_p->entries_p = my_memory_malloc(file, line, capacity * sizeof(JsonTapeEntry));
+    memcpy(out_tape_p->json_cstr, json_cstr, json_len + 1);
+    JsonTokenizer tokenizer;
+    _JsonTokenizer_init(&tokenizer, out_tape_p->json_cstr, json_len);
+    if (is_err(_JsonTape_build(out_tape_p, &tokenizer, capacity)))
+    {
+        LOG_ERROR("Failed to deserialize JSON");
+        JsonTape_destroy(out_tape_p);
+        return ERR_JSON_INVALID;
+    }
+    // Give back the unused entries.
+    out_tape_p->entries_p = my_memory_realloc(
+        file, line, out_tape_p->entries_p, out_tape_p->len * sizeof(JsonTapeEntry));
+    return ERR_ALL_GOOD;
+}
+
+void JsonTape_destroy(JsonTape* tape_p)
+{
+    if (tape_p == NULL)
+    {
+        return;
+    }
+    if (tape_p->mapped_size > 0)
+    {
+        munmap((char*)tape_p->entries_p - sizeof(JsonSnapshotHeader), tape_p->mapped_size);
+    }
+    else
+    {
+        my_memory_free(tape_p->entries_p);
+        my_memory_free(tape_p->json_cstr);
+    }
+    tape_p->entries_p   = NULL;
+    tape_p->json_cstr   = NULL;
+    tape_p->json_len    = 0;
+    tape_p->len         = 0;
+    tape_p->mapped_size = 0;
+}
+
+// Write the header, the entries and the input, null-terminated, in this order.
+Error JsonTape_save_snapshot(const JsonTape* tape_p, const char* path)
+{
+    if ((tape_p == NULL) || (tape_p->entries_p == NULL))
+    {
+        LOG_ERROR("Uninitialized JSON tape");
+        return ERR_NULL;
+    }
+    JsonSnapshotHeader header = {
+        .version        = JSON_SNAPSHOT_VERSION,
+        .entry_size     = sizeof(JsonTapeEntry),
+        .num_of_entries = tape_p->len,
+        .json_len       = tape_p->json_len,
+    };
+    memcpy(header.magic, JSON_SNAPSHOT_MAGIC, sizeof(header.magic));
+    FILE* snapshot_file = fopen(path, "wb");
+    if (snapshot_file == NULL)
+    {
+        LOG_PERROR("Failed to open `%s`.", path);
+        return ERR_FS_INTERNAL;
+    }
+    bool is_written = (fwrite(&header, sizeof(header), 1, snapshot_file) == 1)
+                   && (fwrite(tape_p->entries_p, sizeof(JsonTapeEntry), tape_p->len, snapshot_file)
+                       == tape_p->len)
+                   && (fwrite(tape_p->json_cstr, 1, tape_p->json_len + 1, snapshot_file)
+                       == tape_p->json_len + 1);
+    is_written = (fclose(snapshot_file) == 0) && is_written;
+    if (!is_written)
+    {
+        LOG_PERROR("Failed to write `%s`.", path);
+        return ERR_FS_INTERNAL;
+    }
+    return ERR_ALL_GOOD;
+}
+
+Error _JsonObj_save_snapshot(
+    const char* file,
+    const int line,
+    const JsonObj* json_obj_p,
+    const char* path)
+{
+    String json_string;
+    return_on_err(_JsonObj_to_string(file, line, json_obj_p, &json_string));
+    JsonTape json_tape;
+    Error ret_err = _JsonTape_new(file, line, json_string.str, &json_tape);
+    String_destroy(&json_string);
+    if (is_ok(ret_err))
+    {
+        ret_err = JsonTape_save_snapshot(&json_tape, path);
+        JsonTape_destroy(&json_tape);
+    }
+    return ret_err;
+}
+
+// Check that the header describes a file of `file_size` bytes, written by this build.
+static bool _JsonSnapshotHeader_is_valid(const JsonSnapshotHeader* header_p, size_t file_size)
+{
+    // Written on a machine with a different byte order, the version would not match either.
+    if ((memcmp(header_p->magic, JSON_SNAPSHOT_MAGIC, sizeof(header_p->magic)) != 0)
+        || (header_p->version != JSON_SNAPSHOT_VERSION)
+        || (header_p->entry_size != sizeof(JsonTapeEntry)))
+    {
+        return false;
+    }
+    // Offsets are 32 bits long, as when the tape was built. This also keeps `json_len + 1` from
+    // wrapping around.
+    const size_t body_size = file_size - sizeof(JsonSnapshotHeader);
+    if ((header_p->num_of_entries == 0) || (header_p->json_len >= JSON_TAPE_NO_KEY)
+        || (header_p->num_of_entries > body_size / sizeof(JsonTapeEntry)))
+    {
+        return false;
+    }
+    const size_t json_size = body_size - header_p->num_of_entries * sizeof(JsonTapeEntry);
+    return (json_size == header_p->json_len + 1)
+        && (((const char*)header_p)[file_size - 1] == '\0');
+}
+
+// Check that every entry of the tape stays within it and within the input: offsets point into the
+// input, and the children of each container, stepped over by `skip`, fill it exactly. Each entry
+// is visited once as itself and once as a child, hence lookups never need to check bounds.
+static bool _JsonTape_is_valid(const JsonTape* tape_p)
+{
+    const JsonTapeEntry* entries_p = tape_p->entries_p;
+    if (((entries_p[0].value_type != VALUE_ITEM) && (entries_p[0].value_type != VALUE_ARRAY))
+        || (entries_p[0].container.skip != tape_p->len))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < tape_p->len; i++)
+    {
+        const JsonTapeEntry* entry_p = &entries_p[i];
+        if ((entry_p->key_offset != JSON_TAPE_NO_KEY) && (entry_p->key_offset > tape_p->json_len))
+        {
+            return false;
+        }
+        switch (entry_p->value_type)
+        {
+        case VALUE_LLD:
+        case VALUE_BOOL:
+        case VALUE_LLU:
+        case VALUE_DOUBLE:
+        case VALUE_NULL:
+            continue;
+        case VALUE_CSTR:
+            if (entry_p->cstr_offset > tape_p->json_len)
+            {
+                return false;
+            }
+            continue;
+        case VALUE_ITEM:
+        case VALUE_ARRAY:
+            break;
+        default:
+            return false;
+        }
+        const size_t end = i + entry_p->container.skip;
+        if ((entry_p->container.skip == 0) || (end > tape_p->len))
+        {
+            return false;
+        }
+        size_t child = i + 1;
+        for (uint32_t n = 0; n < entry_p->container.len; n++)
+        {
+            if (child >= end)
+            {
+                return false;
+            }
+            const uint32_t value_type = entries_p[child].value_type;
+            child += ((value_type == VALUE_ITEM) || (value_type == VALUE_ARRAY))
+                       ? entries_p[child].container.skip
+                       : 1;
+        }
+        if (child != end)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Map the snapshot read-only. The entries are checked once, while the input is read on demand.
+Error JsonTape_map_snapshot(const char* path, JsonTape* out_tape_p)
+{
+    memset(out_tape_p, 0, sizeof(JsonTape));
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+    {
+        LOG_PERROR("Failed to open `%s`.", path);
+        return ERR_FS_INTERNAL;
+    }
+    struct stat st = {0};
+    if ((fstat(fd, &st) == -1) || ((size_t)st.st_size < sizeof(JsonSnapshotHeader)))
+    {
+        LOG_ERROR("Invalid snapshot `%s`.", path);
+        close(fd);
+        return ERR_INVALID;
+    }
+    const size_t mapped_size = (size_t)st.st_size;
+    char* mapping_p          = mmap(NULL, mapped_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping_p == MAP_FAILED)
+    {
+        LOG_PERROR("Failed to map `%s`.", path);
+        return ERR_FS_INTERNAL;
+    }
+    const JsonSnapshotHeader* header_p = (const JsonSnapshotHeader*)mapping_p;
+    if (!_JsonSnapshotHeader_is_valid(header_p, mapped_size))
+    {
+        LOG_ERROR("Invalid snapshot `%s`.", path);
+        munmap(mapping_p, mapped_size);
+        return ERR_INVALID;
+    }
+    out_tape_p->entries_p   = (JsonTapeEntry*)(mapping_p + sizeof(JsonSnapshotHeader));
+    out_tape_p->len         = header_p->num_of_entries;
+    out_tape_p->json_cstr   = (char*)(out_tape_p->entries_p + out_tape_p->len);
+    out_tape_p->json_len    = header_p->json_len;
+    out_tape_p->mapped_size = mapped_size;
+    if (!_JsonTape_is_valid(out_tape_p))
+    {
+        LOG_ERROR("Invalid snapshot `%s`.", path);
+        JsonTape_destroy(out_tape_p);
+        return ERR_INVALID;
+    }
+    return ERR_ALL_GOOD;
+}
+
+static inline JsonTapeView _JsonTape_root(const JsonTape* tape_p)
+{
+    JsonTapeView view = {.json_cstr = tape_p->json_cstr, .entry_p = tape_p->entries_p};
+    return view;
+}
+
+size_t JsonTapeView_len(const JsonTapeView* view_p)
+{
+    const uint32_t value_type = view_p->entry_p->value_type;
+    return ((value_type == VALUE_ITEM) || (value_type == VALUE_ARRAY))
+             ? view_p->entry_p->container.len
+             : 0;
+}
+
+// Return the member `key` of the object, or NULL. Nested containers are skipped in one step.
+static const JsonTapeEntry* _JsonTapeView_find(const JsonTapeView* view_p, const char* key)
+{
+    const JsonTapeEntry* entry_p = view_p->entry_p;
+    if (entry_p->value_type != VALUE_ITEM)
+    {
+        LOG_ERROR("Key `%s` used on a value which is not an object.", key);
+        return NULL;
+    }
+    const uint32_t len = entry_p->container.len;
+    entry_p++;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        if (strcmp(view_p->json_cstr + entry_p->key_offset, key) == 0)
+        {
+            return entry_p;
+        }
+        const uint32_t value_type = entry_p->value_type;
+        entry_p += ((value_type == VALUE_ITEM) || (value_type == VALUE_ARRAY))
+                     ? entry_p->container.skip
+                     : 1;
+    }
+    return NULL;
+}
+
+// Return the element at `index` of the array, or NULL. Arrays with no containers as elements take
+// one entry per element, hence they are indexed in O(1).
+static const JsonTapeEntry* _JsonTapeView_at(const JsonTapeView* view_p, size_t index)
+{
+    const JsonTapeEntry* entry_p = view_p->entry_p;
+    if ((entry_p->value_type != VALUE_ARRAY) || (index >= entry_p->container.len))
+    {
+        LOG_ERROR("Index %zu out of boundaries.", index);
+        return NULL;
+    }
+    if (entry_p->container.skip == entry_p->container.len + 1)
+    {
+        return entry_p + 1 + index;
+    }
+    entry_p++;
+    while (index--)
+    {
+        const uint32_t value_type = entry_p->value_type;
+        entry_p += ((value_type == VALUE_ITEM) || (value_type == VALUE_ARRAY))
+                     ? entry_p->container.skip
+                     : 1;
+    }
+    return entry_p;
+}
+
+// Store the value of `entry_p` as `value_type` at `out_p`. VALUE_ITEM stands for an object or an
+// array, stored as a `JsonTapeView`.
+static Error _JsonTapeEntry_read(
+    const JsonTapeView* view_p,
+    const JsonTapeEntry* entry_p,
+    ValueType value_type,
+    void* out_p)
+{
+    if (entry_p == NULL)
+    {
+        return ERR_JSON_MISSING_ENTRY;
+    }
+    if (value_type == VALUE_ITEM)
+    {
+        if ((entry_p->value_type != VALUE_ITEM) && (entry_p->value_type != VALUE_ARRAY))
+        {
+            LOG_ERROR("Requested object or array, found %d.", entry_p->value_type);
+            return ERR_TYPE_MISMATCH;
+        }
+        ((JsonTapeView*)out_p)->json_cstr = view_p->json_cstr;
+        ((JsonTapeView*)out_p)->entry_p   = entry_p;
+        return ERR_ALL_GOOD;
+    }
+    JsonValue value = {.value_type = (ValueType)entry_p->value_type};
+    if (value.value_type == VALUE_CSTR)
+    {
+        value.value_cstr = view_p->json_cstr + entry_p->cstr_offset;
+    }
+    else
+    {
+        value.value_llu = entry_p->value_llu;
+    }
+    if (!_JsonValue_store(&value, value_type, out_p))
+    {
+        LOG_ERROR("Requested value of type %d, found %d.", value_type, entry_p->value_type);
+        return ERR_TYPE_MISMATCH;
+    }
+    return ERR_ALL_GOOD;
+}
+
+Error Json_get_unsupported(const void* json_stuff, ...)
+{
+    UNUSED(json_stuff);
+    LOG_ERROR("A JsonTapeView can only be read from a JsonTape or another JsonTapeView.");
+    return ERR_TYPE_MISMATCH;
+}
+
+#define TAPE_GET_VALUE_c(suffix, value_token, out_type)                                         \
+    Error tape_obj_get_##suffix(const JsonTape* tape_p, const char* key, out_type out_value)    \
+    {                                                                                           \
+        const JsonTapeView view = _JsonTape_root(tape_p);                                       \
+        return _JsonTapeEntry_read(                                                             \
+            &view, _JsonTapeView_find(&view, key), value_token, out_value);                     \
+    }                                                                                           \
+    Error tape_obj_get_array_##suffix(const JsonTape* tape_p, size_t index, out_type out_value) \
+    {                                                                                           \
+        const JsonTapeView view = _JsonTape_root(tape_p);                                       \
+        return _JsonTapeEntry_read(                                                             \
+            &view, _JsonTapeView_at(&view, index), value_token, out_value);                     \
+    }                                                                                           \
+    Error tape_get_##suffix(const JsonTapeView* view_p, const char* key, out_type out_value)    \
+    {                                                                                           \
+        return _JsonTapeEntry_read(                                                             \
+            view_p, _JsonTapeView_find(view_p, key), value_token, out_value);                   \
+    }                                                                                           \
+    Error tape_get_array_##suffix(const JsonTapeView* view_p, size_t index, out_type out_value) \
+    {                                                                                           \
+        return _JsonTapeEntry_read(                                                             \
+            view_p, _JsonTapeView_at(view_p, index), value_token, out_value);                   \
+    }
+
+// clang-format off
+TAPE_GET_VALUE_c(value_cstr, VALUE_CSTR, const char**)
+TAPE_GET_VALUE_c(value_lld, VALUE_LLD, lld_t*)
+TAPE_GET_VALUE_c(value_llu, VALUE_LLU, llu_t*)
+TAPE_GET_VALUE_c(value_double, VALUE_DOUBLE, double*)
+TAPE_GET_VALUE_c(value_bool, VALUE_BOOL, bool*)
+TAPE_GET_VALUE_c(value_view, VALUE_ITEM, JsonTapeView*)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wextra-semi"
+; // ensure clang-format works when turned on again
+#pragma clang diagnostic pop
+// clang-format on
+
+// Smallest buffer of a `JsonWriter`, which doubles whenever it is full.
+#define JSON_WRITER_MIN_SIZE (256)
+
+// Two decimal digits for each number below 100, to format integers two digits at a time.
+static const char _json_digit_pairs[] = "0001020304050607080910111213141516171819"
+                                        "2021222324252627282930313233343536373839"
+                                        "4041424344454647484950515253545556575859"
+                                        "6061626364656667686970717273747576777879"
+                                        "8081828384858687888990919293949596979899";
+
+// Write the digits of `value` so that they end at `end_p`, and return where they begin.
+static char* _json_format_llu(llu_t value, char* end_p)
+{
+    while (value >= 100)
+    {
+        const size_t pair_offset = (size_t)(value % 100) * 2;
+        value /= 100;
+        end_p -= 2;
+        memcpy(end_p, _json_digit_pairs + pair_offset, 2);
+    }
+    if (value >= 10)
+    {
+        end_p -= 2;
+        memcpy(end_p, _json_digit_pairs + value * 2, 2);
+    }
+    else
+    {
+        *--end_p = (char)('0' + value);
+    }
+    return end_p;
+}
+
+// Longest escape sequence, used for control chars: `\u001f`.
+#define JSON_ESCAPE_MAX_LEN (6)
+
+// Write at `out_p` the escape sequence of `c`, a quote, a backslash or a control char, and return
+// its length.
+static size_t _json_escape_char(char c, char* out_p)
+{
+    out_p[0] = '\\';
+    switch (c)
+    {
+    case '"':
+    case '\\':
+        out_p[1] = c;
+        return 2;
+    case '\b':
+        out_p[1] = 'b';
+        return 2;
+    case '\f':
+        out_p[1] = 'f';
+        return 2;
+    case '\n':
+        out_p[1] = 'n';
+        return 2;
+    case '\r':
+        out_p[1] = 'r';
+        return 2;
+    case '\t':
+        out_p[1] = 't';
+        return 2;
+    default:
+        out_p[1] = 'u';
+        out_p[2] = '0';
+        out_p[3] = '0';
+        out_p[4] = "0123456789abcdef"[(unsigned char)c >> 4];
+        out_p[5] = "0123456789abcdef"[(unsigned char)c & 0xF];
+        return JSON_ESCAPE_MAX_LEN;
+    }
+}
+
+// Make room for `len` more chars, plus the terminating '\0'.
+static inline void _JsonWriter_reserve(JsonWriter* writer_p, size_t len)
+{
+    if (writer_p->len + len < writer_p->size)
+    {
+        return;
+    }
+    while (writer_p->len + len >= writer_p->size)
+    {
+        writer_p->size *= 2;
+    }
+    writer_p->buffer_p
+        = my_memory_realloc(__FILENAME__, __LINE__, writer_p->buffer_p, writer_p->size);
+}
+
+static inline void _JsonWriter_put(JsonWriter* writer_p, const char* chars_p, size_t len)
+{
+    _JsonWriter_reserve(writer_p, len);
+    memcpy(writer_p->buffer_p + writer_p->len, chars_p, len);
+    writer_p->len += len;
+}
+
+static inline void _JsonWriter_put_char(JsonWriter* writer_p, char c)
+{
+    _JsonWriter_reserve(writer_p, 1);
+    writer_p->buffer_p[writer_p->len++] = c;
+}
+
+// Start a new value, preceded by a comma unless it is the first one of its container or the value
+// of a key.
+static inline void _JsonWriter_separate(JsonWriter* writer_p)
+{
+    if (writer_p->need_comma)
+    {
+        _JsonWriter_put_char(writer_p, ',');
+    }
+    writer_p->need_comma = true;
+}
+
+static void _JsonWriter_open(JsonWriter* writer_p, char c)
+{
+    _JsonWriter_separate(writer_p);
+    _JsonWriter_put_char(writer_p, c);
+    writer_p->depth++;
+    writer_p->need_comma = false;
+}
+
+static void _JsonWriter_close(JsonWriter* writer_p, char c)
+{
+    if (writer_p->depth == 0)
+    {
+        LOG_ERROR("No object or array to close with `%c`", c);
+        writer_p->failed = true;
+        return;
+    }
+    _JsonWriter_put_char(writer_p, c);
+    writer_p->depth--;
+    writer_p->need_comma = true;
+}
+
+// Append `len` chars at `cstr` escaped as the content of a JSON string. Each block of input is
+// classified at once, hence chars that need no escaping are copied a block at a time.
+static void _JsonWriter_escape(JsonWriter* writer_p, const char* cstr, size_t len)
+{
+    const char* end_p = cstr + len;
+    JsonBlockMasks masks;
+    while (cstr < end_p)
+    {
+        size_t available = (size_t)(end_p - cstr);
+        if (available >= JSON_BLOCK_SIZE)
+        {
+            available = JSON_BLOCK_SIZE;
+            _classify_block(cstr, &masks);
+        }
+        else
+        {
+            char padded_block[JSON_BLOCK_SIZE] = {0};
+            memcpy(padded_block, cstr, available);
+            _classify_block(padded_block, &masks);
+        }
+        uint64_t to_escape = masks.quote | masks.backslash | masks.control;
+        if (available < JSON_BLOCK_SIZE)
+        {
+            // The padding looks like control chars.
+            to_escape &= ((uint64_t)1 << available) - 1;
+        }
+        size_t copied = 0;
+        while (to_escape != 0)
+        {
+            const size_t offset = (size_t)__builtin_ctzll(to_escape);
+            const char c        = cstr[offset];
+            to_escape &= to_escape - 1;
+            _JsonWriter_put(writer_p, cstr + copied, offset - copied);
+            copied = offset + 1;
+            _JsonWriter_reserve(writer_p, JSON_ESCAPE_MAX_LEN);
+            writer_p->len += _json_escape_char(c, writer_p->buffer_p + writer_p->len);
+        }
+        _JsonWriter_put(writer_p, cstr + copied, available - copied);
+        cstr += available;
+    }
+}
+
+// Append the `len` chars at `cstr`, which may include null chars, as a string.
+static void _JsonWriter_string(JsonWriter* writer_p, const char* cstr, size_t len)
+{
+    _JsonWriter_separate(writer_p);
+    _JsonWriter_put_char(writer_p, '"');
+    _JsonWriter_escape(writer_p, cstr, len);
+    _JsonWriter_put_char(writer_p, '"');
+}
+
+// Append a string which is escaped already, as those left unparsed in the input are.
+static void _JsonWriter_raw_cstr(JsonWriter* writer_p, const char* cstr, size_t len)
+{
+    _JsonWriter_reserve(writer_p, len + 2);
+    writer_p->buffer_p[writer_p->len++] = '"';
+    memcpy(writer_p->buffer_p + writer_p->len, cstr, len);
+    writer_p->len += len;
+    writer_p->buffer_p[writer_p->len++] = '"';
+}
+
+static void _JsonWriter_raw_key(JsonWriter* writer_p, const char* key, size_t len)
+{
+    _JsonWriter_separate(writer_p);
+    _JsonWriter_raw_cstr(writer_p, key, len);
+    _JsonWriter_put_char(writer_p, ':');
+    writer_p->need_comma = false;
+}
+
+Error _JsonWriter_new(const char* file, const int line, JsonWriter* out_writer_p)
+{
+    pthread_once(&_classify_once_ctl, _classify_block_select);
+    out_writer_p->buffer_p   = my_memory_malloc(file, line, JSON_WRITER_MIN_SIZE);
+    out_writer_p->len        = 0;
+    out_writer_p->size       = JSON_WRITER_MIN_SIZE;
+    out_writer_p->depth      = 0;
+    out_writer_p->need_comma = false;
+    out_writer_p->failed     = false;
+    return ERR_ALL_GOOD;
+}
+
+void JsonWriter_begin_object(JsonWriter* writer_p) { _JsonWriter_open(writer_p, '{'); }
+
+void JsonWriter_end_object(JsonWriter* writer_p) { _JsonWriter_close(writer_p, '}'); }
+
+void JsonWriter_begin_array(JsonWriter* writer_p) { _JsonWriter_open(writer_p, '['); }
+
+void JsonWriter_end_array(JsonWriter* writer_p) { _JsonWriter_close(writer_p, ']'); }
+
+void JsonWriter_key(JsonWriter* writer_p, const char* key)
+{
+    _JsonWriter_separate(writer_p);
+    _JsonWriter_put_char(writer_p, '"');
+    _JsonWriter_escape(writer_p, key, strlen(key));
+    _JsonWriter_put(writer_p, "\":", 2);
+    writer_p->need_comma = false;
+}
+
+void JsonWriter_cstr(JsonWriter* writer_p, const char* value_cstr)
+{
+    if (value_cstr == NULL)
+    {
+        JsonWriter_null(writer_p);
+        return;
+    }
+    _JsonWriter_string(writer_p, value_cstr, strlen(value_cstr));
+}
+
+void JsonWriter_lld(JsonWriter* writer_p, lld_t value_lld)
+{
+    char digits[24];
+    char* end_p   = digits + sizeof(digits);
+    // Negate as unsigned, which also works for the smallest value.
+    char* begin_p = _json_format_llu(
+        (value_lld < 0) ? (llu_t)0 - (llu_t)value_lld : (llu_t)value_lld, end_p);
+    if (value_lld < 0)
+    {
+        *--begin_p = '-';
+    }
+    _JsonWriter_separate(writer_p);
+    _JsonWriter_put(writer_p, begin_p, (size_t)(end_p - begin_p));
+}
+
+void JsonWriter_llu(JsonWriter* writer_p, llu_t value_llu)
+{
+    char digits[24];
+    char* end_p   = digits + sizeof(digits);
+    char* begin_p = _json_format_llu(value_llu, end_p);
+    _JsonWriter_separate(writer_p);
+    _JsonWriter_put(writer_p, begin_p, (size_t)(end_p - begin_p));
+}
+
+// Floating point number with a 64-bit significand, as used by Grisu2.
+typedef struct
+{
+    uint64_t significand;
+    int exponent; // Power of 2 by which `significand` is multiplied.
+} JsonDiyFp;
+
+// Normalized powers of 10 from 1e-348 to 1e340, in steps of 8 decimal exponents.
+#define JSON_CACHED_POW10_MIN_EXPONENT (-348)
+#define JSON_CACHED_POW10_STEP (8)
+
+static const JsonDiyFp _json_cached_pow10[] = {
+    {0xFA8FD5A0081C0288ULL, -1220}, {0xBAAEE17FA23EBF76ULL, -1193}, {0x8B16FB203055AC76ULL, -1166},
+    {0xCF42894A5DCE35EAULL, -1140}, {0x9A6BB0AA55653B2DULL, -1113}, {0xE61ACF033D1A45DFULL, -1087},
+    {0xAB70FE17C79AC6CAULL, -1060}, {0xFF77B1FCBEBCDC4FULL, -1034}, {0xBE5691EF416BD60CULL, -1007},
+    {0x8DD01FAD907FFC3CULL, -980}, {0xD3515C2831559A83ULL, -954}, {0x9D71AC8FADA6C9B5ULL, -927},
+    {0xEA9C227723EE8BCBULL, -901}, {0xAECC49914078536DULL, -874}, {0x823C12795DB6CE57ULL, -847},
+    {0xC21094364DFB5637ULL, -821}, {0x9096EA6F3848984FULL, -794}, {0xD77485CB25823AC7ULL, -768},
+    {0xA086CFCD97BF97F4ULL, -741}, {0xEF340A98172AACE5ULL, -715}, {0xB23867FB2A35B28EULL, -688},
+    {0x84C8D4DFD2C63F3BULL, -661}, {0xC5DD44271AD3CDBAULL, -635}, {0x936B9FCEBB25C996ULL, -608},
+    {0xDBAC6C247D62A584ULL, -582}, {0xA3AB66580D5FDAF6ULL, -555}, {0xF3E2F893DEC3F126ULL, -529},
+    {0xB5B5ADA8AAFF80B8ULL, -502}, {0x87625F056C7C4A8BULL, -475}, {0xC9BCFF6034C13053ULL, -449},
+    {0x964E858C91BA2655ULL, -422}, {0xDFF9772470297EBDULL, -396}, {0xA6DFBD9FB8E5B88FULL, -369},
+    {0xF8A95FCF88747D94ULL, -343}, {0xB94470938FA89BCFULL, -316}, {0x8A08F0F8BF0F156BULL, -289},
+    {0xCDB02555653131B6ULL, -263}, {0x993FE2C6D07B7FACULL, -236}, {0xE45C10C42A2B3B06ULL, -210},
+    {0xAA242499697392D3ULL, -183}, {0xFD87B5F28300CA0EULL, -157}, {0xBCE5086492111AEBULL, -130},
+    {0x8CBCCC096F5088CCULL, -103}, {0xD1B71758E219652CULL, -77}, {0x9C40000000000000ULL, -50},
+    {0xE8D4A51000000000ULL, -24}, {0xAD78EBC5AC620000ULL, 3}, {0x813F3978F8940984ULL, 30},
+    {0xC097CE7BC90715B3ULL, 56}, {0x8F7E32CE7BEA5C70ULL, 83}, {0xD5D238A4ABE98068ULL, 109},
+    {0x9F4F2726179A2245ULL, 136}, {0xED63A231D4C4FB27ULL, 162}, {0xB0DE65388CC8ADA8ULL, 189},
+    {0x83C7088E1AAB65DBULL, 216}, {0xC45D1DF942711D9AULL, 242}, {0x924D692CA61BE758ULL, 269},
+    {0xDA01EE641A708DEAULL, 295}, {0xA26DA3999AEF774AULL, 322}, {0xF209787BB47D6B85ULL, 348},
+    {0xB454E4A179DD1877ULL, 375}, {0x865B86925B9BC5C2ULL, 402}, {0xC83553C5C8965D3DULL, 428},
+    {0x952AB45CFA97A0B3ULL, 455}, {0xDE469FBD99A05FE3ULL, 481}, {0xA59BC234DB398C25ULL, 508},
+    {0xF6C69A72A3989F5CULL, 534}, {0xB7DCBF5354E9BECEULL, 561}, {0x88FCF317F22241E2ULL, 588},
+    {0xCC20CE9BD35C78A5ULL, 614}, {0x98165AF37B2153DFULL, 641}, {0xE2A0B5DC971F303AULL, 667},
+    {0xA8D9D1535CE3B396ULL, 694}, {0xFB9B7CD9A4A7443CULL, 720}, {0xBB764C4CA7A44410ULL, 747},
+    {0x8BAB8EEFB6409C1AULL, 774}, {0xD01FEF10A657842CULL, 800}, {0x9B10A4E5E9913129ULL, 827},
+    {0xE7109BFBA19C0C9DULL, 853}, {0xAC2820D9623BF429ULL, 880}, {0x80444B5E7AA7CF85ULL, 907},
+    {0xBF21E44003ACDD2DULL, 933}, {0x8E679C2F5E44FF8FULL, 960}, {0xD433179D9C8CB841ULL, 986},
+    {0x9E19DB92B4E31BA9ULL, 1013}, {0xEB96BF6EBADF77D9ULL, 1039}, {0xAF87023B9BF0EE6BULL, 1066},
+};
+
+static const uint64_t _json_pow10_u64[] = {
+    1ULL,
+    10ULL,
+    100ULL,
+    1000ULL,
+    10000ULL,
+    100000ULL,
+    1000000ULL,
+    10000000ULL,
+    100000000ULL,
+    1000000000ULL,
+    10000000000ULL,
+    100000000000ULL,
+    1000000000000ULL,
+    10000000000000ULL,
+    100000000000000ULL,
+    1000000000000000ULL,
+    10000000000000000ULL,
+    100000000000000000ULL,
+    1000000000000000000ULL,
+    10000000000000000000ULL,
+};
+
+// Product rounded to the upper 64 bits.
+static inline JsonDiyFp _JsonDiyFp_mul(JsonDiyFp lhs, JsonDiyFp rhs)
+{
+    const unsigned __int128 product = (unsigned __int128)lhs.significand * rhs.significand;
+    JsonDiyFp result;
+    result.significand = (uint64_t)(product >> 64) + (((uint64_t)product >> 63) & 1);
+    result.exponent    = lhs.exponent + rhs.exponent + 64;
+    return result;
+}
+
+static inline JsonDiyFp _JsonDiyFp_normalize(JsonDiyFp diy_fp)
+{
+    const int shift = __builtin_clzll(diy_fp.significand);
+    diy_fp.significand <<= shift;
+    diy_fp.exponent -= shift;
+    return diy_fp;
+}
+
+// Emit digits of `value_double`, positive and finite, which read back as the same double, and the
+// power of 10 by which they are multiplied (Grisu2, by Florian Loitsch). They are the shortest ones
+// for all but about 0.1% of the values, which get one more digit. No locale is involved, and no
+// multiple precision arithmetic.
+static size_t _json_grisu2(double value_double, char* out_digits, int* out_pow10_p)
+{
+    uint64_t bits;
+    memcpy(&bits, &value_double, sizeof(bits));
+    const uint64_t hidden_bit = (uint64_t)1 << 52;
+    const int biased_exponent = (int)(bits >> 52) & 0x7FF;
+    JsonDiyFp value;
+    value.significand = (bits & (hidden_bit - 1)) | (biased_exponent ? hidden_bit : 0);
+    value.exponent    = (biased_exponent ? biased_exponent : 1) - 1075;
+    // Boundaries halfway to the neighbouring doubles, the lower one being closer at powers of 2.
+    JsonDiyFp plus;
+    JsonDiyFp minus;
+    plus.significand = (value.significand << 1) + 1;
+    plus.exponent    = value.exponent - 1;
+    plus             = _JsonDiyFp_normalize(plus);
+    if (value.significand == hidden_bit)
+    {
+        minus.significand = (value.significand << 2) - 1;
+        minus.exponent    = value.exponent - 2;
+    }
+    else
+    {
+        minus.significand = (value.significand << 1) - 1;
+        minus.exponent    = value.exponent - 1;
+    }
+    minus.significand <<= minus.exponent - plus.exponent;
+    minus.exponent = plus.exponent;
+
+    // Pick the power of 10 bringing the exponent of `plus` into [-60, -32].
+    const double approx_k = (-61 - plus.exponent) * 0.30102999566398114 + 347;
+    int k                 = (int)approx_k;
+    k += (approx_k - k > 0.0);
+    const size_t index  = (size_t)(k >> 3) + 1;
+    const JsonDiyFp c_k = _json_cached_pow10[index];
+    *out_pow10_p = -(JSON_CACHED_POW10_MIN_EXPONENT + (int)index * JSON_CACHED_POW10_STEP);
+
+    const JsonDiyFp scaled = _JsonDiyFp_mul(_JsonDiyFp_normalize(value), c_k);
+    JsonDiyFp upper        = _JsonDiyFp_mul(plus, c_k);
+    JsonDiyFp lower        = _JsonDiyFp_mul(minus, c_k);
+    lower.significand++;
+    upper.significand--;
+
+    // Generate the digits of `upper` until they are within `delta` of it.
+    const int shift     = -upper.exponent;
+    const uint64_t one  = (uint64_t)1 << shift;
+    const uint64_t wp_w = upper.significand - scaled.significand;
+    uint64_t delta      = upper.significand - lower.significand;
+    uint32_t integral   = (uint32_t)(upper.significand >> shift);
+    uint64_t fractional = upper.significand & (one - 1);
+    int kappa           = 1;
+    size_t len          = 0;
+    uint64_t rest;
+    uint64_t ten_kappa;
+    uint64_t distance;
+    while ((kappa < 10) && (integral >= _json_pow10_u64[kappa]))
+    {
+        kappa++;
+    }
+    for (;;)
+    {
+        if (kappa > 0)
+        {
+            const uint32_t digit = integral / (uint32_t)_json_pow10_u64[kappa - 1];
+            integral %= (uint32_t)_json_pow10_u64[kappa - 1];
+            kappa--;
+            if ((digit != 0) || (len != 0))
+            {
+                out_digits[len++] = (char)('0' + digit);
+            }
+            rest = ((uint64_t)integral << shift) + fractional;
+            if (rest <= delta)
+            {
+                ten_kappa = _json_pow10_u64[kappa] << shift;
+                distance  = wp_w;
+                break;
+            }
+            continue;
+        }
+        fractional *= 10;
+        delta *= 10;
+        const char digit = (char)(fractional >> shift);
+        fractional &= one - 1;
+        kappa--;
+        if ((digit != 0) || (len != 0))
+        {
+            out_digits[len++] = (char)('0' + digit);
+        }
+        if (fractional < delta)
+        {
+            rest      = fractional;
+            ten_kappa = one;
+            distance  = (-kappa < 20) ? wp_w * _json_pow10_u64[-kappa] : 0;
+            break;
+        }
+    }
+    *out_pow10_p += kappa;
+    // Move the last digit towards the value itself, as long as it stays within the boundaries.
+    while ((rest < distance) && (delta - rest >= ten_kappa)
+           && ((rest + ten_kappa < distance) || (distance - rest > rest + ten_kappa - distance)))
+    {
+        out_digits[len - 1]--;
+        rest += ten_kappa;
+    }
+    return len;
+}
+
+// Lay out `len` digits multiplied by 10^`pow10` as printf's `%g` would, but always with a '.', so
+// that parsing the result gives a double again rather than an integer. Return the length.
+static size_t _json_format_double(const char* digits, size_t len, int pow10, char* out_p)
+{
+    const int exponent = (int)len - 1 + pow10; // Of the first digit.
+    char* curr_p       = out_p;
+    if ((exponent < -4) || (exponent >= 15))
+    {
+        *curr_p++ = digits[0];
+        *curr_p++ = '.';
+        if (len == 1)
+        {
+            *curr_p++ = '0';
+        }
+        memcpy(curr_p, digits + 1, len - 1);
+        curr_p += len - 1;
+        curr_p += sprintf(curr_p, "e%c%02d", (exponent < 0) ? '-' : '+', abs(exponent));
+    }
+    else if (exponent < 0)
+    {
+        memcpy(curr_p, "0.", 2);
+        memset(curr_p + 2, '0', (size_t)(-exponent - 1));
+        curr_p += 1 - exponent;
+        memcpy(curr_p, digits, len);
+        curr_p += len;
+    }
+    else if ((size_t)exponent + 1 >= len)
+    {
+        memcpy(curr_p, digits, len);
+        memset(curr_p + len, '0', (size_t)exponent + 1 - len);
+        curr_p += exponent + 1;
+        memcpy(curr_p, ".0", 2);
+        curr_p += 2;
+    }
+    else
+    {
+        memcpy(curr_p, digits, (size_t)exponent + 1);
+        curr_p += exponent + 1;
+        *curr_p++ = '.';
+        memcpy(curr_p, digits + exponent + 1, len - (size_t)exponent - 1);
+        curr_p += len - (size_t)exponent - 1;
+    }
+    return (size_t)(curr_p - out_p);
+}
+
+// Write the shortest digits, with the exception above, that read back as the same double, whatever
+// the locale.
+void JsonWriter_double(JsonWriter* writer_p, double value_double)
+{
+    if (!isfinite(value_double))
+    {
+        LOG_WARNING("JSON cannot represent %f: writing null instead", value_double);
+        JsonWriter_null(writer_p);
+        return;
+    }
+    char digits[20];
+    char formatted[40];
+    char* curr_p = formatted;
+    if (signbit(value_double))
+    {
+        *curr_p++    = '-';
+        value_double = -value_double;
+    }
+    if (value_double == 0.0)
+    {
+        memcpy(curr_p, "0.0", 3);
+        curr_p += 3;
+    }
+    else
+    {
+        int pow10;
+        const size_t len = _json_grisu2(value_double, digits, &pow10);
+        curr_p += _json_format_double(digits, len, pow10, curr_p);
+    }
+    _JsonWriter_separate(writer_p);
+    _JsonWriter_put(writer_p, formatted, (size_t)(curr_p - formatted));
+}
+
+void JsonWriter_bool(JsonWriter* writer_p, bool value_bool)
+{
+    _JsonWriter_separate(writer_p);
+    if (value_bool)
+    {
+        _JsonWriter_put(writer_p, "true", 4);
+    }
+    else
+    {
+        _JsonWriter_put(writer_p, "false", 5);
+    }
+}
+
+void JsonWriter_null(JsonWriter* writer_p)
+{
+    _JsonWriter_separate(writer_p);
+    _JsonWriter_put(writer_p, "null", 4);
+}
+
+// Hand the document over to `out_string_p`, without copying it. The writer must be destroyed
+// afterwards, or made new to write another document.
+Error JsonWriter_to_string(JsonWriter* writer_p, String* out_string_p)
+{
+    if (writer_p->failed || (writer_p->depth != 0) || (writer_p->len == 0))
+    {
+        LOG_ERROR("Incomplete JSON document");
+        return ERR_JSON_INVALID;
+    }
+    writer_p->buffer_p[writer_p->len] = '\0';
+    out_string_p->str                 = writer_p->buffer_p;
+    out_string_p->length              = writer_p->len;
+    out_string_p->size                = writer_p->size - 1;
+    writer_p->buffer_p                = NULL;
+    writer_p->len                     = 0;
+    writer_p->size                    = 0;
+    return ERR_ALL_GOOD;
+}
+
+void JsonWriter_destroy(JsonWriter* writer_p)
+{
+    if (writer_p == NULL)
+    {
+        return;
+    }
+    my_memory_free(writer_p->buffer_p);
+    writer_p->buffer_p = NULL;
+    writer_p->len      = 0;
+    writer_p->size     = 0;
+}
+
+// Write the container left unparsed by `JsonObj_new_lazy()` at `start_p`, token by token.
+static Error _JsonWriter_lazy(JsonWriter* writer_p, const JsonObj* json_obj_p, const char* start_p)
+{
+    const char* end_p = json_obj_p->json_cstr + json_obj_p->json_len;
+    JsonTokenizer tokenizer;
+    JsonToken token;
+    _JsonTokenizer_init(&tokenizer, start_p, (size_t)(end_p - start_p));
+    do
+    {
+        switch (_JsonTokenizer_next(&tokenizer, &token))
+        {
+        case TOKEN_OBJECT_BEGIN:
+            JsonWriter_begin_object(writer_p);
+            break;
+        case TOKEN_OBJECT_END:
+            JsonWriter_end_object(writer_p);
+            break;
+        case TOKEN_ARRAY_BEGIN:
+            JsonWriter_begin_array(writer_p);
+            break;
+        case TOKEN_ARRAY_END:
+            JsonWriter_end_array(writer_p);
+            break;
+        case TOKEN_KEY:
+            _JsonWriter_raw_key(writer_p, token.start_p, token.len);
+            break;
+        case TOKEN_STRING:
+            _JsonWriter_separate(writer_p);
+            _JsonWriter_raw_cstr(writer_p, token.start_p, token.len);
+            break;
+        case TOKEN_NUMBER:
+            _JsonWriter_separate(writer_p);
+            _JsonWriter_put(writer_p, token.start_p, token.len);
+            break;
+        case TOKEN_TRUE:
+        case TOKEN_FALSE:
+            JsonWriter_bool(writer_p, token.type == TOKEN_TRUE);
+            break;
+        case TOKEN_NULL:
+            JsonWriter_null(writer_p);
+            break;
+        default:
+            return _JsonTokenizer_error(&tokenizer);
+        }
+    } while (tokenizer.depth > 0);
+    return ERR_ALL_GOOD;
+}
+
+// Write the items of the object in order, going down into containers and back up through the
+// parent of the last child, hence without recursion.
+static Error _JsonWriter_items(JsonWriter* writer_p, const JsonObj* json_obj_p)
+{
+    const JsonItem* root_p = &json_obj_p->root;
+    const JsonItem* item_p = root_p->next_sibling;
+    while (item_p != NULL)
+    {
+        const JsonItem* child_p = NULL;
+        if (item_p->key_p != NULL)
+        {
+            JsonWriter_key(writer_p, item_p->key_p);
+        }
+        switch (item_p->value.value_type)
+        {
+        case VALUE_ITEM:
+            JsonWriter_begin_object(writer_p);
+            child_p = item_p->value.value_child_p;
+            break;
+        case VALUE_ARRAY:
+            JsonWriter_begin_array(writer_p);
+            child_p = item_p->value.value_array_p->element;
+            break;
+        case VALUE_LAZY:
+            return_on_err(_JsonWriter_lazy(writer_p, json_obj_p, item_p->value.value_cstr));
+            break;
+        case VALUE_CSTR:
+            _JsonWriter_string(writer_p, item_p->value.value_cstr, item_p->value.cstr_len);
+            break;
+        case VALUE_LLD:
+            JsonWriter_lld(writer_p, item_p->value.value_lld);
+            break;
+        case VALUE_LLU:
+            JsonWriter_llu(writer_p, item_p->value.value_llu);
+            break;
+        case VALUE_DOUBLE:
+            JsonWriter_double(writer_p, item_p->value.value_double);
+            break;
+        case VALUE_BOOL:
+            JsonWriter_bool(writer_p, item_p->value.value_bool);
+            break;
+        case VALUE_NULL:
+            JsonWriter_null(writer_p);
+            break;
+        default:
+            LOG_ERROR("Cannot serialize value type %d", item_p->value.value_type);
+            return ERR_JSON_INVALID;
+        }
+        if (child_p != NULL)
+        {
+            item_p = child_p;
+            continue;
+        }
+        if ((item_p->value.value_type == VALUE_ITEM) || (item_p->value.value_type == VALUE_ARRAY))
+        {
+            // Empty container.
+            _JsonWriter_close(writer_p, (item_p->value.value_type == VALUE_ITEM) ? '}' : ']');
+        }
+        // Close the containers whose last child has been written.
+        while ((item_p->next_sibling == NULL) && (item_p->parent != root_p))
+        {
+            item_p = item_p->parent;
+            _JsonWriter_close(writer_p, (item_p->value.value_type == VALUE_ITEM) ? '}' : ']');
+        }
+        item_p = item_p->next_sibling;
+    }
+    return ERR_ALL_GOOD;
+}
+
+Error _JsonObj_to_string(
+    const char* file,
+    const int line,
+    const JsonObj* json_obj_p,
+    String* out_string_p)
+{
+    if ((json_obj_p == NULL) || (json_obj_p->root.value.value_type != VALUE_ROOT))
+    {
+        LOG_ERROR("Uninitialized JSON object");
+        return ERR_NULL;
+    }
+    const JsonItem* first_item_p = json_obj_p->root.next_sibling;
+    // Only a top-level array has an item without a key as the first sibling of root.
+    const bool is_object = (first_item_p == NULL) || (first_item_p->key_p != NULL);
+    JsonWriter writer;
+    _JsonWriter_new(file, line, &writer);
+    if (is_object)
+    {
+        JsonWriter_begin_object(&writer);
+    }
+    Error ret_err = _JsonWriter_items(&writer, json_obj_p);
+    if (is_ok(ret_err) && is_object)
+    {
+        JsonWriter_end_object(&writer);
+    }
+    if (is_ok(ret_err))
+    {
+        ret_err = JsonWriter_to_string(&writer, out_string_p);
+    }
+    JsonWriter_destroy(&writer);
+    return ret_err;
+}
+
+// Copy `cstr` into the arena of `json_obj_p`. The length of the copy is stored at `out_len_p`,
+// unless NULL.
+static const char* _JsonObj_copy_cstr(
+    JsonObj* json_obj_p,
+    const char* cstr,
+    uint32_t* out_len_p)
+{
+    const size_t len = strlen(cstr);
+    char* copy_p     = _JsonArena_alloc(__FILENAME__, __LINE__, &json_obj_p->arena, len + 1);
+    memcpy(copy_p, cstr, len + 1);
+    if (out_len_p != NULL)
+    {
+        *out_len_p = (uint32_t)len;
+    }
+    return copy_p;
+}
+
+// Replace the value of `item_p`. Only strings need memory, taken from the arena of the object. The
+// previous value, if a container, stays in the arena until the object is destroyed.
+static void _JsonItem_assign(JsonObj* json_obj_p, JsonItem* item_p, const JsonValue* value_p)
+{
+    item_p->value = *value_p;
+    if (value_p->value_type == VALUE_CSTR)
+    {
+        item_p->value.value_cstr
+            = _JsonObj_copy_cstr(json_obj_p, value_p->value_cstr, &item_p->value.cstr_len);
+    }
+}
+
+// Add the member `item_p` just inserted to the index of its object, if indexed.
+static void _JsonObj_index_member(
+    JsonObj* json_obj_p,
+    const JsonItem* parent_p,
+    const JsonItem* item_p)
+{
+    JsonKeyIndex* index_p = json_obj_p->key_index_p;
+    if ((index_p == NULL) || !_JsonKeyIndex_has_parent(index_p, parent_p))
+    {
+        return;
+    }
+    const JsonKeyIndexEntry entry = {
+        .parent_p = parent_p,
+        .item_p   = item_p,
+        .hash     = _json_key_hash(parent_p, item_p->key_p),
+    };
+    index_p = _JsonKeyIndex_reserve(index_p, 1);
+    _JsonKeyIndex_insert(index_p, &entry);
+    json_obj_p->key_index_p = index_p;
+}
+
+// Remove the member `item_p` just unlinked from the index of its object, if indexed. The following
+// member with the same key, if any, takes its place.
+static void _JsonObj_unindex_member(
+    JsonObj* json_obj_p,
+    const JsonItem* parent_p,
+    const JsonItem* item_p)
+{
+    JsonKeyIndex* index_p = json_obj_p->key_index_p;
+    if ((index_p == NULL) || !_JsonKeyIndex_has_parent(index_p, parent_p))
+    {
+        return;
+    }
+    const uint64_t hash = _json_key_hash(parent_p, item_p->key_p);
+    JsonKeyIndexEntry* entry_p = _JsonKeyIndex_find(index_p, parent_p, item_p->key_p, hash);
+    if ((entry_p == NULL) || (entry_p->item_p != item_p))
+    {
+        return;
+    }
+    for (const JsonItem* next_p = item_p->next_sibling; next_p != NULL;
+         next_p                 = next_p->next_sibling)
+    {
+        if (strcmp(next_p->key_p, item_p->key_p) == 0)
+        {
+            entry_p->item_p = next_p;
+            return;
+        }
+    }
+    entry_p->parent_p = &_json_key_index_tombstone;
+}
+
+// Link to the first member of the object whose item is `parent_p`, or of the top-level object if
+// `parent_p` is root. Return NULL if `parent_p` is not an object.
+static JsonItem** _JsonItem_members(JsonItem* parent_p, const char* key)
+{
+    if (parent_p == parent_p->parent)
+    {
+        return &parent_p->next_sibling;
+    }
+    if (parent_p->value.value_type != VALUE_ITEM)
+    {
+        LOG_ERROR("Key `%s` used on an array element.", key);
+        return NULL;
+    }
+    return &parent_p->value.value_child_p;
+}
+
+static Error _JsonItem_set(JsonItem* item_p, const char* key, const JsonValue* value_p)
+{
+    if (item_p == NULL)
+    {
+        LOG_ERROR("Input item is NULL - key `%s`.", key);
+        return ERR_NULL;
+    }
+    const JsonItem* found_item_p = NULL;
+    Error ret_err                = _JsonItem_find(item_p, key, &found_item_p);
+    if (is_err(ret_err))
+    {
+        LOG_ERROR("Cannot set missing entry - key `%s`.", key);
+        return ret_err;
+    }
+    _JsonItem_assign(_JsonItem_get_obj(found_item_p), (JsonItem*)found_item_p, value_p);
+    return ERR_ALL_GOOD;
+}
+
+static Error _JsonArray_set(JsonArray* json_array_p, size_t index, const JsonValue* value_p)
+{
+    if (json_array_p == NULL)
+    {
+        LOG_ERROR("Input array is NULL");
+        return ERR_NULL;
+    }
+    JsonItem* json_item = _JsonArray_at(json_array_p, index);
+    if (json_item == NULL)
+    {
+        LOG_ERROR("Index %zu out of boundaries.", index);
+        return ERR_OUT_OF_RANGE;
+    }
+    _JsonItem_assign(_JsonItem_get_obj(json_item), json_item, value_p);
+    return ERR_ALL_GOOD;
+}
+
+// Add the member `key` at the end of the object whose item is `parent_p`.
+static Error _JsonItem_insert(
+    JsonObj* json_obj_p,
+    JsonItem* parent_p,
+    const char* key,
+    const JsonValue* value_p)
+{
+    JsonItem** members_pp = _JsonItem_members(parent_p, key);
+    JsonItem* last_item_p = NULL;
+    if (members_pp == NULL)
+    {
+        return ERR_TYPE_MISMATCH;
+    }
+    for (JsonItem* item_p = *members_pp; item_p != NULL;
+         item_p           = item_p->next_sibling)
+    {
+        if (item_p->key_p == NULL)
+        {
+            LOG_ERROR("Cannot insert key `%s` into an array.", key);
+            return ERR_TYPE_MISMATCH;
+        }
+        if (strcmp(item_p->key_p, key) == 0)
+        {
+            LOG_ERROR("Key `%s` already present.", key);
+            return ERR_INVALID;
+        }
+        last_item_p = item_p;
+    }
+    JsonItem* new_item_p
+        = _JsonItem_append(__FILENAME__, __LINE__, &json_obj_p->arena, parent_p, last_item_p);
+    new_item_p->key_p = json_obj_p->arena.key_table_p
+                          ? _JsonKeyTable_intern(json_obj_p->arena.key_table_p, key, strlen(key))
+                          : _JsonObj_copy_cstr(json_obj_p, key, NULL);
+    _JsonItem_assign(json_obj_p, new_item_p, value_p);
+    _JsonObj_index_member(json_obj_p, parent_p, new_item_p);
+    return ERR_ALL_GOOD;
+}
+
+// Add the member `key` to the object which is the value of the member `object_key` of the object
+// `item` belongs to. Unlike `_JsonItem_insert()`, which needs a member to find the object, this
+// reaches empty objects too.
+static Error _JsonItem_insert_in(
+    const JsonItem* item,
+    const char* object_key,
+    const char* key,
+    const JsonValue* value_p)
+{
+    const JsonItem* container_p = NULL;
+    Error ret_err               = _JsonItem_find(item, object_key, &container_p);
+    if (is_err(ret_err))
+    {
+        LOG_ERROR("Cannot insert into missing entry - key `%s`.", object_key);
+        return ret_err;
+    }
+    if (is_err(_JsonItem_load(container_p)))
+    {
+        return ERR_JSON_INVALID;
+    }
+    if (container_p->value.value_type != VALUE_ITEM)
+    {
+        LOG_ERROR("Value of key `%s` is not an object.", object_key);
+        return ERR_TYPE_MISMATCH;
+    }
+    return _JsonItem_insert(
+        _JsonItem_get_obj(container_p), (JsonItem*)container_p, key, value_p);
+}
+
+// Number the elements from `item_p` on, starting at `index`.
+static void _JsonArray_renumber(JsonItem* item_p, size_t index)
+{
+    for (; item_p != NULL; item_p = item_p->next_sibling)
+    {
+        item_p->index = index++;
+    }
+}
+
+// Make room in the offset table, if any, for the element inserted at `index`. A full table is
+// replaced by one twice as large, so that the arena holds at most twice the final table.
+static void _JsonArray_table_insert(
+    JsonObj* json_obj_p,
+    JsonArray* json_array_p,
+    size_t index,
+    JsonItem* item_p)
+{
+    JsonItem** elements_pp = json_array_p->elements_pp;
+    if (elements_pp == NULL)
+    {
+        return;
+    }
+    if (json_array_p->len == json_array_p->elements_capacity)
+    {
+        json_array_p->elements_capacity *= 2;
+        elements_pp = _JsonArena_alloc(
+            __FILENAME__,
+            __LINE__,
+            &json_obj_p->arena,
+            json_array_p->elements_capacity * sizeof(JsonItem*));
+        memcpy(elements_pp, json_array_p->elements_pp, json_array_p->len * sizeof(JsonItem*));
+        json_array_p->elements_pp = elements_pp;
+    }
+    memmove(
+        &elements_pp[index + 1],
+        &elements_pp[index],
+        (json_array_p->len - index) * sizeof(JsonItem*));
+    elements_pp[index] = item_p;
+}
+
+// Add an element at `index`, moving the following ones forward. An index equal to the length
+// appends the element.
+static Error _JsonArray_insert(JsonArray* json_array_p, size_t index, const JsonValue* value_p)
+{
+    if (json_array_p == NULL)
+    {
+        LOG_ERROR("Input array is NULL");
+        return ERR_NULL;
+    }
+    if (index > json_array_p->len)
+    {
+        LOG_ERROR("Index %zu out of boundaries.", index);
+        return ERR_OUT_OF_RANGE;
+    }
+    JsonItem* owner_p   = json_array_p->owner_p;
+    JsonObj* json_obj_p = _JsonItem_get_obj(owner_p);
+    JsonItem* new_item_p = _JsonItem_new(__FILENAME__, __LINE__, &json_obj_p->arena);
+    new_item_p->parent   = owner_p;
+    if (index == 0)
+    {
+        new_item_p->next_sibling = json_array_p->element;
+        json_array_p->element    = new_item_p;
+    }
+    else
+    {
+        JsonItem* prev_p         = _JsonArray_at(json_array_p, index - 1);
+        new_item_p->next_sibling = prev_p->next_sibling;
+        prev_p->next_sibling     = new_item_p;
+    }
+    _JsonArray_table_insert(json_obj_p, json_array_p, index, new_item_p);
+    json_array_p->len++;
+    _JsonArray_renumber(new_item_p, index);
+    _JsonItem_assign(json_obj_p, new_item_p, value_p);
+    return ERR_ALL_GOOD;
+}
+
+// Unlink the member `key` from the object whose item is `parent_p`.
+static Error _JsonItem_remove(JsonObj* json_obj_p, JsonItem* parent_p, const char* key)
+{
+    JsonItem** link_pp = _JsonItem_members(parent_p, key);
+    if (link_pp == NULL)
+    {
+        return ERR_TYPE_MISMATCH;
+    }
+    while ((*link_pp != NULL) && ((*link_pp)->key_p != NULL) && strcmp((*link_pp)->key_p, key))
+    {
+        link_pp = &(*link_pp)->next_sibling;
+    }
+    if ((*link_pp == NULL) || ((*link_pp)->key_p == NULL))
+    {
+        LOG_ERROR("Cannot remove missing entry - key `%s`.", key);
+        return ERR_JSON_MISSING_ENTRY;
+    }
+    const JsonItem* removed_item_p = *link_pp;
+    *link_pp                       = removed_item_p->next_sibling;
+    _JsonObj_unindex_member(json_obj_p, parent_p, removed_item_p);
+    return ERR_ALL_GOOD;
+}
+
+Error obj_remove_value(JsonObj* obj, const char* key)
+{
+    if (obj == NULL)
+    {
+        return ERR_NULL;
+    }
+    return _JsonItem_remove(obj, &obj->root, key);
+}
+
+// Remove `key` from the object `item` is a member of. If the member removed is `item` itself, the
+// object is to be accessed through its parent from then on.
+Error remove_value(JsonItem* item, const char* key)
+{
+    if (item == NULL)
+    {
+        LOG_ERROR("Input item is NULL - key `%s`.", key);
+        return ERR_NULL;
+    }
+    return _JsonItem_remove(_JsonItem_get_obj(item), item->parent, key);
+}
+
+Error remove_array_value(JsonArray* json_array, size_t index)
+{
+    if (json_array == NULL)
+    {
+        LOG_ERROR("Input array is NULL");
+        return ERR_NULL;
+    }
+    if (index >= json_array->len)
+    {
+        LOG_ERROR("Index %zu out of boundaries.", index);
+        return ERR_OUT_OF_RANGE;
+    }
+    JsonItem* next_p;
+    if (index == 0)
+    {
+        next_p              = json_array->element->next_sibling;
+        json_array->element = next_p;
+    }
+    else
+    {
+        JsonItem* prev_p     = _JsonArray_at(json_array, index - 1);
+        next_p               = prev_p->next_sibling->next_sibling;
+        prev_p->next_sibling = next_p;
+    }
+    json_array->len--;
+    if (json_array->elements_pp != NULL)
+    {
+        memmove(
+            &json_array->elements_pp[index],
+            &json_array->elements_pp[index + 1],
+            (json_array->len - index) * sizeof(JsonItem*));
+    }
+    _JsonArray_renumber(next_p, index);
+    return ERR_ALL_GOOD;
+}
+
+#define SET_VALUE_c(suffix, value_token, in_type)                                            \
+    Error obj_set_##suffix(JsonObj* obj, const char* key, in_type in_value)                  \
+    {                                                                                        \
+        const JsonValue value = {.value_type = value_token, .suffix = in_value};             \
+        return obj ? _JsonItem_set(obj->root.next_sibling, key, &value) : ERR_NULL;          \
+    }                                                                                        \
+    Error set_##suffix(JsonItem* item, const char* key, in_type in_value)                    \
+    {                                                                                        \
+        const JsonValue value = {.value_type = value_token, .suffix = in_value};             \
+        return _JsonItem_set(item, key, &value);                                             \
+    }                                                                                        \
+    Error set_array_##suffix(JsonArray* json_array, size_t index, in_type in_value)          \
+    {                                                                                        \
+        const JsonValue value = {.value_type = value_token, .suffix = in_value};             \
+        return _JsonArray_set(json_array, index, &value);                                    \
+    }                                                                                        \
+    Error obj_insert_##suffix(JsonObj* obj, const char* key, in_type in_value)               \
+    {                                                                                        \
+        const JsonValue value = {.value_type = value_token, .suffix = in_value};             \
+        if (obj == NULL)                                                                     \
+        {                                                                                    \
+            return ERR_NULL;                                                                 \
+        }                                                                                    \
+        return _JsonItem_insert(obj, &obj->root, key, &value);                               \
+    }                                                                                        \
+    Error insert_##suffix(JsonItem* item, const char* key, in_type in_value)                 \
+    {                                                                                        \
+        const JsonValue value = {.value_type = value_token, .suffix = in_value};             \
+        if (item == NULL)                                                                    \
+        {                                                                                    \
+            LOG_ERROR("Input item is NULL - key `%s`.", key);                                \
+            return ERR_NULL;                                                                 \
+        }                                                                                    \
+        return _JsonItem_insert(_JsonItem_get_obj(item), item->parent, key, &value);         \
+    }                                                                                        \
+    Error obj_insert_in_##suffix(                                                            \
+        JsonObj* obj, const char* object_key, const char* key, in_type in_value)             \
+    {                                                                                        \
+        const JsonValue value = {.value_type = value_token, .suffix = in_value};             \
+        return obj ? _JsonItem_insert_in(obj->root.next_sibling, object_key, key, &value)    \
+                   : ERR_NULL;                                                               \
+    }                                                                                        \
+    Error insert_in_##suffix(                                                                \
+        JsonItem* item, const char* object_key, const char* key, in_type in_value)           \
+    {                                                                                        \
+        const JsonValue value = {.value_type = value_token, .suffix = in_value};             \
+        return _JsonItem_insert_in(item, object_key, key, &value);                           \
+    }                                                                                        \
+    Error insert_array_##suffix(JsonArray* json_array, size_t index, in_type in_value)       \
+    {                                                                                        \
+        const JsonValue value = {.value_type = value_token, .suffix = in_value};             \
+        return _JsonArray_insert(json_array, index, &value);                                 \
+    }
+
+// clang-format off
+SET_VALUE_c(value_cstr, VALUE_CSTR, const char*)
+SET_VALUE_c(value_lld, VALUE_LLD, lld_t)
+SET_VALUE_c(value_llu, VALUE_LLU, llu_t)
+SET_VALUE_c(value_double, VALUE_DOUBLE, double)
+SET_VALUE_c(value_bool, VALUE_BOOL, bool)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wextra-semi"
+; // ensure clang-format works when turned on again
+#pragma clang diagnostic pop
+// clang-format on
+
+#ifdef _TEST
+static char* load_file_alloc(char* filename)
+{
+    FILE* json_file = fopen(filename, "r");
+    if (json_file == NULL)
+    {
+        LOG_PERROR("Could not read file");
+    }
+    int c;
+    size_t chars_read = 0;
+    size_t size       = 4096;
+    char* ret_str     = my_memory_malloc(__FILENAME__, __LINE__, size);
+    if (ret_str == NULL)
+    {
+        LOG_PERROR("out of memory");
+        exit(1);
+    }
+    while ((c = fgetc(json_file)) != EOF)
+    {
+        if (chars_read >= size - 1)
+        {
+            /* time to make it bigger */
+            size    = (size_t)(size * 1.5);
+            ret_str = realloc(ret_str, size);
+            if (ret_str == NULL)
+            {
+                LOG_PERROR("out of memory");
+                exit(1);
+            }
+        }
+        ret_str[chars_read++] = c;
+    }
+    ret_str[chars_read++] = '\0';
+    fclose(json_file);
+    return ret_str;
+}
+
+static void _test_store_id(const JsonObj* json_obj_p, size_t index, void* context_p)
+{
+    llu_t* ids_p = context_p;
+    Json_get((JsonObj*)json_obj_p, "id", &ids_p[index]);
+}
+
+typedef struct
+{
+    size_t num_of_events;
+    size_t num_of_containers;
+    double close_sum;
+    bool is_close;
+    size_t stop_after;
+    char text[64];
+} SaxTestContext;
+
+static bool _test_sax_count(void* context_p)
+{
+    SaxTestContext* test_context_p = context_p;
+    test_context_p->num_of_containers++;
+    return ++test_context_p->num_of_events != test_context_p->stop_after;
+}
+
+static bool _test_sax_key(void* context_p, const char* key, size_t len)
+{
+    SaxTestContext* test_context_p = context_p;
+    test_context_p->is_close           = (len == 5) && (strcmp(key, "Close") == 0);
+    return ++test_context_p->num_of_events != test_context_p->stop_after;
+}
+
+static bool _test_sax_double(void* context_p, double value)
+{
+    SaxTestContext* test_context_p = context_p;
+    if (test_context_p->is_close)
+    {
+        test_context_p->close_sum += value;
+    }
+    return ++test_context_p->num_of_events != test_context_p->stop_after;
+}
+
+static bool _test_sax_cstr(void* context_p, const char* value, size_t len)
+{
+    SaxTestContext* test_context_p = context_p;
+    const size_t text_len          = strlen(test_context_p->text);
+    strncat(test_context_p->text, value, sizeof(test_context_p->text) - text_len - 1);
+    UNUSED(len);
+    return ++test_context_p->num_of_events != test_context_p->stop_after;
+}
+
+static bool _test_sax_llu(void* context_p, llu_t value)
+{
+    SaxTestContext* test_context_p = context_p;
+    UNUSED(value);
+    return ++test_context_p->num_of_events != test_context_p->stop_after;
+}
+
+static bool _test_sax_lld(void* context_p, lld_t value)
+{
+    SaxTestContext* test_context_p = context_p;
+    UNUSED(value);
+    return ++test_context_p->num_of_events != test_context_p->stop_after;
+}
+
+// Feed a document made of a string of `len` chars, with an escape sequence every 8 chars, in chunks
+// of 1000 bytes. Return the elapsed seconds, or a negative number if the string is not as expected.
+static double _test_feed_long_string(size_t len)
+{
+    __autodestroy_json_parser__ JsonParser parser;
+    __autofree_cstr__ char* json_cstr = my_memory_malloc(__FILE__, __LINE__, len + 16);
+    bool complete                     = false;
+    bool all_passed                   = true;
+    const char* value_cstr            = NULL;
+    char* curr_p                      = json_cstr + sprintf(json_cstr, "{\"s\": \"");
+    for (size_t i = 0; i < len / 8; i++)
+    {
+        curr_p += sprintf(curr_p, "abcdef\\n");
+    }
+    curr_p += sprintf(curr_p, "\"}");
+    const size_t json_len = (size_t)(curr_p - json_cstr);
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    JsonParser_new(&parser);
+    for (size_t offset = 0; offset < json_len; offset += 1000)
+    {
+        const size_t chunk_len = (json_len - offset < 1000) ? json_len - offset : 1000;
+        all_passed = all_passed && is_ok(JsonParser_feed(&parser, json_cstr + offset, chunk_len, &complete));
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (!all_passed || !complete || is_err(Json_get(&parser.json_obj, "s", &value_cstr))
+        || (strlen(value_cstr) != len / 8 * 7)
+        || (strncmp(value_cstr, "abcdef\nabcdef\n", 14) != 0))
+    {
+        return -1;
+    }
+    return (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+// Overwrite `size` bytes at `offset` in the file at `path`, returning whether it worked.
+static bool _test_overwrite(const char* path, long offset, const void* bytes_p, size_t size)
+{
+    FILE* file = fopen(path, "r+b");
+    if (file == NULL)
+    {
+        return false;
+    }
+    bool is_written = (fseek(file, offset, SEEK_SET) == 0) && (fwrite(bytes_p, size, 1, file) == 1);
+    return (fclose(file) == 0) && is_written;
+}
+
+// Total size of the chunks of `arena_p`.
+static size_t _test_arena_capacity(const JsonArena* arena_p)
+{
+    size_t capacity = 0;
+    for (const JsonArenaChunk* chunk_p = arena_p->chunk_p; chunk_p != NULL; chunk_p = chunk_p->prev_p)
+    {
+        capacity += chunk_p->capacity;
+    }
+    return capacity;
+}
+
+#define TEST_SHARED_NUM_OF_MEMBERS (64)
+
+// Look up the last element of the array nested in each member of the object shared by the threads
+// of the "Concurrent lookups" test, returning how many have the expected value.
+static void* _test_lookup_shared(void* json_obj_p)
+{
+    size_t num_of_found = 0;
+    for (size_t i = 0; i < TEST_SHARED_NUM_OF_MEMBERS; i++)
+    {
+        char key[16];
+        JsonItem* json_item;
+        JsonArray* json_array;
+        llu_t value_llu = 0;
+        snprintf(key, sizeof(key), "key_%zu", i);
+        if (is_ok(Json_get((JsonObj*)json_obj_p, key, &json_item))
+            && is_ok(Json_get(json_item, "array", &json_array))
+            && is_ok(Json_get(json_array, 31, &value_llu)) && (value_llu == i))
+        {
+            num_of_found++;
+        }
+    }
+    return (void*)num_of_found;
+}
+
+void test_class_json(void)
+{
+    PRINT_BANNER();
+    PRINT_TEST_TITLE("Validate tokens");
+    {
+        const char* invalid_json_cstr[] = {
+            "{[}]",
+            "{",
+            "}",
+            "[}",
+            "[",
+            "]",
+            "{]",
+            "{\"key\":[}]}",
+            "{\"key\" 1}",
+            "{\"key\":1,}",
+            "{\"key\":[1,]}",
+            "{\"key\":tru}",
+            "{\"key\":01}",
+            "{\"key\":1.}",
+            "{\"key\":\"unterminated}",
+            "{\"key\":1} trailing",
+        };
+        for (size_t i = 0; i < sizeof_array(invalid_json_cstr); i++)
+        {
+            JsonObj json_obj;
+            ASSERT_ERR(JsonObj_new(invalid_json_cstr[i], &json_obj), invalid_json_cstr[i]);
+        }
+        {
+            __autodestroy_json__ JsonObj json_obj;
+            const char* json_char_p = "{\"a\":[[],[[]],{},{\"b\":{}}]}";
+            ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Valid JSON");
+        }
+        {
+            __autodestroy_json__ JsonObj json_obj;
+            const char* value_cstr;
+            bool value_bool;
+            const char* json_char_p = "\r\n{ \"a\" :\t\"{[,:]}\" , \"b\": null ,\"c\":true }\n";
+            ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Valid JSON");
+            ASSERT_OK(Json_get(&json_obj, "a", &value_cstr), "Tokens inside a string ignored");
+            ASSERT_EQ(value_cstr, "{[,:]}", "String with tokens");
+            ASSERT(Json_get(&json_obj, "b", &value_bool) == ERR_TYPE_MISMATCH, "Null value found");
+            ASSERT_OK(Json_get(&json_obj, "c", &value_bool), "Value after null found");
+            ASSERT_EQ(value_bool, true, "Value after null correct");
+        }
+    }
+    PRINT_TEST_TITLE("Block classifiers");
+    {
+        char block[JSON_BLOCK_SIZE];
+        JsonBlockMasks expected_masks;
+        JsonBlockMasks masks;
+        for (size_t i = 0; i < JSON_BLOCK_SIZE; i++)
+        {
+            block[i] = "\"\\{ \x01\xff,\n"[i % 8];
+        }
+        _classify_block_scalar(block, &expected_masks);
+        ASSERT_EQ(expected_masks.quote, (llu_t)0x0101010101010101, "Quotes found");
+        ASSERT_EQ(expected_masks.backslash, (llu_t)0x0202020202020202, "Backslashes found");
+        ASSERT_EQ(expected_masks.structural, (llu_t)0x4444444444444444, "Structural chars found");
+        ASSERT_EQ(expected_masks.whitespace, (llu_t)0x8888888888888888, "Whitespace found");
+        ASSERT_EQ(expected_masks.control, (llu_t)0x9090909090909090, "Control chars found");
+#if defined(__x86_64__) || defined(__i386__)
+        if (__builtin_cpu_supports("sse4.2"))
+        {
+            _classify_block_sse42(block, &masks);
+            ASSERT(memcmp(&masks, &expected_masks, sizeof(masks)) == 0, "SSE4.2 matches scalar");
+        }
+        if (__builtin_cpu_supports("avx2"))
+        {
+            _classify_block_avx2(block, &masks);
+            ASSERT(memcmp(&masks, &expected_masks, sizeof(masks)) == 0, "AVX2 matches scalar");
+        }
+#endif /* __x86_64__ || __i386__ */
+        UNUSED(masks);
+    }
+    PRINT_TEST_TITLE("Strings and whitespace across blocks");
+    {
+        __autodestroy_json__ JsonObj json_obj;
+        const char* value_cstr;
+        llu_t value_llu;
+        const char* json_char_p = "{\"long\": \"0123456789012345678901234567890123456789012345678901234"
+                                  "567890123456789 \\\" 0123456789\","
+                                  "                                                                    "
+                                  "                                                \"next\": 1}";
+        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
+        ASSERT_OK(Json_get(&json_obj, "long", &value_cstr), "Long string found");
+        ASSERT_EQ(strlen(value_cstr), (size_t)83, "Long string has the expected length");
+        ASSERT_OK(Json_get(&json_obj, "next", &value_llu), "Value after long whitespace found");
+        ASSERT_EQ(value_llu, 1, "Value after long whitespace correct");
+    }
+    PRINT_TEST_TITLE("Empty object");
+    {
+        __autodestroy_json__ JsonObj json_obj;
+        JsonItem* json_item_p;
+        const char* json_char_p = "{}";
+        lld_t a;
+        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Empty JSON created");
+        ASSERT_ERR(Json_get(&json_obj, "missing key", &json_item_p), "Fix NULL on key");
+        ASSERT_ERR(Json_get(&json_obj, "missing key", &a), "Fix NULL on key");
+    }
+    PRINT_TEST_TITLE("Wrong object");
+    {
+        JsonObj json_obj;
+        const char* json_char_p = "{:}";
+        ASSERT_ERR(JsonObj_new(json_char_p, &json_obj), "Invalid JSON");
+        // This does not cause an error, even though the object was not created because of parsing errors.
+        JsonObj_destroy(&json_obj);
+    }
+    PRINT_TEST_TITLE("Empty nested object");
+    {
+        __autodestroy_json__ JsonObj json_obj;
+        const char* value_cstr;
+        const char* json_char_p = "{\"key\":{}}";
+        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Empty nested JSON");
+        ASSERT_ERR(Json_get(&json_obj, "key", &value_cstr), "Key found but value cannot be retrieved");
+    }
+    PRINT_TEST_TITLE("Key-value pair");
+    {
+        __autodestroy_json__ JsonObj json_obj;
+        const char* value_cstr;
+        const char* json_char_p = " {\"key\": \"value string\"}";
+        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
+        Json_get(&json_obj, "key", &value_cstr);
+        ASSERT_EQ("value string", value_cstr, "Key for root found with correct value STRING");
+        ASSERT_ERR(Json_get(&json_obj, "missing key", &value_cstr), "Missing key detected.");
+        ASSERT_EQ(value_cstr == NULL, true, "Returned null due to missing key.");
+    }
+    PRINT_TEST_TITLE("Sibling key-value pair");
+    {
+        __autodestroy_json__ JsonObj json_obj;
+        const char* value_cstr;
+        llu_t value_llu;
+        const char* json_char_p = " {\"key\": \"value string\", \"sibling\": 56}";
+        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
+        Json_get(&json_obj, "key", &value_cstr);
+        Json_get(&json_obj, "sibling", &value_llu);
+        ASSERT_EQ("value string", value_cstr, "Key for root value STRING");
+        ASSERT_EQ(56, value_llu, "Key for root found with correct value INT");
+    }
+    PRINT_TEST_TITLE("Simple array");
+    {
+        __autodestroy_json__ JsonObj json_obj;
+        const char* value_cstr;
+        llu_t value_llu;
+        JsonArray* json_array;
+        const char* json_char_p = " {\"key\": [\"array value\", 56]}";
+        printf("\n%s\n", json_char_p);
+        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
+        Json_get(&json_obj, "key", &json_array);
+        Json_get(json_array, 0, &value_cstr);
+        ASSERT_EQ("array value", value_cstr, "Array STRING element retrieved.");
+        Json_get(json_array, 1, &value_llu);
+        ASSERT_EQ(56, value_llu, "Array LLU element retrieved.");
+    }
+    PRINT_TEST_TITLE("Array of objects");
+    {
+        __autodestroy_json__ JsonObj json_obj;
+        JsonItem* json_item;
+        llu_t value_llu;
+        JsonArray* json_array;
+        const char* json_char_p = " {\"key\": [ {\"array key\": 56}]}";
+        printf("\n%s\n", json_char_p);
+        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
+        Json_get(&json_obj, "key", &json_array);
+        Json_get(json_array, 0, &json_item);
+        ASSERT_EQ(json_item->key_p, "array key", "Array STRING element retrieved.");
+        printf("%d\n", json_item->value.value_type);
+        Json_get(json_item, "array key", &value_llu);
+        ASSERT_EQ(value_llu, 56, "Value found an item that is also array element.");
+    }
+    PRINT_TEST_TITLE("object and array");
+    {
+        JsonObj json_obj;
+        JsonItem* json_item;
+        JsonArray* json_array;
+        const char* json_char_p = " {\"object\": {\"array\": [ {\"array key\": 56}]}}";
+        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
+        ASSERT_OK(Json_get(&json_obj, "object", &json_item), "Object retrieved");
+        ASSERT_OK(Json_get(json_item, "array", &json_array), "Array retrieved");
+        // Destroying multiple times is safe
+        JsonObj_destroy(&json_obj);
+        JsonObj_destroy(&json_obj);
+    }
+    PRINT_TEST_TITLE("test_json_array_1.json");
+    {
+        JsonObj json_obj;
+        JsonItem* json_item;
+        llu_t value_llu;
+        const char* value_cstr;
+        double value_double;
+        bool value_bool;
+        JsonArray* json_array;
+        __autofree_cstr__ char* json_cstr = load_file_alloc("test/assets/test_json_array_1.json");
+        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Json object created");
+        Json_get(&json_obj, "array_key", &json_array);
+        ASSERT_EQ(json_array != NULL, true, "Array found as root element.");
+        Json_get(json_array, 0, &json_item);
+        ASSERT_EQ(json_item != NULL, true, "First array element is an item.");
+        Json_get(json_item, "object 1", &value_llu);
+        ASSERT_EQ(value_llu, 56, "Value LLU found");
+        Json_get(json_array, 1, &json_item);
+        ASSERT_EQ(json_item != NULL, true, "Second array element is an item.");
+        Json_get(json_item, "object 2", &value_double);
+        ASSERT_EQ(value_double, 404.5f, "Value DOUBLE found");
+        Json_get(json_array, 2, &json_item);
+        Json_get(json_item, "object 3", &value_cstr);
+        ASSERT_EQ(value_cstr, "SOME STRING", "Array element STRING found.");
+        Json_get(json_array, 3, &value_llu);
+        ASSERT_EQ(value_llu, 32, "Array element INT found.");
+        Json_get(json_array, 4, &value_bool);
+        ASSERT_EQ(value_bool, false, "Array element BOOL found.");
+        JsonObj_destroy(&json_obj);
+    }
+    PRINT_TEST_TITLE("test_json_array_2.json");
+    {
+        __autofree_cstr__ char* json_cstr = load_file_alloc("test/assets/test_json_array_2.json");
+        __autodestroy_json__ JsonObj json_obj;
+        JsonItem* json_item;
+        JsonArray* json_array;
+        JsonArray* json_array_2;
+        llu_t value_llu;
+        const char* value_cstr;
+        double value_double;
+        bool value_bool;
+        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Json object created");
+        Json_get(&json_obj, "array_key", &json_array);
+        ASSERT_EQ(json_array != NULL, true, "Array found as root element.");
+        Json_get(json_array, 0, &json_item);
+        ASSERT_EQ(json_item != NULL, true, "First array element is an item.");
+        Json_get(json_item, "inner array 1", &json_array_2);
+        Json_get(json_array_2, 0, &value_llu);
+        ASSERT_EQ(value_llu, 12314, "Value LLU found");
+        Json_get(json_array_2, 1, &value_double);
+        ASSERT_EQ(value_double, -32.4, "Value DOUBLE found");
+        Json_get(json_array_2, 2, &value_bool);
+        ASSERT_EQ(value_bool, true, "Value TRUE found");
+        Json_get(json_array, 1, &json_item);
+        ASSERT_EQ(json_item != NULL, true, "Second array element is an item.");
+        Json_get(json_item, "inner array 2", &json_array_2);
+        Json_get(json_array_2, 0, &value_double);
+        ASSERT_EQ(value_double, 1.4, "Value DOUBLE found");
+        Json_get(json_array_2, 1, &value_cstr);
+        ASSERT_EQ(value_cstr, "hello", "Value STRING found");
+        Json_get(json_array_2, 2, &value_bool);
+        ASSERT_EQ(value_bool, false, "Value FALSE found");
+    }
+    PRINT_TEST_TITLE("test_json_array_3.json");
+    {
+        __autodestroy_json__ JsonObj json_obj;
+        JsonItem* json_item;
+        const char* value_cstr;
+        llu_t value_llu;
+        JsonArray* json_array;
+        __autofree_cstr__ char* json_cstr = load_file_alloc("test/assets/test_json_array_3.json");
+        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Json object created");
+        ASSERT(Json_get(&json_obj, "Snapshot", &json_item) == ERR_ALL_GOOD, "Ok");
+        ASSERT(Json_get(json_item, "Value", &value_llu) == ERR_ALL_GOOD, "Ok");
+        ASSERT(Json_get(json_item, "Data", &json_array) == ERR_ALL_GOOD, "Ok");
+        ASSERT(Json_get(json_array, 0, &json_item) == ERR_ALL_GOOD, "Ok");
+        ASSERT(Json_get(json_item, "Time", &value_cstr) == ERR_ALL_GOOD, "Ok");
+        ASSERT_EQ(value_cstr, "2021-07-23T08:09:00.000000Z", "Time correct.");
+    }
+    PRINT_TEST_TITLE("test_json_array_4.json");
+    {
+        JsonObj json_obj;
+        llu_t value_llu;
+        JsonArray* json_array;
+        bool value_bool;
+        __autofree_cstr__ char* json_cstr = load_file_alloc("test/assets/test_json_array_4.json");
+        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Json object created");
+        ASSERT_OK(Json_get(&json_obj, "array_key1", &json_array), "Ok");
+        ASSERT_OK(Json_get(json_array, 0, &value_llu), "Ok");
+        ASSERT_EQ(value_llu, 32, "Ok");
+        ASSERT_OK(Json_get(json_array, 1, &value_bool), "Ok");
+        ASSERT_EQ(value_bool, false, "Ok");
+        ASSERT_OK(Json_get(&json_obj, "array_key2", &json_array), "Ok");
+        ASSERT_OK(Json_get(json_array, 0, &value_llu), "Ok");
+        ASSERT_EQ(value_llu, 33, "Ok");
+        ASSERT_OK(Json_get(json_array, 1, &value_bool), "Ok");
+        ASSERT_EQ(value_bool, true, "Ok");
+        ASSERT_OK(Json_get(&json_obj, "key", &value_llu), "Ok");
+        ASSERT_EQ(value_llu, 34, "Ok");
+        JsonObj_destroy(&json_obj);
+    }
+    PRINT_TEST_TITLE("Testing test/assets/test_json.json");
+    {
+        __autodestroy_json__ JsonObj json_obj;
+        JsonItem* json_item;
+        const char* value_cstr;
+        llu_t value_llu;
+        double value_double;
+        bool value_bool;
+        JsonArray* json_array;
+        __autofree_cstr__ char* json_cstr = load_file_alloc("test/assets/test_json.json");
+        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Json object created");
+        Json_get(&json_obj, "text_key", &value_cstr);
+        ASSERT_EQ("text_value", value_cstr, "String*value found in first item");
+
+        Json_get(&json_obj, "text_sibling", &value_cstr);
+        ASSERT_EQ("sibling_value", value_cstr, "String*value found in sibling");
+
+        Json_get(&json_obj, "nested_1", &json_item);
+        ASSERT_EQ(json_item->key_p, "object_1.1", "Found nested object key");
+
+        Json_get(json_item, "object_1.1", &value_cstr);
+        ASSERT_EQ(value_cstr, "item_1.1", "Found nested object value");
+        Json_get(json_item, "object_1.2", &value_cstr);
+        ASSERT_EQ(value_cstr, "item_1.2", "Found nested sibling object value");
+        ASSERT(
+            Json_get(json_item, "object_32", &value_cstr) == ERR_JSON_MISSING_ENTRY,
+            "Object not found");
+        ASSERT(value_cstr == NULL, "Null returned.");
+
+        Json_get(&json_obj, "nested_2", &json_item);
+        Json_get(json_item, "object_2.1", &value_cstr);
+        ASSERT_EQ(value_cstr, "item_2.1", "Found nested object value");
+        Json_get(json_item, "object_2.2", &json_item);
+        ASSERT_EQ(json_item->key_p, "item_2.2", "Found nested object key");
+        Json_get(json_item, "item_2.2", &value_cstr);
+        ASSERT_EQ(value_cstr, "value_2.2.1", "Found nested sibling object value");
+
+        PRINT_TEST_TITLE("Test integer");
+        Json_get(&json_obj, "test_integer", &value_llu);
+        ASSERT_EQ(value_llu, 435234, "Integer found and read correctly");
+
+        PRINT_TEST_TITLE("Test double");
+        Json_get(&json_obj, "test_double", &value_double);
+        ASSERT_EQ(value_double, 435.234, "Float found and read correctly");
+
+        PRINT_TEST_TITLE("Test bool true");
+        Json_get(&json_obj, "test_bool_true", &value_bool);
+        ASSERT_EQ(value_bool, true, "Boolean found and read correctly");
+
+        PRINT_TEST_TITLE("Test bool false");
+        Json_get(&json_obj, "test_bool_false", &value_bool);
+        ASSERT_EQ(value_bool, false, "Boolean found and read correctly");
+
+        Json_get(&json_obj, "test_array", &json_array);
+        Json_get(json_array, 0, &value_llu);
+        ASSERT_EQ(value_llu, 14352, "Array element of type INT read correctly");
+        Json_get(json_array, 1, &value_double);
+        ASSERT_EQ(value_double, 2.15, "Array element of type DOUBLE read correctly");
+        Json_get(json_array, 2, &value_cstr);
+        ASSERT_EQ(value_cstr, "string_element", "Array element of type C-string read correctly");
+    }
+    PRINT_TEST_TITLE("Invalid JSON string - empty");
+    {
+        JsonObj json_obj;
+        char* json_cstr = "";
+        ASSERT(JsonObj_new(json_cstr, &json_obj) == ERR_EMPTY_STRING, "Empty JSON fails to initialize.");
+    }
+    PRINT_TEST_TITLE("Invalid JSON string - string not starting with '{'");
+    { // TODO: crate token analyzer and add TC's.
+        JsonObj json_obj;
+        char* json_cstr = "This is not a JSON file";
+        ASSERT(JsonObj_new(json_cstr, &json_obj) == ERR_JSON_INVALID, "Invalid JSON fails to initialize.");
+    }
+    PRINT_TEST_TITLE("Fixed memory leak");
+    {
+        JsonArray* json_array;
+        const char* value_cstr;
+        const char* json_char_p = "{\"request\":[\"Required parameter is missing\"]}";
+        __autodestroy_json__ JsonObj json_with_vector_obj;
+        ASSERT(is_ok(JsonObj_new(json_char_p, &json_with_vector_obj)), "Json object created");
+        Json_get(&json_with_vector_obj, "request", &json_array);
+        Json_get(json_array, 0, &value_cstr);
+        ASSERT_EQ(value_cstr, "Required parameter is missing", "");
+    }
+    PRINT_TEST_TITLE("Data conversion");
+    {
+        __autodestroy_json__ JsonObj json_obj;
+        llu_t value_llu;
+        lld_t value_lld;
+        __autofree_cstr__ char* json_cstr = load_file_alloc("test/assets/test_json_numbers.json");
+        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Json object created");
+        Json_get(&json_obj, "value_positive_lld", &value_llu);
+        ASSERT_EQ((llu_t)23, value_llu, "Conversion from INT to LLU successfull");
+        Json_get(&json_obj, "value_small_llu", &value_lld);
+        ASSERT_EQ((lld_t)43, value_lld, "Conversion from LLU to INT successfull");
+        ASSERT(Json_get(&json_obj, "value_negative_lld", &value_llu) == ERR_INVALID, "Conversion from negative INT to LLU failed");
+        ASSERT(Json_get(&json_obj, "value_large_llu", &value_lld) == ERR_INVALID, "Conversion from large LLU to INT failed");
+    }
+    PRINT_TEST_TITLE("Items allocated from the arena");
+    {
+        __autodestroy_json__ JsonObj json_obj;
+        JsonArray* json_array;
+        llu_t value_llu;
+        const size_t num_of_elements      = 10000;
+        __autofree_cstr__ char* json_cstr = my_memory_malloc(__FILE__, __LINE__, 8 * num_of_elements);
+        char* curr_p                      = json_cstr + sprintf(json_cstr, "{\"array\":[0");
+        for (size_t i = 1; i < num_of_elements; i++)
+        {
+            curr_p += sprintf(curr_p, ",%zu", i);
+        }
+        sprintf(curr_p, "]}");
+        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Json object created");
+        ASSERT_OK(Json_get(&json_obj, "array", &json_array), "Array found");
+        ASSERT_OK(Json_get(json_array, num_of_elements - 1, &value_llu), "Last element found");
+        ASSERT_EQ(value_llu, num_of_elements - 1, "Last element correct");
+        size_t num_of_chunks = 0;
+        for (JsonArenaChunk* chunk_p = json_obj.arena.chunk_p; chunk_p; chunk_p = chunk_p->prev_p)
+        {
+            num_of_chunks++;
+        }
+        ASSERT(num_of_chunks < 10, "A handful of chunks holds all the items");
+    }
+    PRINT_TEST_TITLE("Hashed key index");
+    {
+        __autodestroy_json__ JsonObj json_obj;
+        JsonItem* json_item;
+        llu_t value_llu;
+        const size_t num_of_members       = 100;
+        __autofree_cstr__ char* json_cstr = my_memory_malloc(__FILE__, __LINE__, 32 * num_of_members);
+        char* curr_p                      = json_cstr + sprintf(json_cstr, "{\"key_0\":0");
+        for (size_t i = 1; i < num_of_members; i++)
+        {
+            curr_p += sprintf(curr_p, ",\"key_%zu\":%zu", i, i);
+        }
+        sprintf(curr_p, ",\"key_5\":1234,\"nested\":{\"key_5\":55}}");
+        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Json object created");
+        ASSERT_OK(Json_get(&json_obj, "key_99", &value_llu), "Last key found");
+        ASSERT_EQ(value_llu, 99, "Last key has the correct value");
+        ASSERT(json_obj.key_index_p != NULL, "Index built after a long search");
+        bool all_found = true;
+        for (size_t i = 0; i < num_of_members; i++)
+        {
+            char key[16];
+            snprintf(key, sizeof(key), "key_%zu", i);
+            all_found = all_found && is_ok(Json_get(&json_obj, key, &value_llu)) && (value_llu == i);
+        }
+        ASSERT(all_found, "All the keys found through the index");
+        ASSERT_OK(Json_get(&json_obj, "key_5", &value_llu), "Duplicate key found");
+        ASSERT_EQ(value_llu, 5, "First duplicate wins");
+        ASSERT_ERR(Json_get(&json_obj, "key_100", &value_llu), "Missing key detected");
+        ASSERT_OK(Json_get(&json_obj, "nested", &json_item), "Nested object found");
+        ASSERT_OK(Json_get(json_item, "key_5", &value_llu), "Same key in nested object found");
+        ASSERT_EQ(value_llu, 55, "Nested object not mixed up with its parent");
+        ASSERT_OK(Json_get(json_obj.root.next_sibling->next_sibling, "key_7", &value_llu), "Found from sibling");
+        ASSERT_EQ(value_llu, 7, "Search from a sibling correct");
+        ASSERT_ERR(Json_get(json_obj.root.next_sibling->next_sibling, "key_0", &value_llu), "Previous sibling not found");
+        const JsonKeyIndex* key_index_p = json_obj.key_index_p;
+        ASSERT_OK(Json_remove(&json_obj, "key_5"), "Indexed duplicate key removed");
+        ASSERT_OK(Json_get(&json_obj, "key_5", &value_llu), "Next duplicate found");
+        ASSERT_EQ(value_llu, 1234, "Next duplicate takes over");
+        ASSERT_OK(Json_insert(&json_obj, "key_100", 100), "Key inserted into an indexed object");
+        ASSERT(json_obj.key_index_p == key_index_p, "Index kept on insertion");
+        ASSERT_OK(Json_get(&json_obj, "key_100", &value_llu), "Inserted key found");
+        ASSERT_EQ(value_llu, 100, "Inserted key correct");
+        ASSERT_OK(Json_remove(&json_obj, "key_5"), "Last duplicate removed");
+        ASSERT_ERR(Json_get(&json_obj, "key_5", &value_llu), "Removed key not found");
+        ASSERT_OK(Json_get(&json_obj, "key_6", &value_llu), "Key after a removed one found");
+        ASSERT_EQ(value_llu, 6, "Key after a removed one correct");
+    }
+    PRINT_TEST_TITLE("Array length, indexed access and cursor");
+    {
+        __autodestroy_json__ JsonObj json_obj;
+        JsonArray* json_array;
+        JsonArray* inner_array;
+        JsonItem* json_item;
+        const JsonValue* json_value_p;
+        llu_t value_llu;
+        const char* value_cstr;
+        const size_t num_of_elements      = 1000;
+        __autofree_cstr__ char* json_cstr = my_memory_malloc(__FILE__, __LINE__, 8 * num_of_elements);
+        char* curr_p                      = json_cstr + sprintf(json_cstr, "{\"array\":[0");
+        for (size_t i = 1; i < num_of_elements; i++)
+        {
+            curr_p += sprintf(curr_p, ",%zu", i);
+        }
+        sprintf(curr_p, "],\"empty\":[],\"nested\":[[\"a\",\"b\"],[],{\"k\":1}]}");
+        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Json object created");
+        ASSERT_OK(Json_get(&json_obj, "array", &json_array), "Array found");
+        ASSERT_EQ(JsonArray_len(json_array), num_of_elements, "Array length correct");
+        bool all_found = true;
+        for (size_t i = 0; i < num_of_elements; i++)
+        {
+            all_found = all_found && is_ok(Json_get(json_array, i, &value_llu)) && (value_llu == i);
+        }
+        ASSERT(all_found, "All the elements found by index");
+        ASSERT(Json_get(json_array, num_of_elements, &value_llu) == ERR_NULL, "Out of boundaries");
+        JsonArrayCursor cursor = JsonArray_cursor(json_array);
+        size_t num_of_visited  = 0;
+        while (JsonArrayCursor_next(&cursor, &json_value_p))
+        {
+            all_found = all_found && (json_value_p->value_type == VALUE_LLU)
+                        && (json_value_p->value_llu == num_of_visited);
+            num_of_visited++;
+        }
+        ASSERT(all_found, "All the elements visited in order");
+        ASSERT_EQ(num_of_visited, num_of_elements, "Cursor visited all the elements");
+
+        ASSERT_OK(Json_get(&json_obj, "empty", &json_array), "Empty array found");
+        ASSERT_EQ(JsonArray_len(json_array), (size_t)0, "Empty array has no elements");
+        ASSERT_ERR(Json_get(json_array, 0, &value_llu), "Empty array has no first element");
+        cursor = JsonArray_cursor(json_array);
+        ASSERT_EQ(JsonArrayCursor_next(&cursor, &json_value_p), false, "Nothing to visit");
+
+        ASSERT_OK(Json_get(&json_obj, "nested", &json_array), "Nested arrays found");
+        ASSERT_EQ(JsonArray_len(json_array), (size_t)3, "Outer array length correct");
+        ASSERT_OK(Json_get(json_array, 0, &inner_array), "Inner array found");
+        ASSERT_EQ(JsonArray_len(inner_array), (size_t)2, "Inner array length correct");
+        ASSERT_OK(Json_get(inner_array, 1, &value_cstr), "Inner array element found");
+        ASSERT_EQ(value_cstr, "b", "Inner array element correct");
+        ASSERT_OK(Json_get(json_array, 1, &inner_array), "Empty inner array found");
+        ASSERT_EQ(JsonArray_len(inner_array), (size_t)0, "Empty inner array length correct");
+        ASSERT_OK(Json_get(json_array, 2, &json_item), "Object after arrays found");
+        ASSERT_OK(Json_get(json_item, "k", &value_llu), "Value in object after arrays found");
+        ASSERT_EQ(value_llu, 1, "Value in object after arrays correct");
+
+        ASSERT_OK(Json_get(&json_obj, "array", &json_array), "Array found again");
+        const size_t arena_capacity = _test_arena_capacity(&json_obj.arena);
+        all_found                   = true;
+        for (size_t i = 0; i < num_of_elements; i++)
+        {
+            all_found = all_found && is_ok(Json_insert(json_array, i, (llu_t)i))
+                        && is_ok(Json_get(json_array, JsonArray_len(json_array) - 1, &value_llu))
+                        && (value_llu == num_of_elements - 1);
+        }
+        ASSERT(all_found, "Elements found by index between insertions");
+        ASSERT(
+            _test_arena_capacity(&json_obj.arena) - arena_capacity < 8 * num_of_elements * sizeof(JsonItem),
+            "Offset table not rebuilt on insertion");
+        ASSERT_OK(Json_remove(json_array, 0), "First element removed");
+        ASSERT_OK(Json_get(json_array, num_of_elements - 1, &value_llu), "Element after removal found");
+        ASSERT_EQ(value_llu, 0, "Offset table updated on removal");
+    }
+    PRINT_TEST_TITLE("Lazy parsing");
+    {
+        __autodestroy_json__ JsonObj json_obj;
+        JsonItem* json_item;
+        JsonArray* json_array;
+        const JsonValue* json_value_p;
+        const char* value_cstr;
+        llu_t value_llu;
+        const char* json_cstr = "{\"id\": 7, \"blob\": {\"text\": \"}]\\\"[{\", \"list\": [{\"a\": 1}, "
+                                "[2, [3]], {}]}, \"name\": \"lazy\", \"big\": [18446744073709551616]}";
+        ASSERT_OK(JsonObj_new_lazy(json_cstr, &json_obj), "Lazy Json object created");
+        ASSERT_EQ(json_obj.root.next_sibling->next_sibling->value.value_type, VALUE_LAZY, "Blob not built");
+        ASSERT_OK(Json_get(&json_obj, "id", &value_llu), "Top-level number found");
+        ASSERT_EQ(value_llu, 7, "Top-level number correct");
+        ASSERT_OK(Json_get(&json_obj, "name", &value_cstr), "Top-level string after blob found");
+        ASSERT_EQ(value_cstr, "lazy", "Top-level string after blob correct");
+        ASSERT_OK(Json_get(&json_obj, "blob", &json_item), "Blob built on access");
+        ASSERT_OK(Json_get(json_item, "text", &value_cstr), "String with brackets found");
+        ASSERT_EQ(value_cstr, "}]\"[{", "String with brackets correct");
+        ASSERT_EQ(json_item->next_sibling->value.value_type, VALUE_LAZY, "Nested array not built");
+        ASSERT_OK(Json_get(json_item, "list", &json_array), "Nested array built on access");
+        ASSERT_EQ(JsonArray_len(json_array), (size_t)3, "Nested array length correct");
+        ASSERT_OK(Json_get(json_array, 0, &json_item), "Object in nested array found");
+        ASSERT_OK(Json_get(json_item, "a", &value_llu), "Value in nested object found");
+        ASSERT_EQ(value_llu, 1, "Value in nested object correct");
+        JsonArrayCursor cursor = JsonArray_cursor(json_array);
+        ASSERT(JsonArrayCursor_next(&cursor, &json_value_p), "First element visited");
+        ASSERT(JsonArrayCursor_next(&cursor, &json_value_p), "Second element visited");
+        ASSERT_EQ(json_value_p->value_type, VALUE_ARRAY, "Cursor builds lazy elements");
+        ASSERT_EQ(JsonArray_len(json_value_p->value_array_p), (size_t)2, "Lazy element correct");
+        ASSERT(JsonArrayCursor_next(&cursor, &json_value_p), "Third element visited");
+        ASSERT_EQ(json_value_p->value_type, VALUE_ITEM, "Empty object built");
+        ASSERT_ERR(Json_get(&json_obj, "big", &json_array), "Number out of range detected on access");
+
+        JsonObj invalid_obj;
+        ASSERT_ERR(JsonObj_new_lazy("{\"a\": 1, \"b\": {\"c\": [1, 2,]}}", &invalid_obj), "Nested error detected");
+        JsonObj_destroy(&invalid_obj);
+        ASSERT_ERR(JsonObj_new_lazy("{\"a\": {\"b\": [}}", &invalid_obj), "Mismatched brackets detected");
+        JsonObj_destroy(&invalid_obj);
+    }
+    PRINT_TEST_TITLE("Top-level arrays");
+    {
+        __autodestroy_json__ JsonObj json_obj;
+        __autodestroy_json__ JsonObj lazy_obj;
+        JsonArray* json_array;
+        JsonItem* json_item;
+        llu_t value_llu;
+        const char* value_cstr;
+        const char* json_cstr = " [{\"id\": 0}, \"text\", [1, 2], {\"id\": 3}] ";
+        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Top-level array parsed");
+        ASSERT_OK(JsonObj_get_array(&json_obj, &json_array), "Top-level array found");
+        ASSERT_EQ(JsonArray_len(json_array), (size_t)4, "Top-level array length correct");
+        ASSERT_OK(Json_get(json_array, 1, &value_cstr), "String in top-level array found");
+        ASSERT_EQ(value_cstr, "text", "String in top-level array correct");
+        ASSERT_OK(Json_get(json_array, 3, &json_item), "Object in top-level array found");
+        ASSERT_OK(Json_get(json_item, "id", &value_llu), "Value in top-level array found");
+        ASSERT_EQ(value_llu, 3, "Value in top-level array correct");
+        ASSERT(Json_get(&json_obj, "id", &value_llu) == ERR_NULL, "No keys in a top-level array");
+        ASSERT_OK(JsonObj_new_lazy(json_cstr, &lazy_obj), "Top-level array parsed lazily");
+        ASSERT_OK(JsonObj_get_array(&lazy_obj, &json_array), "Lazy top-level array found");
+        ASSERT_OK(Json_get(json_array, 0, &json_item), "Lazy object in top-level array found");
+        ASSERT_OK(Json_get(json_item, "id", &value_llu), "Value in lazy object found");
+        ASSERT_EQ(value_llu, 0, "Value in lazy object correct");
+
+        __autodestroy_json__ JsonObj empty_obj;
+        ASSERT_OK(JsonObj_new("[ ]", &empty_obj), "Empty top-level array parsed");
+        ASSERT_OK(JsonObj_get_array(&empty_obj, &json_array), "Empty top-level array found");
+        ASSERT_EQ(JsonArray_len(json_array), (size_t)0, "Empty top-level array length correct");
+        ASSERT(JsonObj_get_array(&json_obj, &json_array) == ERR_ALL_GOOD, "Array kept");
+        __autodestroy_json__ JsonObj object_obj;
+        ASSERT_OK(JsonObj_new("{\"a\": 1}", &object_obj), "Top-level object parsed");
+        ASSERT(JsonObj_get_array(&object_obj, &json_array) == ERR_TYPE_MISMATCH, "Not an array");
+    }
+    PRINT_TEST_TITLE("Parallel parsing");
+    {
+        const size_t num_of_elements        = 10000;
+        __autofree_cstr__ char* json_cstr   = my_memory_malloc(__FILE__, __LINE__, 64 * num_of_elements);
+        __autofree_cstr__ char* ndjson_cstr = my_memory_malloc(__FILE__, __LINE__, 64 * num_of_elements);
+        char* curr_p                        = json_cstr + sprintf(json_cstr, "[");
+        char* ndjson_curr_p                 = ndjson_cstr;
+        for (size_t i = 0; i < num_of_elements; i++)
+        {
+            curr_p += sprintf(curr_p, "%s{\"id\": %zu, \"s\": \"],[{\\\"\"}", i ? ", " : "", i);
+            ndjson_curr_p += sprintf(ndjson_curr_p, "{\"id\": %zu, \"a\": [1, {}]}\n%s", i, (i % 7) ? "" : "\n");
+        }
+        sprintf(curr_p, "]\n");
+
+        __autodestroy_json__ JsonObj json_obj;
+        JsonArray* json_array;
         JsonItem* json_item;
         llu_t value_llu;
+        ASSERT_OK(JsonObj_new_parallel(json_cstr, 4, &json_obj), "Array parsed on 4 threads");
+        ASSERT_OK(JsonObj_get_array(&json_obj, &json_array), "Array parsed in parallel found");
+        ASSERT_EQ(JsonArray_len(json_array), num_of_elements, "Array parsed in parallel length correct");
+        bool all_found         = true;
+        JsonArrayCursor cursor = JsonArray_cursor(json_array);
+        const JsonValue* json_value_p;
+        for (size_t i = 0; JsonArrayCursor_next(&cursor, &json_value_p); i++)
+        {
+            all_found = all_found && is_ok(Json_get(json_value_p->value_child_p, "id", &value_llu))
+                        && (value_llu == i);
+        }
+        ASSERT(all_found, "Elements parsed in parallel linked in order");
+        ASSERT_OK(Json_get(json_array, num_of_elements - 1, &json_item), "Last element found");
+        ASSERT_EQ(json_item->parent->index, num_of_elements - 1, "Last element index correct");
+
+        // Records are passed with their line number, which blank lines make larger than their count.
+        const size_t ids_size     = 2 * num_of_elements * sizeof(llu_t);
+        llu_t* ids_p              = my_memory_malloc(__FILE__, __LINE__, ids_size);
+        memset(ids_p, 0xff, ids_size);
+        ASSERT_OK(
+            JsonObj_for_each_parallel(json_cstr, JSON_SPLIT_ARRAY, 3, _test_store_id, ids_p),
+            "Callback called for each element");
+        all_found = true;
+        for (size_t i = 0; i < num_of_elements; i++)
+        {
+            all_found = all_found && (ids_p[i] == i);
+        }
+        ASSERT(all_found, "Each element passed to the callback");
+        memset(ids_p, 0xff, ids_size);
+        ASSERT_OK(
+            JsonObj_for_each_parallel(ndjson_cstr, JSON_SPLIT_LINES, 0, _test_store_id, ids_p),
+            "Callback called for each record");
+        size_t num_of_records = 0;
+        for (size_t i = 0; i < 2 * num_of_elements; i++)
+        {
+            num_of_records += (ids_p[i] != (llu_t)-1);
+        }
+        ASSERT_EQ(num_of_records, num_of_elements, "Each record passed to the callback");
+
+        const char* invalid_json_cstr[] = {
+            "[1,,2]",
+            "[1, 2",
+            "[{\"a\": 1]}",
+            "[{]}",
+            "[1, 2] 3",
+            "[1, 2,]",
+            "[\"unterminated]",
+        };
+        for (size_t i = 0; i < sizeof_array(invalid_json_cstr); i++)
+        {
+            JsonObj invalid_obj;
+            ASSERT_ERR(JsonObj_new_parallel(invalid_json_cstr[i], 2, &invalid_obj), invalid_json_cstr[i]);
+        }
+        ASSERT_ERR(
+            JsonObj_for_each_parallel("{\"id\": 1}\n{\"id\": }\n", JSON_SPLIT_LINES, 2, _test_store_id, ids_p),
+            "Invalid record reported");
+        my_memory_free(ids_p);
+        __autodestroy_json__ JsonObj small_obj;
+        ASSERT_OK(JsonObj_new_parallel("[{\"id\": 5}]", 8, &small_obj), "More threads than elements");
+        ASSERT_OK(JsonObj_get_array(&small_obj, &json_array), "Single element array found");
+        ASSERT_EQ(JsonArray_len(json_array), (size_t)1, "Single element array length correct");
+        __autodestroy_json__ JsonObj many_obj;
+        ASSERT_OK(JsonObj_new_parallel("[1, 2, 3]", SIZE_MAX, &many_obj), "Threads capped to the elements");
+        ASSERT_OK(JsonObj_get_array(&many_obj, &json_array), "Array parsed on capped threads found");
+        ASSERT_EQ(JsonArray_len(json_array), (size_t)3, "Array parsed on capped threads length correct");
+
+        // As deep as allowed, then one level more: the elements of the array start one level down.
+        __autofree_cstr__ char* deep_cstr = my_memory_malloc(__FILE__, __LINE__, 2 * JSON_MAX_DEPTH + 3);
+        memset(deep_cstr, '[', JSON_MAX_DEPTH);
+        memset(deep_cstr + JSON_MAX_DEPTH, ']', JSON_MAX_DEPTH);
+        deep_cstr[2 * JSON_MAX_DEPTH] = '\0';
+        __autodestroy_json__ JsonObj deep_obj;
+        ASSERT_OK(JsonObj_new_parallel(deep_cstr, 2, &deep_obj), "Deepest array parsed on threads");
+        memset(deep_cstr, '[', JSON_MAX_DEPTH + 1);
+        memset(deep_cstr + JSON_MAX_DEPTH + 1, ']', JSON_MAX_DEPTH + 1);
+        deep_cstr[2 * JSON_MAX_DEPTH + 2] = '\0';
+        JsonObj too_deep_obj;
+        ASSERT_ERR(JsonObj_new(deep_cstr, &too_deep_obj), "Too deep array rejected");
+        ASSERT_ERR(JsonObj_new_parallel(deep_cstr, 2, &too_deep_obj), "Too deep array rejected on threads");
+    }
+    PRINT_TEST_TITLE("Incremental parsing");
+    {
+        const size_t num_of_elements      = 1000;
+        __autofree_cstr__ char* json_cstr = my_memory_malloc(__FILE__, __LINE__, 16 * num_of_elements + 256);
+        char* curr_p                      = json_cstr
+                         + sprintf(
+                             json_cstr,
+                             "{\"key\": \"va\\\"lue\", \"num\": -12.5e1, \"big\": 1234567890, \"flag\": true,"
+                             " \"none\": null, \"nested\": {\"a\": {\"b\": \"c\"}}, \"arr\": [\"s0\"");
+        for (size_t i = 1; i < num_of_elements; i++)
+        {
+            curr_p += sprintf(curr_p, ", \"s%zu\"", i);
+        }
+        sprintf(curr_p, "]}");
+        const size_t json_len     = strlen(json_cstr);
+        const size_t chunk_lens[] = {1, 3, 7, 64, 1000, json_len};
+        for (size_t c = 0; c < sizeof_array(chunk_lens); c++)
+        {
+            __autodestroy_json_parser__ JsonParser parser;
+            bool complete   = false;
+            bool early      = false;
+            bool all_passed = true;
+            ASSERT_OK(JsonParser_new(&parser), "Parser created");
+            for (size_t offset = 0; offset < json_len; offset += chunk_lens[c])
+            {
+                const size_t remaining = json_len - offset;
+                const size_t chunk_len = (chunk_lens[c] < remaining) ? chunk_lens[c] : remaining;
+                early                  = early || complete;
+                all_passed = all_passed && is_ok(JsonParser_feed(&parser, json_cstr + offset, chunk_len, &complete));
+            }
+            ASSERT(all_passed && !early, "Chunks accepted");
+            ASSERT(complete, "Document complete after the last chunk");
+            JsonItem* json_item;
+            JsonArray* json_array;
+            const char* value_cstr;
+            double value_double;
+            llu_t value_llu;
+            bool value_bool;
+            ASSERT_OK(Json_get(&parser.json_obj, "key", &value_cstr), "String with escaped quote found");
+            ASSERT_EQ(value_cstr, "va\"lue", "String with escaped quote correct");
+            ASSERT_OK(Json_get(&parser.json_obj, "num", &value_double), "Number with exponent found");
+            ASSERT_EQ(value_double, -125.0, "Number with exponent correct");
+            ASSERT_OK(Json_get(&parser.json_obj, "big", &value_llu), "Number split across chunks found");
+            ASSERT_EQ(value_llu, 1234567890, "Number split across chunks correct");
+            ASSERT_OK(Json_get(&parser.json_obj, "flag", &value_bool), "Literal split across chunks found");
+            ASSERT_EQ(value_bool, true, "Literal split across chunks correct");
+            ASSERT_OK(Json_get(&parser.json_obj, "nested", &json_item), "Nested object found");
+            ASSERT_OK(Json_get(json_item, "a", &json_item), "Inner object found");
+            ASSERT_OK(Json_get(json_item, "b", &value_cstr), "Value in inner object found");
+            ASSERT_EQ(value_cstr, "c", "Value in inner object correct");
+            ASSERT_OK(Json_get(&parser.json_obj, "arr", &json_array), "Array moved with the buffer found");
+            ASSERT_EQ(JsonArray_len(json_array), num_of_elements, "Array moved with the buffer length correct");
+            ASSERT_OK(Json_get(json_array, num_of_elements - 1, &value_cstr), "Last element found");
+            ASSERT_EQ(value_cstr, "s999", "Last element correct");
+            ASSERT_OK(JsonParser_feed(&parser, " \r\n", 3, &complete), "Whitespace after the end accepted");
+            ASSERT_ERR(JsonParser_feed(&parser, "{}", 2, &complete), "Data after the end rejected");
+        }
+        {
+            __autodestroy_json_parser__ JsonParser parser;
+            bool complete;
+            JsonArray* json_array;
+            lld_t value_lld;
+            ASSERT_OK(JsonParser_new(&parser), "Parser created");
+            ASSERT_OK(JsonParser_feed(&parser, "  ", 2, &complete), "Leading whitespace accepted");
+            ASSERT_OK(JsonParser_feed(&parser, "[-", 2, &complete), "Sign of a number accepted");
+            ASSERT(!complete, "More data needed");
+            ASSERT_OK(JsonParser_feed(&parser, "42, nu", 6, &complete), "Partial literal accepted");
+            ASSERT_OK(JsonParser_feed(&parser, "ll]", 3, &complete), "End of array accepted");
+            ASSERT(complete, "Top-level array complete");
+            ASSERT_OK(JsonObj_get_array(&parser.json_obj, &json_array), "Top-level array found");
+            ASSERT_OK(Json_get(json_array, 0, &value_lld), "Number split across chunks found");
+            ASSERT_EQ(value_lld, -42, "Number split across chunks correct");
+        }
+        {
+            __autodestroy_json_parser__ JsonParser parser;
+            bool complete;
+            ASSERT_OK(JsonParser_new(&parser), "Parser created");
+            ASSERT_OK(JsonParser_feed(&parser, "{\"a\": 1", 7, &complete), "Valid prefix accepted");
+            ASSERT_ERR(JsonParser_feed(&parser, ",,", 2, &complete), "Error detected without more data");
+            ASSERT_ERR(JsonParser_feed(&parser, "}", 1, &complete), "Parser stays in error");
+        }
+        {
+            __autodestroy_json_parser__ JsonParser parser;
+            bool complete;
+            ASSERT_OK(JsonParser_new(&parser), "Parser created");
+            ASSERT_ERR(JsonParser_feed(&parser, "{\"a\": tx", 8, &complete), "Invalid literal detected");
+        }
+    }
+    PRINT_TEST_TITLE("Streaming NDJSON reader");
+    {
+        const char* path                  = "test/artifacts/records.ndjson";
+        const size_t num_of_elements      = 200000;
+        __autofree_cstr__ char* json_cstr = my_memory_malloc(__FILE__, __LINE__, 8 * num_of_elements);
+        char* curr_p                      = json_cstr + sprintf(json_cstr, "{\"big\":[0");
+        for (size_t i = 1; i < num_of_elements; i++)
+        {
+            curr_p += sprintf(curr_p, ",%zu", i);
+        }
+        sprintf(curr_p, "]}");
+        FILE* ndjson_file = fopen(path, "w");
+        fprintf(ndjson_file, "{\"id\": 0}\n{\"id\": 1}\r\n\n   \n{\"id\": \"broken\"\n");
+        fprintf(ndjson_file, "%s\n{\"id\": 2, \"text\": \"a\\nb\"}", json_cstr);
+        fclose(ndjson_file);
+
+        __autodestroy_json_reader__ JsonReader reader;
+        JsonObj* json_obj_p;
+        JsonArray* json_array;
+        llu_t value_llu;
+        const char* value_cstr;
+        int fd = open(path, O_RDONLY);
+        ASSERT_OK(JsonReader_new(fd, &reader), "Reader created");
+        ASSERT_OK(JsonReader_next(&reader, &json_obj_p), "First record read");
+        ASSERT_OK(Json_get(json_obj_p, "id", &value_llu), "First record parsed");
+        ASSERT_EQ(value_llu, 0, "First record correct");
+        ASSERT_OK(JsonReader_next(&reader, &json_obj_p), "Record ending with CRLF read");
+        ASSERT_OK(Json_get(json_obj_p, "id", &value_llu), "Record ending with CRLF parsed");
+        ASSERT_EQ(value_llu, 1, "Record ending with CRLF correct");
+        ASSERT(JsonReader_next(&reader, &json_obj_p) == ERR_JSON_INVALID, "Invalid record detected");
+        ASSERT(json_obj_p == NULL, "No object for the invalid record");
+        ASSERT_OK(JsonReader_next(&reader, &json_obj_p), "Record larger than a chunk read");
+        ASSERT_OK(Json_get(json_obj_p, "big", &json_array), "Record larger than a chunk parsed");
+        ASSERT_EQ(JsonArray_len(json_array), num_of_elements, "Record larger than a chunk correct");
+        ASSERT(reader.size < 4 * strlen(json_cstr), "Buffer proportional to the largest record");
+        ASSERT_OK(JsonReader_next(&reader, &json_obj_p), "Last record without newline read");
+        ASSERT_OK(Json_get(json_obj_p, "text", &value_cstr), "Last record without newline parsed");
+        ASSERT_EQ(value_cstr, "a\nb", "Last record without newline correct");
+        ASSERT_OK(JsonReader_next(&reader, &json_obj_p), "End of stream reached");
+        ASSERT(json_obj_p == NULL, "No object at the end of the stream");
+        close(fd);
+    }
+    PRINT_TEST_TITLE("JSON writer");
+    {
+        __autodestroy_json_writer__ JsonWriter writer;
+        String_empty(json_string);
+        ASSERT_OK(JsonWriter_new(&writer), "Writer created");
+        JsonWriter_begin_object(&writer);
+        JsonWriter_key(&writer, "text");
+        JsonWriter_value(&writer, "quote \" backslash \\ newline \n tab \t bell \a");
+        JsonWriter_key(&writer, "min");
+        JsonWriter_value(&writer, (lld_t)LLONG_MIN);
+        JsonWriter_key(&writer, "max");
+        JsonWriter_value(&writer, (llu_t)ULLONG_MAX);
+        JsonWriter_key(&writer, "small");
+        JsonWriter_value(&writer, 7);
+        JsonWriter_key(&writer, "doubles");
+        JsonWriter_begin_array(&writer);
+        JsonWriter_value(&writer, 0.1);
+        JsonWriter_value(&writer, -2.0);
+        JsonWriter_value(&writer, 1e300);
+        JsonWriter_value(&writer, 1.0 / 3.0);
+        JsonWriter_end_array(&writer);
+        JsonWriter_key(&writer, "empty");
+        JsonWriter_begin_object(&writer);
+        JsonWriter_end_object(&writer);
+        JsonWriter_key(&writer, "flags");
+        JsonWriter_begin_array(&writer);
+        JsonWriter_value(&writer, true);
+        JsonWriter_value(&writer, false);
+        JsonWriter_null(&writer);
+        JsonWriter_end_array(&writer);
+        ASSERT_ERR(JsonWriter_to_string(&writer, &json_string), "Unclosed object rejected");
+        JsonWriter_end_object(&writer);
+        ASSERT_OK(JsonWriter_to_string(&writer, &json_string), "Document written");
+        ASSERT_EQ(
+            json_string.str,
+            "{\"text\":\"quote \\\" backslash \\\\ newline \\n tab \\t bell \\u0007\","
+            "\"min\":-9223372036854775808,\"max\":18446744073709551615,\"small\":7,"
+            "\"doubles\":[0.1,-2.0,1.0e+300,0.3333333333333333],\"empty\":{},"
+            "\"flags\":[true,false,null]}",
+            "Document correct");
+        ASSERT_EQ(json_string.length, strlen(json_string.str), "Length correct");
+
+        __autodestroy_json__ JsonObj json_obj;
         JsonArray* json_array;
-        const char* json_char_p = " {\"key\": [ {\"array key\": 56}]}";
-        printf("\n%s\n", json_char_p);
-        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
-        Json_get(&json_obj, "key", &json_array);
-        Json_get(json_array, 0, &json_item);
-        ASSERT_EQ(json_item->key_p, "array key", "Array STRING element retrieved.");
-        printf("%d\n", json_item->value.value_type);
-        Json_get(json_item, "array key", &value_llu);
-        ASSERT_EQ(value_llu, 56, "Value found an item that is also array element.");
+        double value_double;
+        ASSERT_OK(JsonObj_new(json_string.str, &json_obj), "Document parsed back");
+        ASSERT_OK(Json_get(&json_obj, "doubles", &json_array), "Array of doubles found");
+        ASSERT_OK(Json_get(json_array, 3, &value_double), "Double found");
+        ASSERT_EQ(value_double == 1.0 / 3.0, true, "Double read back exactly");
+        String_destroy(&json_string);
     }
-    PRINT_TEST_TITLE("object and array");
     {
-        JsonObj json_obj;
+        __autodestroy_json_writer__ JsonWriter writer;
+        String_empty(json_string);
+        char long_cstr[200];
+        memset(long_cstr, 'a', sizeof(long_cstr) - 1);
+        long_cstr[sizeof(long_cstr) - 1] = '\0';
+        long_cstr[70]                    = '"';
+        long_cstr[150]                   = '\\';
+        ASSERT_OK(JsonWriter_new(&writer), "Writer created");
+        JsonWriter_begin_array(&writer);
+        for (size_t i = 0; i < 100; i++)
+        {
+            JsonWriter_value(&writer, long_cstr);
+        }
+        JsonWriter_end_array(&writer);
+        JsonWriter_end_array(&writer);
+        ASSERT_ERR(JsonWriter_to_string(&writer, &json_string), "Unbalanced document rejected");
+
+        JsonWriter_destroy(&writer);
+        ASSERT_OK(JsonWriter_new(&writer), "Writer made new");
+        JsonWriter_begin_array(&writer);
+        for (size_t i = 0; i < 100; i++)
+        {
+            JsonWriter_value(&writer, long_cstr);
+        }
+        JsonWriter_end_array(&writer);
+        ASSERT_OK(JsonWriter_to_string(&writer, &json_string), "Long strings written");
+        ASSERT_EQ(json_string.length, 2 + 100 * (199 + 2 + 2) + 99, "Buffer grown as needed");
+        ASSERT(strncmp(json_string.str + 72, "\\\"", 2) == 0, "Quote escaped across blocks");
+        ASSERT(strncmp(json_string.str + 153, "\\\\", 2) == 0, "Backslash escaped across blocks");
+        String_destroy(&json_string);
+    }
+    PRINT_TEST_TITLE("Serialize a parsed object");
+    {
+        const char* json_cstr = "{ \"a\" : [1, -2, 3.5, \"x\\\"y\", true, null, [], {}],\n"
+                                "  \"b\" : {\"c\": {\"d\": [[0], {\"e\": false}]}},\n"
+                                "  \"f\" : \"last\" }";
+        const char* expected_cstr
+            = "{\"a\":[1,-2,3.5,\"x\\\"y\",true,null,[],{}],"
+              "\"b\":{\"c\":{\"d\":[[0],{\"e\":false}]}},\"f\":\"last\"}";
+        {
+            __autodestroy_json__ JsonObj json_obj;
+            String_empty(json_string);
+            ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Object parsed");
+            ASSERT_OK(JsonObj_to_string(&json_obj, &json_string), "Object serialized");
+            ASSERT_EQ(json_string.str, expected_cstr, "Object serialized correctly");
+            String_destroy(&json_string);
+        }
+        {
+            __autodestroy_json__ JsonObj json_obj;
+            String_empty(json_string);
+            JsonItem* json_item;
+            ASSERT_OK(JsonObj_new_lazy(json_cstr, &json_obj), "Object parsed lazily");
+            ASSERT_OK(Json_get(&json_obj, "b", &json_item), "Part of the object built");
+            ASSERT_OK(JsonObj_to_string(&json_obj, &json_string), "Lazy object serialized");
+            ASSERT_EQ(json_string.str, expected_cstr, "Lazy object serialized correctly");
+            String_destroy(&json_string);
+        }
+        {
+            __autodestroy_json__ JsonObj json_obj;
+            String_empty(json_string);
+            ASSERT_OK(JsonObj_new("[ {}, [ ], {\"k\": [1]} ]", &json_obj), "Array parsed");
+            ASSERT_OK(JsonObj_to_string(&json_obj, &json_string), "Array serialized");
+            ASSERT_EQ(json_string.str, "[{},[],{\"k\":[1]}]", "Array serialized correctly");
+            String_destroy(&json_string);
+        }
+        {
+            __autodestroy_json__ JsonObj json_obj;
+            String_empty(json_string);
+            ASSERT_OK(JsonObj_new("{}", &json_obj), "Empty object parsed");
+            ASSERT_OK(JsonObj_to_string(&json_obj, &json_string), "Empty object serialized");
+            ASSERT_EQ(json_string.str, "{}", "Empty object serialized correctly");
+            String_destroy(&json_string);
+            JsonObj_destroy(&json_obj);
+            ASSERT_ERR(JsonObj_to_string(&json_obj, &json_string), "Destroyed object rejected");
+        }
+    }
+    PRINT_TEST_TITLE("Modify a parsed object");
+    {
+        __autodestroy_json__ JsonObj json_obj;
+        String_empty(json_string);
         JsonItem* json_item;
         JsonArray* json_array;
-        const char* json_char_p = " {\"object\": {\"array\": [ {\"array key\": 56}]}}";
-        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
-        ASSERT_OK(Json_get(&json_obj, "object", &json_item), "Object retrieved");
-        ASSERT_OK(Json_get(json_item, "array", &json_array), "Array retrieved");
-        // Destroying multiple times is safe
-        JsonObj_destroy(&json_obj);
-        JsonObj_destroy(&json_obj);
+        const char* value_cstr;
+        lld_t value_lld;
+        llu_t value_llu;
+        double value_double;
+        bool value_bool;
+        const char* json_cstr
+            = "{\"id\": 1, \"name\": \"old\", \"inner\": {\"a\": 1, \"b\": 2}, \"list\": [0, 1, 2]}";
+        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Object parsed");
+        ASSERT_OK(Json_get(&json_obj, "name", &value_cstr), "Original string found");
+        const char* original_name_p = value_cstr;
+
+        ASSERT_OK(Json_set(&json_obj, "id", -5), "Integer set");
+        ASSERT_OK(Json_get(&json_obj, "id", &value_lld), "Integer read back");
+        ASSERT_EQ(value_lld, -5, "Integer correct");
+        ASSERT_OK(Json_set(&json_obj, "name", "new \"name\""), "String set");
+        ASSERT_OK(Json_get(&json_obj, "name", &value_cstr), "String read back");
+        ASSERT_EQ(value_cstr, "new \"name\"", "String stored as is");
+        ASSERT(value_cstr != original_name_p, "Modified string copied");
+        ASSERT_ERR(Json_set(&json_obj, "missing", true), "Missing key not set");
+
+        ASSERT_OK(Json_get(&json_obj, "inner", &json_item), "Inner object found");
+        ASSERT_OK(Json_set(json_item, "b", 2.5), "Double set in inner object");
+        ASSERT_OK(Json_get(json_item, "b", &value_double), "Double read back");
+        ASSERT_EQ(value_double, 2.5, "Double correct");
+        ASSERT_OK(Json_insert(json_item, "c", true), "Key inserted in inner object");
+        ASSERT_ERR(Json_insert(json_item, "c", false), "Duplicate key rejected");
+        ASSERT_OK(Json_get(json_item, "c", &value_bool), "Inserted key found");
+        ASSERT_EQ(value_bool, true, "Inserted value correct");
+        ASSERT_OK(Json_remove(json_item, "b"), "Key removed from inner object");
+        ASSERT_ERR(Json_get(json_item, "b", &value_double), "Removed key not found");
+        ASSERT_OK(Json_remove(json_item, "a"), "First key removed from inner object");
+        ASSERT_ERR(Json_remove(json_item, "a"), "Key removed only once");
+
+        ASSERT_OK(Json_get(&json_obj, "list", &json_array), "Array found");
+        ASSERT_OK(Json_insert(json_array, 0, "first"), "Element inserted at the beginning");
+        ASSERT_OK(Json_insert(json_array, 2, 10u), "Element inserted in the middle");
+        ASSERT_OK(Json_insert(json_array, JsonArray_len(json_array), false), "Element appended");
+        ASSERT_ERR(Json_insert(json_array, 100, 1), "Element beyond the end rejected");
+        ASSERT_OK(Json_remove(json_array, 3), "Element removed");
+        ASSERT_OK(Json_set(json_array, 1, 7), "Element set");
+        ASSERT_EQ(JsonArray_len(json_array), 5, "Array length updated");
+        ASSERT_OK(Json_get(json_array, 2, &value_llu), "Inserted element found by index");
+        ASSERT_EQ(value_llu, 10, "Inserted element correct");
+
+        ASSERT_OK(Json_insert(&json_obj, "added", "x"), "Top-level key inserted");
+        ASSERT_OK(Json_remove(&json_obj, "id"), "Top-level key removed");
+        ASSERT_OK(JsonObj_to_string(&json_obj, &json_string), "Modified object serialized");
+        ASSERT_EQ(
+            json_string.str,
+            "{\"name\":\"new \\\"name\\\"\",\"inner\":{\"c\":true},"
+            "\"list\":[\"first\",7,10,2,false],\"added\":\"x\"}",
+            "Modified object serialized correctly");
+        String_destroy(&json_string);
     }
-    PRINT_TEST_TITLE("test_json_array_1.json");
     {
-        JsonObj json_obj;
+        __autodestroy_json__ JsonObj json_obj;
+        JsonArray* json_array;
         JsonItem* json_item;
         llu_t value_llu;
+        lld_t value_lld;
+        char key[16];
+        const char* value_cstr;
+        ASSERT_OK(
+            JsonObj_new("{\"first\": [1], \"empty\": [], \"nested\": {\"inner\": {}}}", &json_obj),
+            "Object parsed");
+        for (size_t i = 0; i < 100; i++)
+        {
+            sprintf(key, "key_%zu", i);
+            Json_insert(&json_obj, key, (llu_t)i);
+        }
+        ASSERT_OK(Json_get(&json_obj, "key_99", &value_llu), "Key found through the index");
+        ASSERT_OK(Json_remove(&json_obj, "key_99"), "Indexed key removed");
+        ASSERT_ERR(Json_get(&json_obj, "key_99", &value_llu), "Index updated after removal");
+        ASSERT_OK(Json_get(&json_obj, "key_98", &value_llu), "Other keys still found");
+        ASSERT_EQ(value_llu, 98, "Other keys still correct");
+        ASSERT_OK(Json_insert_in(&json_obj, "nested", "id", 7), "Key inserted into empty object");
+        ASSERT_ERR(Json_insert_in(&json_obj, "nested", "id", 8), "Duplicate key rejected");
+        ASSERT_ERR(Json_insert_in(&json_obj, "empty", "id", 7), "Array rejected");
+        ASSERT_ERR(Json_insert_in(&json_obj, "missing", "id", 7), "Missing object rejected");
+        ASSERT_OK(Json_get(&json_obj, "nested", &json_item), "Object no longer empty");
+        ASSERT_OK(Json_get(json_item, "id", &value_llu), "Key inserted into empty object found");
+        ASSERT_EQ(value_llu, 7, "Key inserted into empty object correct");
+        ASSERT_OK(Json_insert_in(json_item, "inner", "x", "y"), "Key inserted two levels down");
+        ASSERT_OK(Json_get(json_item, "inner", &json_item), "Inner object found");
+        ASSERT_OK(Json_get(json_item, "x", &value_cstr), "Inserted key found");
+        ASSERT_EQ(value_cstr, "y", "Inserted value correct");
+        ASSERT_OK(Json_get(&json_obj, "empty", &json_array), "Empty array found");
+        ASSERT_OK(Json_insert(json_array, 0, -42), "Element inserted into empty array");
+        ASSERT_OK(Json_get(json_array, 0, &value_lld), "Element of empty array found");
+        ASSERT_EQ(value_lld, -42, "Element of empty array correct");
+        ASSERT_OK(Json_get(&json_obj, "first", &json_array), "Array found");
+        json_item = json_array->element;
+        ASSERT_ERR(Json_insert(json_item, "key", 1), "Key rejected on an array element");
+        ASSERT_ERR(Json_remove(json_item, "key"), "Key removal rejected on an array element");
+    }
+    PRINT_TEST_TITLE("JSON paths");
+    {
+        __autofree_cstr__ char* json_cstr = load_file_alloc("test/assets/test_json.json");
+        __autodestroy_json__ JsonObj json_obj;
+        __autodestroy_json__ JsonObj lazy_json_obj;
+        __autodestroy_json_path__ JsonPath nested_path;
+        __autodestroy_json_path__ JsonPath array_path;
+        __autodestroy_json_path__ JsonPath escaped_path;
+        JsonPath invalid_path;
+        const char* value_cstr;
+        double value_double;
+        llu_t value_llu;
+        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Object parsed");
+        ASSERT_OK(JsonObj_new_lazy(json_cstr, &lazy_json_obj), "Object parsed lazily");
+        ASSERT_OK(JsonPath_new("/nested_2/object_2.2/item_2.2", &nested_path), "Path compiled");
+        ASSERT_OK(JsonPath_new("/test_array/1", &array_path), "Path with index compiled");
+        ASSERT_EQ(nested_path.len, 3, "Segments counted");
+        ASSERT_OK(JsonPath_get(&json_obj, &nested_path, &value_cstr), "Nested value found");
+        ASSERT_EQ(value_cstr, "value_2.2.1", "Nested value correct");
+        ASSERT_OK(JsonPath_get(&lazy_json_obj, &nested_path, &value_cstr), "Lazy value found");
+        ASSERT_EQ(value_cstr, "value_2.2.1", "Lazy value correct");
+        ASSERT_OK(JsonPath_get(&json_obj, &array_path, &value_double), "Element found");
+        ASSERT_EQ(value_double, 2.15, "Element correct");
+        ASSERT_ERR(JsonPath_get(&json_obj, &array_path, &value_cstr), "Type checked");
+        ASSERT_ERR(JsonPath_new("no/slash", &invalid_path), "Path without leading slash rejected");
+        ASSERT_ERR(JsonPath_new("/bad~2escape", &invalid_path), "Invalid escape rejected");
+        ASSERT_OK(JsonPath_new("/a~1b/~0c/01", &escaped_path), "Escaped path compiled");
+        ASSERT_ERR(JsonPath_get(&json_obj, &escaped_path, &value_cstr), "Missing key reported");
+
+        __autodestroy_json__ JsonObj escaped_json_obj;
+        ASSERT_OK(
+            JsonObj_new("{\"a/b\": {\"~c\": {\"01\": 5}}}", &escaped_json_obj), "Object parsed");
+        ASSERT_OK(JsonPath_get(&escaped_json_obj, &escaped_path, &value_llu), "Escaped keys found");
+        ASSERT_EQ(value_llu, 5, "Escaped keys correct");
+    }
+    {
+        // Evaluating the same path against many objects, some of them large enough to be indexed.
+        __autodestroy_json_path__ JsonPath json_path;
+        char json_cstr[1024];
+        ASSERT_OK(JsonPath_new("/items/2/key_19", &json_path), "Path compiled");
+        bool all_passed = true;
+        for (size_t i = 0; i < 20; i++)
+        {
+            char* curr_p = json_cstr + sprintf(json_cstr, "{\"items\": [0, 1, {\"key_0\": 0");
+            for (size_t k = 1; k < 20; k++)
+            {
+                curr_p += sprintf(curr_p, ", \"key_%zu\": %zu", k, k * i);
+            }
+            sprintf(curr_p, "}]}");
+            __autodestroy_json__ JsonObj json_obj;
+            llu_t value_llu = 0;
+            all_passed      = all_passed && is_ok(JsonObj_new(json_cstr, &json_obj))
+                    && is_ok(JsonPath_get(&json_obj, &json_path, &value_llu))
+                    && is_ok(JsonPath_get(&json_obj, &json_path, &value_llu))
+                    && (value_llu == 19 * i);
+        }
+        ASSERT(all_passed, "Same path evaluated against many objects");
+        __autodestroy_json__ JsonObj json_obj;
+        JsonArray* json_array;
+        ASSERT_OK(JsonObj_new("[[1, 2], {\"k\": [3]}]", &json_obj), "Top-level array parsed");
+        JsonPath_destroy(&json_path);
+        ASSERT_OK(JsonPath_new("/1/k", &json_path), "Path into top-level array compiled");
+        ASSERT_OK(JsonPath_get(&json_obj, &json_path, &json_array), "Array in top-level array found");
+        ASSERT_EQ(JsonArray_len(json_array), 1, "Array in top-level array correct");
+    }
+    PRINT_TEST_TITLE("Decode into a struct");
+    {
+        typedef struct
+        {
+            const char* name;
+            lld_t offset;
+            llu_t count;
+            double ratio;
+            bool enabled;
+            llu_t missing;
+        } Message;
+        const JsonBinding bindings[] = {
+            JSON_BINDING("name", Message, name, VALUE_CSTR),
+            JSON_BINDING("offset", Message, offset, VALUE_LLD),
+            JSON_BINDING("count", Message, count, VALUE_LLU),
+            JSON_BINDING("ratio", Message, ratio, VALUE_DOUBLE),
+            JSON_BINDING("enabled", Message, enabled, VALUE_BOOL),
+            JSON_BINDING("missing", Message, missing, VALUE_LLU),
+        };
+        char json_cstr[] = "{\"enabled\": true, \"skipped\": {\"a\": [1, {}]}, \"name\": \"a\\\"b\","
+                           " \"offset\": -3, \"count\": 12, \"ratio\": 2, \"name\": \"dup\"}";
+        Message message = {0};
+        uint64_t missing_mask;
+        uint64_t mismatch_mask;
+        ASSERT(
+            Json_decode(
+                json_cstr, bindings, sizeof_array(bindings), &message, &missing_mask, &mismatch_mask)
+                == ERR_JSON_MISSING_ENTRY,
+            "Missing field reported");
+        ASSERT_EQ(missing_mask, 1 << 5, "Missing field identified");
+        ASSERT_EQ(mismatch_mask, 0, "No mismatch");
+        ASSERT_EQ(message.name, "a\"b", "String decoded");
+        ASSERT_EQ(message.offset, -3, "Negative integer decoded");
+        ASSERT_EQ(message.count, 12, "Positive integer decoded");
+        ASSERT_EQ(message.ratio, 2.0, "Integer decoded as double");
+        ASSERT_EQ(message.enabled, true, "Bool decoded");
+
+        char mismatch_cstr[] = "{\"name\": 1, \"offset\": 1.5, \"count\": -1, \"ratio\": \"x\","
+                               " \"enabled\": null, \"missing\": [1]}";
+        ASSERT(
+            Json_decode(
+                mismatch_cstr,
+                bindings,
+                sizeof_array(bindings),
+                &message,
+                &missing_mask,
+                &mismatch_mask)
+                == ERR_TYPE_MISMATCH,
+            "Mismatched fields reported");
+        ASSERT_EQ(missing_mask, 0, "No missing field");
+        ASSERT_EQ(mismatch_mask, 0x3F, "All fields mismatched");
+
+        const char* invalid_cstrs[] = {"{\"name\": \"x\", }", "[1]", "{\"a\": [}", "{} {}"};
+        for (size_t i = 0; i < sizeof_array(invalid_cstrs); i++)
+        {
+            char invalid_cstr[32];
+            strcpy(invalid_cstr, invalid_cstrs[i]);
+            ASSERT(
+                Json_decode(
+                    invalid_cstr,
+                    bindings,
+                    sizeof_array(bindings),
+                    &message,
+                    &missing_mask,
+                    &mismatch_mask)
+                    == ERR_JSON_INVALID,
+                invalid_cstrs[i]);
+        }
+
+        typedef struct
+        {
+            llu_t id;
+        } Id;
+        const JsonBinding id_bindings[] = {JSON_BINDING("id", Id, id, VALUE_LLU)};
+        char nul_cstr[]                 = "{\"id\\u0000zz\": 1, \"id\": 2}";
+        Id id                           = {0};
+        ASSERT_OK(
+            Json_decode(nul_cstr, id_bindings, 1, &id, &missing_mask, &mismatch_mask),
+            "Key with a null character decoded");
+        ASSERT_EQ(id.id, 2, "Key with a null character not mistaken for its prefix");
+    }
+    PRINT_TEST_TITLE("Tape representation");
+    {
+        __autofree_cstr__ char* json_cstr = load_file_alloc("test/assets/test_json.json");
+        __autodestroy_json_tape__ JsonTape json_tape;
+        __autodestroy_json__ JsonObj json_obj;
+        ASSERT_OK(JsonTape_new(json_cstr, &json_tape), "Tape created");
+        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Object created");
+        ASSERT_EQ(sizeof(JsonTapeEntry), 16, "Entries take 16 bytes");
+        ASSERT_EQ(json_tape.len, 18, "One entry per value");
+
         const char* value_cstr;
+        lld_t value_lld;
+        llu_t value_llu;
         double value_double;
         bool value_bool;
+        JsonTapeView nested_view;
+        JsonTapeView array_view;
+        ASSERT_OK(Json_get(&json_tape, "text_key", &value_cstr), "String found");
+        ASSERT_EQ(value_cstr, "text_value", "String correct");
+        ASSERT_OK(Json_get(&json_tape, "test_integer", &value_llu), "Integer found");
+        ASSERT_EQ(value_llu, 435234, "Integer correct");
+        ASSERT_OK(Json_get(&json_tape, "test_integer", &value_double), "Integer read as double");
+        ASSERT_EQ(value_double, 435234.0, "Integer converted");
+        ASSERT_OK(Json_get(&json_tape, "test_double", &value_double), "Double found");
+        ASSERT_EQ(value_double, 435.234, "Double correct");
+        ASSERT_OK(Json_get(&json_tape, "test_bool_false", &value_bool), "Bool found");
+        ASSERT_EQ(value_bool, false, "Bool correct");
+        ASSERT_ERR(Json_get(&json_tape, "text_key", &value_bool), "Type mismatch");
+        ASSERT_ERR(Json_get(&json_tape, "missing", &value_cstr), "Missing key");
+        ASSERT_ERR(Json_get(&json_tape, 0, &value_cstr), "Not an array");
+
+        ASSERT_OK(Json_get(&json_tape, "nested_2", &nested_view), "Nested object found");
+        ASSERT_EQ(JsonTapeView_len(&nested_view), 2, "Nested object length");
+        ASSERT_OK(Json_get(&nested_view, "object_2.2", &nested_view), "Nested object found");
+        ASSERT_OK(Json_get(&nested_view, "item_2.2", &value_cstr), "Nested value found");
+        ASSERT_EQ(value_cstr, "value_2.2.1", "Nested value correct");
+        ASSERT_OK(Json_get(&json_tape, "text_sibling", &value_cstr), "Sibling found");
+        ASSERT_EQ(value_cstr, "sibling_value", "Nested objects skipped");
+
+        ASSERT_OK(Json_get(&json_tape, "test_array", &array_view), "Array found");
+        ASSERT_EQ(JsonTapeView_len(&array_view), 3, "Array length");
+        ASSERT_OK(Json_get(&array_view, 0, &value_lld), "Array integer found");
+        ASSERT_EQ(value_lld, 14352, "Array integer correct");
+        ASSERT_OK(Json_get(&array_view, 2, &value_cstr), "Array string found");
+        ASSERT_EQ(value_cstr, "string_element", "Array string correct");
+        ASSERT_ERR(Json_get(&array_view, 3, &value_cstr), "Index out of boundaries");
+        ASSERT_ERR(Json_get(&array_view, "key", &value_cstr), "Not an object");
+
+        JsonItem* json_item;
+        ASSERT_ERR(Json_get(&json_tape, "nested_1", &json_item), "No items in a tape");
+        ASSERT_ERR(Json_get(&json_obj, "nested_1", &nested_view), "No views in an object");
+        ASSERT(3 * sizeof(JsonTapeEntry) <= sizeof(JsonItem), "A third of the memory per value");
+    }
+    {
+        __autofree_cstr__ char* json_cstr
+            = load_file_alloc("test/assets/test_json_vec_of_obj.json");
+        __autodestroy_json_tape__ JsonTape json_tape;
+        ASSERT_OK(JsonTape_new(json_cstr, &json_tape), "Tape created");
+        JsonTapeView data_view;
+        JsonTapeView element_view;
+        double value_double;
+        ASSERT_OK(Json_get(&json_tape, "Data", &data_view), "Array of objects found");
+        ASSERT_OK(Json_get(&data_view, 1, &element_view), "Element found after a container");
+        ASSERT_OK(Json_get(&element_view, "Close", &value_double), "Element value found");
+        ASSERT_EQ(value_double, 223.2, "Element value correct");
+
+        char top_level_array[] = "[[1, 2], {\"a\": null}, \"x\"]";
+        JsonTape_destroy(&json_tape);
+        ASSERT_OK(JsonTape_new(top_level_array, &json_tape), "Top-level array");
+        const char* value_cstr;
+        ASSERT_OK(Json_get(&json_tape, 0, &element_view), "Top-level array is the root");
+        ASSERT_EQ(JsonTapeView_len(&element_view), 2, "First element correct");
+        ASSERT_OK(Json_get(&json_tape, 2, &value_cstr), "Last element found");
+        ASSERT_EQ(value_cstr, "x", "Last element correct");
+
+        const char* invalid_cstrs[] = {"", "1", "{\"a\": }", "[1, 2", "{} {}"};
+        for (size_t i = 0; i < sizeof_array(invalid_cstrs); i++)
+        {
+            JsonTape_destroy(&json_tape);
+            ASSERT_ERR(JsonTape_new(invalid_cstrs[i], &json_tape), invalid_cstrs[i]);
+        }
+    }
+    PRINT_TEST_TITLE("Binary snapshot");
+    {
+        const char* path                  = "test/artifacts/test_json.snapshot";
+        __autofree_cstr__ char* json_cstr = load_file_alloc("test/assets/test_json.json");
+        __autodestroy_json__ JsonObj json_obj;
+        __autodestroy_json_tape__ JsonTape json_tape;
+        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Object created");
+        ASSERT_OK(Json_set(&json_obj, "test_integer", -7), "Object modified");
+        ASSERT_OK(JsonObj_save_snapshot(&json_obj, path), "Snapshot saved");
+        ASSERT_OK(JsonTape_map_snapshot(path, &json_tape), "Snapshot mapped");
+        ASSERT(json_tape.mapped_size > 0, "Snapshot not copied");
+
+        const char* value_cstr;
+        lld_t value_lld;
+        double value_double;
+        JsonTapeView view;
+        ASSERT_OK(Json_get(&json_tape, "test_integer", &value_lld), "Modified value found");
+        ASSERT_EQ(value_lld, -7, "Modified value saved");
+        ASSERT_OK(Json_get(&json_tape, "test_array", &view), "Array found");
+        ASSERT_OK(Json_get(&view, 1, &value_double), "Array element found");
+        ASSERT_EQ(value_double, 2.15, "Array element correct");
+        ASSERT_OK(Json_get(&json_tape, "nested_2", &view), "Nested object found");
+        ASSERT_OK(Json_get(&view, "object_2.1", &value_cstr), "Nested value found");
+        ASSERT_EQ(value_cstr, "item_2.1", "Nested value correct");
+        JsonTape_destroy(&json_tape);
+
+        ASSERT_OK(JsonTape_new("[1, \"a\"]", &json_tape), "Tape created");
+        ASSERT_OK(JsonTape_save_snapshot(&json_tape, path), "Tape saved");
+        JsonTape_destroy(&json_tape);
+        ASSERT_OK(JsonTape_map_snapshot(path, &json_tape), "Tape mapped");
+        ASSERT_OK(Json_get(&json_tape, 1, &value_cstr), "Top-level array element found");
+        ASSERT_EQ(value_cstr, "a", "Top-level array element correct");
+        JsonTape_destroy(&json_tape);
+
+        // Entries of `[1, "a", [true]]`: the array, 1, "a", the inner array and true.
+        const struct
+        {
+            long offset;
+            uint64_t value;
+            size_t size;
+            const char* message;
+        } corruptions[] = {
+            {offsetof(JsonSnapshotHeader, json_len), SIZE_MAX, 8, "Input length wrapping rejected"},
+            {sizeof(JsonSnapshotHeader) + 2 * 16 + 8, 1 << 20, 8, "String out of the input rejected"},
+            {sizeof(JsonSnapshotHeader) + 2 * 16, 1 << 20, 4, "Key out of the input rejected"},
+            {sizeof(JsonSnapshotHeader) + 3 * 16 + 4, 99, 4, "Unknown value type rejected"},
+            {sizeof(JsonSnapshotHeader) + 3 * 16 + 8, 1000, 4, "Skip beyond the tape rejected"},
+            {sizeof(JsonSnapshotHeader) + 3 * 16 + 8, 0, 4, "Null skip rejected"},
+            {sizeof(JsonSnapshotHeader) + 3 * 16 + 12, 2, 4, "Length beyond the container rejected"},
+            {sizeof(JsonSnapshotHeader) + 8, 4, 4, "Length short of the container rejected"},
+        };
+        ASSERT_OK(JsonTape_new("[1, \"a\", [true]]", &json_tape), "Tape created");
+        for (size_t i = 0; i < sizeof_array(corruptions); i++)
+        {
+            ASSERT_OK(JsonTape_save_snapshot(&json_tape, path), "Tape saved");
+            ASSERT(
+                _test_overwrite(
+                    path, corruptions[i].offset, &corruptions[i].value, corruptions[i].size),
+                "Entry corrupted");
+            JsonTape mapped_tape;
+            ASSERT(JsonTape_map_snapshot(path, &mapped_tape) == ERR_INVALID, corruptions[i].message);
+        }
+        ASSERT_OK(JsonTape_save_snapshot(&json_tape, path), "Tape saved");
+        JsonTape_destroy(&json_tape);
+        ASSERT_OK(JsonTape_map_snapshot(path, &json_tape), "Intact tape mapped");
+        JsonTape_destroy(&json_tape);
+
+        ASSERT_OK(fs_create_with_content(path, "MYLIBCJT but not a snapshot"), "File overwritten");
+        ASSERT_ERR(JsonTape_map_snapshot(path, &json_tape), "Invalid snapshot rejected");
+        ASSERT_ERR(JsonTape_map_snapshot("test/artifacts/missing", &json_tape), "Missing file");
+    }
+    PRINT_TEST_TITLE("Parse a mapped file");
+    {
+        __autodestroy_json__ JsonObj json_obj;
+        String_empty(json_string);
+        const char* value_cstr;
+        double value_double;
         JsonArray* json_array;
-        __autofree_cstr__ char* json_cstr = load_file_alloc("test/assets/test_json_array_1.json");
-        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Json object created");
-        Json_get(&json_obj, "array_key", &json_array);
-        ASSERT_EQ(json_array != NULL, true, "Array found as root element.");
-        Json_get(json_array, 0, &json_item);
-        ASSERT_EQ(json_item != NULL, true, "First array element is an item.");
-        Json_get(json_item, "object 1", &value_llu);
-        ASSERT_EQ(value_llu, 56, "Value LLU found");
-        Json_get(json_array, 1, &json_item);
-        ASSERT_EQ(json_item != NULL, true, "Second array element is an item.");
-        Json_get(json_item, "object 2", &value_double);
-        ASSERT_EQ(value_double, 404.5f, "Value DOUBLE found");
-        Json_get(json_array, 2, &json_item);
-        Json_get(json_item, "object 3", &value_cstr);
-        ASSERT_EQ(value_cstr, "SOME STRING", "Array element STRING found.");
-        Json_get(json_array, 3, &value_llu);
-        ASSERT_EQ(value_llu, 32, "Array element INT found.");
-        Json_get(json_array, 4, &value_bool);
-        ASSERT_EQ(value_bool, false, "Array element BOOL found.");
-        JsonObj_destroy(&json_obj);
+        JsonItem* json_item;
+        ASSERT_OK(JsonObj_new_from_file("test/assets/test_json.json", &json_obj), "File parsed");
+        ASSERT(json_obj.mapped_size > 0, "File mapped");
+        ASSERT_OK(Json_get(&json_obj, "text_sibling", &value_cstr), "String found");
+        ASSERT_EQ(value_cstr, "sibling_value", "String correct");
+        ASSERT_OK(Json_get(&json_obj, "nested_2", &json_item), "Nested object found");
+        ASSERT_OK(Json_get(json_item, "object_2.2", &json_item), "Nested object found");
+        ASSERT_OK(Json_get(json_item, "item_2.2", &value_cstr), "Nested string found");
+        ASSERT_EQ(value_cstr, "value_2.2.1", "Nested string correct");
+        ASSERT_OK(Json_get(&json_obj, "test_double", &value_double), "Double found");
+        ASSERT_EQ(value_double, 435.234, "Double correct");
+
+        ASSERT_OK(Json_get(&json_obj, "test_array", &json_array), "Array found");
+        JsonArrayCursor cursor = JsonArray_cursor(json_array);
+        const JsonValue* value_p;
+        for (size_t i = 0; i < 3; i++)
+        {
+            ASSERT(JsonArrayCursor_next(&cursor, &value_p), "Element found");
+        }
+        ASSERT_EQ(value_p->cstr_len, 14, "String length recorded");
+        ASSERT_OK(Json_set(json_array, 2, "a\"b"), "String replaced");
+        ASSERT_EQ(value_p->cstr_len, 3, "Length of the copy recorded");
+        ASSERT_OK(JsonObj_to_string(&json_obj, &json_string), "Object serialized");
+        ASSERT(strstr(json_string.str, "[14352,2.15,\"a\\\"b\"]") != NULL, "Strings serialized");
+        String_destroy(&json_string);
+
+        __autofree_cstr__ char* file_cstr = load_file_alloc("test/assets/test_json.json");
+        ASSERT(strstr(file_cstr, "\"string_element\"") != NULL, "File left untouched");
     }
-    PRINT_TEST_TITLE("test_json_array_2.json");
     {
-        __autofree_cstr__ char* json_cstr = load_file_alloc("test/assets/test_json_array_2.json");
-        __autodestroy_json__ JsonObj json_obj;
+        JsonObj json_obj;
+        ASSERT_OK(fs_create_with_content("test/artifacts/empty.json", ""), "Empty file created");
+        ASSERT(
+            JsonObj_new_from_file("test/artifacts/empty.json", &json_obj) == ERR_EMPTY_STRING,
+            "Empty file rejected");
+        ASSERT_OK(fs_create_with_content("test/artifacts/invalid.json", "{\"a\": }"), "Created");
+        ASSERT_ERR(JsonObj_new_from_file("test/artifacts/invalid.json", &json_obj), "Invalid file");
+        ASSERT_ERR(JsonObj_new_from_file("test/artifacts/missing.json", &json_obj), "Missing file");
+    }
+    PRINT_TEST_TITLE("Number conversion");
+    {
+        const char* json_cstr
+            = "{\"exp\": 1e9, \"exp_neg\": 2.5E-3, \"exp_pos\": -1E+2, \"frac\": 0.1,"
+              " \"small\": 0.000001234, \"big_exp\": 5e300, \"tiny\": 4.9e-324,"
+              " \"digits\": 3.14159265358979323846, \"long_exp\": 1e-99999999999,"
+              " \"llu_max\": 18446744073709551615, \"lld_min\": -9223372036854775808,"
+              " \"zero\": -0, \"neg_zero\": -0.0, \"exact\": 9007199254740993.0}";
+        __autodestroy_json__ JsonObj json_obj;
+        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Numbers parsed");
+        double value_double;
+        llu_t value_llu;
+        lld_t value_lld;
+        const struct
+        {
+            const char* key;
+            double expected;
+        } doubles[] = {
+            {"exp", 1e9},
+            {"exp_neg", 0.0025},
+            {"exp_pos", -100.0},
+            {"frac", 0.1},
+            {"small", 0.000001234},
+            {"big_exp", 5e300},
+            {"tiny", 4.9e-324},
+            {"digits", 3.141592653589793},
+            {"long_exp", 0.0},
+            {"exact", 9007199254740992.0},
+        };
+        for (size_t i = 0; i < sizeof_array(doubles); i++)
+        {
+            ASSERT_OK(Json_get(&json_obj, doubles[i].key, &value_double), doubles[i].key);
+            ASSERT_EQ(value_double, doubles[i].expected, doubles[i].key);
+        }
+        ASSERT_ERR(Json_get(&json_obj, "exp", &value_llu), "Exponent makes a double");
+        ASSERT_OK(Json_get(&json_obj, "llu_max", &value_llu), "Largest llu_t found");
+        ASSERT_EQ(value_llu, ULLONG_MAX, "Largest llu_t correct");
+        ASSERT_OK(Json_get(&json_obj, "lld_min", &value_lld), "Smallest lld_t found");
+        ASSERT_EQ(value_lld, LLONG_MIN, "Smallest lld_t correct");
+        ASSERT_OK(Json_get(&json_obj, "zero", &value_lld), "Negative zero integer found");
+        ASSERT_EQ(value_lld, 0, "Negative zero integer correct");
+        ASSERT_OK(Json_get(&json_obj, "neg_zero", &value_double), "Negative zero found");
+        ASSERT(signbit(value_double), "Negative zero keeps its sign");
+
+        const char* out_of_range_cstrs[] = {
+            "{\"a\": 18446744073709551616}",
+            "{\"a\": -9223372036854775809}",
+            "{\"a\": 1e400}",
+        };
+        for (size_t i = 0; i < sizeof_array(out_of_range_cstrs); i++)
+        {
+            JsonObj out_of_range_obj;
+            ASSERT_ERR(JsonObj_new(out_of_range_cstrs[i], &out_of_range_obj), out_of_range_cstrs[i]);
+        }
+    }
+    PRINT_TEST_TITLE("Escape sequences");
+    {
+        const char* json_cstr
+            = "{\"plain\": \"text\", \"a\\\"b\": \"\\\"\\\\\\/\\b\\f\\n\\r\\t\","
+              " \"utf8\": \"caf\\u00e9 \\u20AC \\ud83d\\ude00\", \"lone\": \"\\ud83d!\","
+              " \"list\": [\"x\\ty\", \"a\\u0000b\"]}";
+        __autodestroy_json__ JsonObj json_obj;
+        String_empty(json_string);
+        const char* value_cstr;
+        JsonArray* json_array;
+        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Escaped strings parsed");
+        ASSERT_OK(Json_get(&json_obj, "plain", &value_cstr), "Plain string found");
+        ASSERT(
+            (value_cstr >= json_obj.json_cstr)
+                && (value_cstr < json_obj.json_cstr + json_obj.json_len),
+            "Plain string not copied");
+        ASSERT_OK(Json_get(&json_obj, "a\"b", &value_cstr), "Escaped key found unescaped");
+        ASSERT_EQ(value_cstr, "\"\\/\b\f\n\r\t", "Short escape sequences decoded");
+        ASSERT_OK(Json_get(&json_obj, "utf8", &value_cstr), "Unicode escapes found");
+        ASSERT_EQ(value_cstr, "caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80", "Unicode escapes decoded");
+        ASSERT_OK(Json_get(&json_obj, "lone", &value_cstr), "Lone surrogate found");
+        ASSERT_EQ(value_cstr, "\xef\xbf\xbd!", "Lone surrogate replaced");
+        ASSERT_OK(Json_get(&json_obj, "list", &json_array), "Array found");
+        ASSERT_OK(Json_get(json_array, 0, &value_cstr), "Escaped element found");
+        ASSERT_EQ(value_cstr, "x\ty", "Escaped element decoded");
+
+        JsonArrayCursor cursor = JsonArray_cursor(json_array);
+        const JsonValue* value_p;
+        JsonArrayCursor_next(&cursor, &value_p);
+        ASSERT(JsonArrayCursor_next(&cursor, &value_p), "String with a null char found");
+        ASSERT_EQ(value_p->cstr_len, 3, "Length includes the null char");
+        ASSERT_OK(JsonObj_to_string(&json_obj, &json_string), "Object serialized");
+        ASSERT(strstr(json_string.str, "\"a\\\"b\":\"\\\"\\\\/\\b\\f\\n\\r\\t\"") != NULL, "Escaped again");
+        ASSERT(strstr(json_string.str, "\"a\\u0000b\"") != NULL, "Null char escaped");
+        String_destroy(&json_string);
+
+        const char* invalid_cstrs[] = {"{\"a\": \"\\x\"}", "{\"a\": \"\\u12G4\"}", "{\"a\\q\": 1}"};
+        for (size_t i = 0; i < sizeof_array(invalid_cstrs); i++)
+        {
+            JsonObj invalid_obj;
+            ASSERT_ERR(JsonObj_new(invalid_cstrs[i], &invalid_obj), invalid_cstrs[i]);
+        }
+    }
+    PRINT_TEST_TITLE("Key interning");
+    {
+        __autodestroy_json_key_table__ JsonKeyTable key_table;
+        __autodestroy_json__ JsonObj json_obj_1;
+        __autodestroy_json__ JsonObj json_obj_2;
+        ASSERT_OK(JsonKeyTable_new(&key_table), "Key table created");
+        ASSERT_OK(
+            JsonObj_new_interned("{\"id\": 1, \"name\": \"a\", \"tags\": {\"id\": 2}}", &key_table, &json_obj_1),
+            "First object parsed");
+        ASSERT_OK(
+            JsonObj_new_interned("{\"name\": \"b\", \"i\\u0064\": 3}", &key_table, &json_obj_2),
+            "Second object parsed");
+        ASSERT_EQ(key_table.len, 3, "Each key stored once");
+        ASSERT(json_obj_1.root.next_sibling->key_p == json_obj_2.root.next_sibling->next_sibling->key_p, "Keys shared");
+
+        llu_t value_llu;
+        const char* value_cstr;
+        JsonItem* json_item;
+        ASSERT_OK(Json_get(&json_obj_2, "id", &value_llu), "Escaped key found");
+        ASSERT_EQ(value_llu, 3, "Escaped key correct");
+        ASSERT_OK(Json_get(&json_obj_2, "name", &value_cstr), "Key found");
+        ASSERT_EQ(value_cstr, "b", "Key correct");
+        ASSERT_ERR(Json_get(&json_obj_2, "tags", &json_item), "Key of another object missing");
+        ASSERT_ERR(Json_get(&json_obj_1, "unknown", &value_cstr), "Unknown key missing");
+        ASSERT_OK(Json_get(&json_obj_1, "tags", &json_item), "Nested object found");
+        ASSERT_OK(Json_get(json_item, "id", &value_llu), "Nested key found");
+        ASSERT_EQ(value_llu, 2, "Nested key correct");
+        ASSERT_OK(Json_insert(&json_obj_2, "added", 4), "Key inserted");
+        ASSERT_EQ(key_table.len, 4, "Inserted key stored");
+        ASSERT_OK(Json_get(&json_obj_2, "added", &value_llu), "Inserted key found");
+
+        char json_cstr[64];
+        for (size_t i = 0; i < 200; i++)
+        {
+            JsonObj json_obj;
+            sprintf(json_cstr, "{\"key_%zu\": %zu, \"id\": 0}", i, i);
+            ASSERT_OK(JsonObj_new_interned(json_cstr, &key_table, &json_obj), "Object parsed");
+            JsonObj_destroy(&json_obj);
+        }
+        ASSERT_EQ(key_table.len, 204, "Table grown");
+        ASSERT_OK(Json_get(&json_obj_1, "id", &value_llu), "Key found after growth");
+        ASSERT_EQ(value_llu, 1, "Key correct after growth");
+    }
+    PRINT_TEST_TITLE("Shape prediction");
+    {
+        __autodestroy_json_shape_cache__ JsonShapeCache shape_cache;
+        ASSERT_OK(JsonShapeCache_new(&shape_cache), "Shape cache created");
+        const char* json_cstrs[] = {
+            "{\"id\": 1, \"name\": \"a\", \"tags\": [1, 2], \"ok\": true}",
+            "{ \"id\" : 2 , \"name\" : \"b\" , \"tags\" : [] , \"ok\" : false }",
+            "{\"id\": 3, \"name\": \"c\", \"size\": 4, \"ok\": true}",
+            "{\"id\": 4, \"name\": \"d\", \"size\": 5, \"ok\": false, \"more\": null}",
+            "{\"id\": 5, \"name\": 6, \"size\": 7, \"ok\": true, \"more\": null}",
+            "{\"type\": \"other\"}",
+            "{\"i\\u0064\": 7, \"name\": 8, \"size\": 9, \"ok\": true, \"more\": null}",
+        };
+        const size_t expected_hits[]   = {0, 1, 1, 1, 1, 1, 1};
+        const size_t expected_misses[] = {1, 1, 2, 3, 4, 5, 6};
+        for (size_t i = 0; i < 7; i++)
+        {
+            __autodestroy_json__ JsonObj json_obj;
+            ASSERT_OK(JsonObj_new_shaped(json_cstrs[i], &shape_cache, &json_obj), "Object parsed");
+            ASSERT_EQ(shape_cache.hits, expected_hits[i], "Hits counted");
+            ASSERT_EQ(shape_cache.misses, expected_misses[i], "Misses counted");
+            if (i == 5)
+            {
+                continue;
+            }
+            llu_t value_llu;
+            bool value_bool;
+            ASSERT_OK(Json_get(&json_obj, "id", &value_llu), "First key found");
+            ASSERT_EQ(value_llu, i + 1, "First value correct");
+            ASSERT_OK(Json_get(&json_obj, "ok", &value_bool), "Last key found");
+            ASSERT_EQ(value_bool, (i % 2) == 0, "Last value correct");
+        }
+        __autodestroy_json__ JsonObj json_obj;
+        JsonObj invalid_json_obj;
+        JsonArray* json_array;
+        llu_t value_llu;
+        ASSERT_OK(JsonObj_new_shaped(json_cstrs[0], &shape_cache, &json_obj), "Object parsed");
+        ASSERT_OK(Json_get(&json_obj, "tags", &json_array), "Array found");
+        ASSERT_OK(Json_get(json_array, 1, &value_llu), "Element found");
+        ASSERT_EQ(value_llu, 2, "Element correct");
+        ASSERT_ERR(Json_get(&json_obj, "size", &value_llu), "Key of another shape missing");
+        ASSERT_ERR(
+            JsonObj_new_shaped("{\"id\": 1, \"name\" \"a\"}", &shape_cache, &invalid_json_obj),
+            "Invalid object with known shape detected");
+        ASSERT_ERR(
+            JsonObj_new_shaped("{\"id\": 1, \"name\": \"a\", }", &shape_cache, &invalid_json_obj),
+            "Trailing comma detected");
+    }
+    PRINT_TEST_TITLE("Validation only");
+    {
+        const char* valid_json_cstrs[] = {
+            "{}",
+            " [ ] ",
+            "{\"a\": [1, -2.5e3, \"x\\\"y\", true, false, null, {\"b\": {}}]}",
+            "[[[[[[[[[[]]]]]]]]]]",
+            "{\"big\": 123456789012345678901234567890}",
+        };
+        for (size_t i = 0; i < 5; i++)
+        {
+            size_t error_offset = 0;
+            ASSERT_OK(
+                JsonObj_validate(valid_json_cstrs[i], strlen(valid_json_cstrs[i]), &error_offset),
+                "Valid JSON accepted");
+        }
+        const char* invalid_json_cstrs[] = {
+            "{[}]",
+            "{\"a\": 1,}",
+            "[1 2]",
+            "{\"a\" 1}",
+            "\"top-level string\"",
+            "{\"a\": \"\\q\"}",
+            "{\"a\": 01}",
+            "[1] [2]",
+            "{\"a\": [1, 2}",
+            "  ",
+        };
+        const size_t expected_offsets[] = {1, 8, 3, 5, 0, 6, 7, 4, 11, 2};
+        for (size_t i = 0; i < 10; i++)
+        {
+            size_t error_offset = 0;
+            ASSERT_EQ(
+                JsonObj_validate(invalid_json_cstrs[i], strlen(invalid_json_cstrs[i]), &error_offset),
+                ERR_JSON_INVALID,
+                "Invalid JSON rejected");
+            ASSERT_EQ(error_offset, expected_offsets[i], "Error offset correct");
+        }
+        // Not null-terminated, as received from a socket.
+        const char json_chars[] = {'[', '1', ']', 'x'};
+        ASSERT_OK(JsonObj_validate(json_chars, 3, NULL), "Length respected");
+        ASSERT_EQ(JsonObj_validate(json_chars, 4, NULL), ERR_JSON_INVALID, "Trailing char rejected");
+        ASSERT_EQ(JsonObj_validate("", 0, NULL), ERR_EMPTY_STRING, "Empty input rejected");
+    }
+    PRINT_TEST_TITLE("SAX events");
+    {
+        const JsonSaxHandler handler = {
+            .on_object_begin = _test_sax_count,
+            .on_object_end   = _test_sax_count,
+            .on_array_begin  = _test_sax_count,
+            .on_array_end    = _test_sax_count,
+            .on_key          = _test_sax_key,
+            .on_cstr         = _test_sax_cstr,
+            .on_lld          = _test_sax_lld,
+            .on_llu          = _test_sax_llu,
+            .on_double       = _test_sax_double,
+        };
+        __autofree_cstr__ char* json_cstr = load_file_alloc("test/assets/test_json_vec_of_obj.json");
+        SaxTestContext context        = {0};
+        ASSERT_OK(Json_sax(json_cstr, &handler, &context), "Events reported");
+        ASSERT_EQ(context.num_of_events, 13, "Events counted");
+        ASSERT_EQ(context.num_of_containers, 8, "Containers counted");
+        ASSERT_EQ(context.close_sum, 446.1, "Values aggregated");
+
+        char json_chars[] = "[\"a\\u00e8\", \"\\n\", {\"x\": [1, -2, true, null]}, 3]";
+        context           = (SaxTestContext){0};
+        ASSERT_OK(Json_sax(json_chars, &handler, &context), "Callbacks may be missing");
+        ASSERT_EQ(context.text, "a\xc3\xa8\n", "Strings decoded");
+        ASSERT_EQ(context.num_of_events, 12, "Events of set callbacks counted");
+
+        char early_stop_chars[] = "[{\"a\": 1}, {\"b\": 2}, \"never\"]";
+        context                 = (SaxTestContext){.stop_after = 4};
+        ASSERT_EQ(Json_sax(early_stop_chars, &handler, &context), ERR_INTERRUPTION, "Stopped");
+        ASSERT_EQ(context.num_of_events, 4, "No event after stop");
+        ASSERT_EQ(context.text, "", "String after stop not reported");
+
+        char invalid_chars[] = "{\"a\": [1, 2}";
+        context              = (SaxTestContext){0};
+        ASSERT_EQ(Json_sax(invalid_chars, &handler, &context), ERR_JSON_INVALID, "Invalid input detected");
+        ASSERT_EQ(context.num_of_events, 5, "Events reported up to the error");
+
+        const char* scalar_cstrs[] = {"42", " \"x\"", "true", "null", ""};
+        for (size_t i = 0; i < sizeof_array(scalar_cstrs); i++)
+        {
+            char scalar_chars[8];
+            strcpy(scalar_chars, scalar_cstrs[i]);
+            context = (SaxTestContext){0};
+            ASSERT_EQ(Json_sax(scalar_chars, &handler, &context), ERR_JSON_INVALID, "Top-level scalar rejected");
+            ASSERT_EQ(context.num_of_events, 0, "Nothing reported for a top-level scalar");
+        }
+    }
+    PRINT_TEST_TITLE("Deep and long documents");
+    {
+        // As many nested objects as allowed: {"a":{"a":...{"a":1}...}}
+        const size_t depth    = JSON_MAX_DEPTH;
+        const size_t json_len = depth * 6 + 1;
+        char* json_cstr       = my_memory_malloc(__FILENAME__, __LINE__, json_len + 7);
+        for (size_t i = 0; i < depth; i++)
+        {
+            memcpy(&json_cstr[i * 5], "{\"a\":", 5);
+            json_cstr[json_len - 1 - i] = '}';
+        }
+        json_cstr[depth * 5] = '1';
+        json_cstr[json_len]  = '\0';
+        {
+            __autodestroy_json__ JsonObj json_obj;
+            __autodestroy_json_tape__ JsonTape json_tape;
+            String_empty(json_string);
+            ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Deepest object parsed");
+            JsonItem* json_item = NULL;
+            Error ret_err       = Json_get(&json_obj, "a", &json_item);
+            for (size_t i = 2; (i < depth) && is_ok(ret_err); i++)
+            {
+                ret_err = Json_get(json_item, "a", &json_item);
+            }
+            ASSERT_OK(ret_err, "Deepest object found");
+            llu_t value_llu;
+            ASSERT_OK(Json_get(json_item, "a", &value_llu), "Deepest value found");
+            ASSERT_EQ(value_llu, 1, "Deepest value correct");
+            ASSERT_OK(JsonObj_to_string(&json_obj, &json_string), "Deepest object serialized");
+            ASSERT_EQ(json_string.str, json_cstr, "Deepest object serialized correctly");
+            String_destroy(&json_string);
+            ASSERT_OK(JsonTape_new(json_cstr, &json_tape), "Deepest tape built");
+            ASSERT_EQ(json_tape.len, depth + 1, "Deepest tape length correct");
+        }
+        // One level more.
+        memmove(&json_cstr[5], json_cstr, json_len);
+        json_cstr[json_len + 5] = '}';
+        json_cstr[json_len + 6] = '\0';
+        size_t error_offset     = 0;
+        JsonObj json_obj;
+        ASSERT_ERR(JsonObj_new(json_cstr, &json_obj), "Too deep object rejected");
+        ASSERT_EQ(
+            JsonObj_validate(json_cstr, json_len + 6, &error_offset), ERR_JSON_INVALID, "Too deep");
+        ASSERT_EQ(error_offset, depth * 5, "First level too deep found");
+        my_memory_free(json_cstr);
+
+        // Long arrays of objects, whose items are siblings.
+        const size_t num_of_elements = 100000;
+        json_cstr = my_memory_malloc(__FILENAME__, __LINE__, num_of_elements * 16 + 16);
+        size_t len = (size_t)sprintf(json_cstr, "{\"v\": [");
+        for (size_t i = 0; i < num_of_elements; i++)
+        {
+            len += (size_t)sprintf(&json_cstr[len], "{\"i\": %zu},", i);
+        }
+        sprintf(&json_cstr[len - 1], "]}");
+        {
+            __autodestroy_json__ JsonObj long_json_obj;
+            JsonArray* json_array;
+            JsonItem* json_item;
+            llu_t value_llu;
+            ASSERT_OK(JsonObj_new(json_cstr, &long_json_obj), "Long array parsed");
+            ASSERT_OK(Json_get(&long_json_obj, "v", &json_array), "Long array found");
+            ASSERT_OK(Json_get(json_array, num_of_elements - 1, &json_item), "Last element found");
+            ASSERT_OK(Json_get(json_item, "i", &value_llu), "Last value found");
+            ASSERT_EQ(value_llu, num_of_elements - 1, "Last value correct");
+        }
+        my_memory_free(json_cstr);
+    }
+    PRINT_TEST_TITLE("Several keys at once");
+    {
+        const char* json_cstr = "{\"a\": 1, \"b\": \"two\", \"c\": -3, \"d\": [4], \"e\": {\"f\": 5.5}, "
+                                "\"g\": true, \"a\": 0}";
+        lld_t value_lld       = 0;
+        llu_t value_llu       = 0;
+        double value_double   = 0;
+        bool value_bool       = false;
+        const char* value_cstr;
         JsonItem* json_item;
         JsonArray* json_array;
-        JsonArray* json_array_2;
-        llu_t value_llu;
-        const char* value_cstr;
-        double value_double;
-        bool value_bool;
-        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Json object created");
-        Json_get(&json_obj, "array_key", &json_array);
-        ASSERT_EQ(json_array != NULL, true, "Array found as root element.");
-        Json_get(json_array, 0, &json_item);
-        ASSERT_EQ(json_item != NULL, true, "First array element is an item.");
-        Json_get(json_item, "inner array 1", &json_array_2);
-        Json_get(json_array_2, 0, &value_llu);
-        ASSERT_EQ(value_llu, 12314, "Value LLU found");
-        Json_get(json_array_2, 1, &value_double);
-        ASSERT_EQ(value_double, -32.4, "Value DOUBLE found");
-        Json_get(json_array_2, 2, &value_bool);
-        ASSERT_EQ(value_bool, true, "Value TRUE found");
-        Json_get(json_array, 1, &json_item);
-        ASSERT_EQ(json_item != NULL, true, "Second array element is an item.");
-        Json_get(json_item, "inner array 2", &json_array_2);
-        Json_get(json_array_2, 0, &value_double);
-        ASSERT_EQ(value_double, 1.4, "Value DOUBLE found");
-        Json_get(json_array_2, 1, &value_cstr);
-        ASSERT_EQ(value_cstr, "hello", "Value STRING found");
-        Json_get(json_array_2, 2, &value_bool);
-        ASSERT_EQ(value_bool, false, "Value FALSE found");
+        const char* keys[]     = {"g", "e", "d", "c", "b", "a"};
+        const ValueType types[] = {VALUE_BOOL, VALUE_ITEM, VALUE_ARRAY, VALUE_LLD, VALUE_CSTR, VALUE_LLU};
+        void* outs[] = {&value_bool, &json_item, &json_array, &value_lld, &value_cstr, &value_llu};
+        for (size_t i = 0; i < 2; i++)
+        {
+            __autodestroy_json__ JsonObj json_obj;
+            if (i == 0)
+            {
+                ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Object parsed");
+            }
+            else
+            {
+                ASSERT_OK(JsonObj_new_lazy(json_cstr, &json_obj), "Object parsed lazily");
+            }
+            ASSERT_OK(Json_get_many(&json_obj, keys, types, outs, 6), "All keys found");
+            ASSERT_EQ(value_bool, true, "Bool correct");
+            ASSERT_EQ(value_lld, -3, "Signed integer correct");
+            ASSERT_EQ(value_cstr, "two", "String correct");
+            ASSERT_EQ(value_llu, 1, "First of duplicate keys wins");
+            ASSERT_EQ(JsonArray_len(json_array), 1, "Array correct");
+            ASSERT_OK(Json_get(json_item, "f", &value_double), "Object correct");
+            ASSERT_EQ(value_double, 5.5, "Nested value correct");
+
+            const char* nested_keys[]     = {"f"};
+            const ValueType nested_types[] = {VALUE_DOUBLE};
+            void* nested_outs[]           = {&value_double};
+            value_double                  = 0;
+            ASSERT_OK(Json_get_many(json_item, nested_keys, nested_types, nested_outs, 1), "Item searched");
+            ASSERT_EQ(value_double, 5.5, "Nested value found");
+        }
+        __autodestroy_json__ JsonObj json_obj;
+        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Object parsed");
+        const char* missing_keys[]     = {"c", "z"};
+        const ValueType missing_types[] = {VALUE_DOUBLE, VALUE_LLU};
+        void* missing_outs[]           = {&value_double, &value_llu};
+        ASSERT_EQ(
+            Json_get_many(&json_obj, missing_keys, missing_types, missing_outs, 2),
+            ERR_JSON_MISSING_ENTRY,
+            "Missing key reported");
+        ASSERT_EQ(value_double, -3.0, "Found keys stored anyway");
+        const char* mismatch_keys[]     = {"b", "a"};
+        const ValueType mismatch_types[] = {VALUE_LLU, VALUE_DOUBLE};
+        void* mismatch_outs[]           = {&value_llu, &value_double};
+        ASSERT_EQ(
+            Json_get_many(&json_obj, mismatch_keys, mismatch_types, mismatch_outs, 2),
+            ERR_TYPE_MISMATCH,
+            "Type mismatch reported");
+        ASSERT_EQ(value_double, 1.0, "Matching keys stored anyway");
+        const char* duplicate_keys[] = {"a", "a"};
+        ASSERT_EQ(
+            Json_get_many(&json_obj, duplicate_keys, mismatch_types, mismatch_outs, 2),
+            ERR_INVALID,
+            "Duplicate keys rejected");
+        ASSERT_EQ(Json_get_many(&json_obj, keys, types, outs, 65), ERR_INVALID, "Too many keys rejected");
     }
-    PRINT_TEST_TITLE("test_json_array_3.json");
+    PRINT_TEST_TITLE("Doubles in any locale");
     {
+        const char* locales[] = {"de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "it_IT.UTF-8", "ru_RU.UTF-8"};
+        const char* locale_p  = NULL;
+        for (size_t i = 0; (i < sizeof_array(locales)) && (locale_p == NULL); i++)
+        {
+            locale_p = setlocale(LC_NUMERIC, locales[i]);
+        }
+        if (locale_p == NULL)
+        {
+            LOG_WARNING("No locale with a decimal comma: testing with the current one only");
+        }
+        __autodestroy_json_writer__ JsonWriter writer;
+        String_empty(json_string);
+        const double values[] = {1.5, -0.0, 5e-324, 1.7976931348623157e308, 1e-5, 123456.789, 1e15, 0.3};
+        ASSERT_OK(JsonWriter_new(&writer), "Writer created");
+        JsonWriter_begin_array(&writer);
+        for (size_t i = 0; i < sizeof_array(values); i++)
+        {
+            JsonWriter_value(&writer, values[i]);
+        }
+        JsonWriter_end_array(&writer);
+        ASSERT_OK(JsonWriter_to_string(&writer, &json_string), "Document written");
+        ASSERT_EQ(
+            json_string.str,
+            "[1.5,-0.0,5.0e-324,1.7976931348623157e+308,1.0e-05,123456.789,1.0e+15,0.3]",
+            "Shortest digits with a decimal point");
         __autodestroy_json__ JsonObj json_obj;
-        JsonItem* json_item;
-        const char* value_cstr;
-        llu_t value_llu;
         JsonArray* json_array;
-        __autofree_cstr__ char* json_cstr = load_file_alloc("test/assets/test_json_array_3.json");
-        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Json object created");
-        ASSERT(Json_get(&json_obj, "Snapshot", &json_item) == ERR_ALL_GOOD, "Ok");
-        ASSERT(Json_get(json_item, "Value", &value_llu) == ERR_ALL_GOOD, "Ok");
-        ASSERT(Json_get(json_item, "Data", &json_array) == ERR_ALL_GOOD, "Ok");
-        ASSERT(Json_get(json_array, 0, &json_item) == ERR_ALL_GOOD, "Ok");
-        ASSERT(Json_get(json_item, "Time", &value_cstr) == ERR_ALL_GOOD, "Ok");
-        ASSERT_EQ(value_cstr, "2021-07-23T08:09:00.000000Z", "Time correct.");
+        double value_double;
+        bool all_equal = true;
+        ASSERT_OK(JsonObj_new(json_string.str, &json_obj), "Document parsed back");
+        ASSERT_OK(JsonObj_get_array(&json_obj, &json_array), "Array found");
+        for (size_t i = 0; i < sizeof_array(values); i++)
+        {
+            all_equal = all_equal && is_ok(Json_get(json_array, i, &value_double)) && (value_double == values[i]);
+        }
+        ASSERT(all_equal, "Doubles read back exactly");
+        String_destroy(&json_string);
+
+        // Longer than any buffer, and past the fast conversions: halfway between two doubles, with
+        // the digit deciding the rounding far away, and the 17 digits of a subnormal.
+        __autodestroy_json__ JsonObj long_json_obj;
+        ASSERT_OK(
+            JsonObj_new(
+                "{\"a\": 0.1000000000000000000000000000001, \"b\": 9007199254740993.000000000000000000001,"
+                " \"c\": 2.2250738585072011e-308, \"d\": 1.00000000000000011102230246251565404236316680908203125}",
+                &long_json_obj),
+            "Document with long numbers parsed");
+        ASSERT_OK(Json_get(&long_json_obj, "a", &value_double), "Long number found");
+        ASSERT_EQ(value_double, 0.1, "Long number correct");
+        ASSERT_OK(Json_get(&long_json_obj, "b", &value_double), "Number past halfway found");
+        ASSERT_EQ(value_double, 9007199254740994.0, "Number past halfway rounded up");
+        ASSERT_OK(Json_get(&long_json_obj, "c", &value_double), "Subnormal found");
+        ASSERT_EQ(value_double, 0x0.FFFFFFFFFFFFFp-1022, "Subnormal correct");
+        ASSERT_OK(Json_get(&long_json_obj, "d", &value_double), "Exact halfway found");
+        ASSERT_EQ(value_double, 1.0, "Exact halfway rounded to even");
+        setlocale(LC_NUMERIC, "C");
     }
-    PRINT_TEST_TITLE("test_json_array_4.json");
+    PRINT_TEST_TITLE("Concurrent lookups");
     {
-        JsonObj json_obj;
-        llu_t value_llu;
-        JsonArray* json_array;
-        bool value_bool;
-        __autofree_cstr__ char* json_cstr = load_file_alloc("test/assets/test_json_array_4.json");
-        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Json object created");
-        ASSERT_OK(Json_get(&json_obj, "array_key1", &json_array), "Ok");
-        ASSERT_OK(Json_get(json_array, 0, &value_llu), "Ok");
-        ASSERT_EQ(value_llu, 32, "Ok");
-        ASSERT_OK(Json_get(json_array, 1, &value_bool), "Ok");
-        ASSERT_EQ(value_bool, false, "Ok");
-        ASSERT_OK(Json_get(&json_obj, "array_key2", &json_array), "Ok");
-        ASSERT_OK(Json_get(json_array, 0, &value_llu), "Ok");
-        ASSERT_EQ(value_llu, 33, "Ok");
-        ASSERT_OK(Json_get(json_array, 1, &value_bool), "Ok");
-        ASSERT_EQ(value_bool, true, "Ok");
-        ASSERT_OK(Json_get(&json_obj, "key", &value_llu), "Ok");
-        ASSERT_EQ(value_llu, 34, "Ok");
-        JsonObj_destroy(&json_obj);
+        const size_t num_of_threads       = 8;
+        __autofree_cstr__ char* json_cstr = my_memory_malloc(__FILE__, __LINE__, 1 << 16);
+        char* curr_p                      = json_cstr + sprintf(json_cstr, "{");
+        for (size_t i = 0; i < TEST_SHARED_NUM_OF_MEMBERS; i++)
+        {
+            curr_p += sprintf(curr_p, "%s\"key_%zu\": {", i ? ", " : "", i);
+            for (size_t j = 0; j < 20; j++)
+            {
+                curr_p += sprintf(curr_p, "\"member_%zu\": %zu, ", j, j);
+            }
+            curr_p += sprintf(curr_p, "\"array\": [");
+            for (size_t j = 0; j < 31; j++)
+            {
+                curr_p += sprintf(curr_p, "%zu, ", j);
+            }
+            curr_p += sprintf(curr_p, "%zu]}", i);
+        }
+        sprintf(curr_p, "}");
+        // Indexes, offset tables and lazy values are built by whichever thread gets there first.
+        for (size_t round = 0; round < 10; round++)
+        {
+            __autodestroy_json__ JsonObj json_obj;
+            ASSERT_OK(JsonObj_new_lazy(json_cstr, &json_obj), "Shared object parsed");
+            pthread_t threads[num_of_threads];
+            for (size_t k = 0; k < num_of_threads; k++)
+            {
+                pthread_create(&threads[k], NULL, _test_lookup_shared, &json_obj);
+            }
+            size_t num_of_found = 0;
+            for (size_t k = 0; k < num_of_threads; k++)
+            {
+                void* thread_found_p;
+                pthread_join(threads[k], &thread_found_p);
+                num_of_found += (size_t)thread_found_p;
+            }
+            ASSERT_EQ(
+                num_of_found, num_of_threads * TEST_SHARED_NUM_OF_MEMBERS, "All threads found all");
+        }
     }
-    PRINT_TEST_TITLE("Testing test/assets/test_json.json");
+    PRINT_TEST_TITLE("Long string in many chunks");
     {
-        __autodestroy_json__ JsonObj json_obj;
-        JsonItem* json_item;
-        const char* value_cstr;
-        llu_t value_llu;
-        double value_double;
-        bool value_bool;
-        JsonArray* json_array;
-        __autofree_cstr__ char* json_cstr = load_file_alloc("test/assets/test_json.json");
-        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Json object created");
-        Json_get(&json_obj, "text_key", &value_cstr);
-        ASSERT_EQ("text_value", value_cstr, "String*value found in first item");
+        // A string 16 times longer takes 16 times as long, or 256 times if it were scanned from its
+        // start at every chunk.
+        const double short_time = _test_feed_long_string(1 << 18);
+        const double long_time  = _test_feed_long_string(1 << 22);
+        ASSERT(short_time >= 0, "Short string parsed");
+        ASSERT(long_time >= 0, "Long string parsed");
+        ASSERT(long_time < 48 * short_time + 0.01, "Time grows linearly with the length");
+    }
+    /**/
+}
+#endif /* _TEST */
 
-        Json_get(&json_obj, "text_sibling", &value_cstr);
-        ASSERT_EQ("sibling_value", value_cstr, "String*value found in sibling");
+#ifdef _BENCHMARK
+// Bytes parsed per document and measurement, from which the number of iterations is derived.
+#define JSON_BENCHMARK_BYTES (64 << 20)
+#define JSON_BENCHMARK_MIN_ITERATIONS (10)
+#define JSON_BENCHMARK_MAX_ITERATIONS (200000)
 
-        Json_get(&json_obj, "nested_1", &json_item);
-        ASSERT_EQ(json_item->key_p, "object_1.1", "Found nested object key");
+typedef struct
+{
+    const char* name;
+    String json_string;
+} JsonBenchmarkDocument;
 
-        Json_get(json_item, "object_1.1", &value_cstr);
-        ASSERT_EQ(value_cstr, "item_1.1", "Found nested object value");
-        Json_get(json_item, "object_1.2", &value_cstr);
-        ASSERT_EQ(value_cstr, "item_1.2", "Found nested sibling object value");
-        ASSERT(
-            Json_get(json_item, "object_32", &value_cstr) == ERR_JSON_MISSING_ENTRY,
-            "Object not found");
-        ASSERT(value_cstr == NULL, "Null returned.");
+static uint64_t _json_benchmark_now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
 
-        Json_get(&json_obj, "nested_2", &json_item);
-        Json_get(json_item, "object_2.1", &value_cstr);
-        ASSERT_EQ(value_cstr, "item_2.1", "Found nested object value");
-        Json_get(json_item, "object_2.2", &json_item);
-        ASSERT_EQ(json_item->key_p, "item_2.2", "Found nested object key");
-        Json_get(json_item, "item_2.2", &value_cstr);
-        ASSERT_EQ(value_cstr, "value_2.2.1", "Found nested sibling object value");
+// Print a measurement as one line of JSON: `ops` is the number of lookups or elements visited per
+// iteration. Throughput, in MB/s of the document, is only reported for parsing, which reads it all.
+static void _json_benchmark_report(
+    const JsonBenchmarkDocument* document_p,
+    const char* operation,
+    size_t iterations,
+    size_t ops,
+    uint64_t elapsed_ns)
+{
+    JsonWriter writer;
+    String line_string;
+    const double json_len = (double)document_p->json_string.length;
+    if (elapsed_ns == 0)
+    {
+        elapsed_ns = 1;
+    }
+    JsonWriter_new(&writer);
+    JsonWriter_begin_object(&writer);
+    JsonWriter_key(&writer, "document");
+    JsonWriter_cstr(&writer, document_p->name);
+    JsonWriter_key(&writer, "operation");
+    JsonWriter_cstr(&writer, operation);
+    JsonWriter_key(&writer, "bytes");
+    JsonWriter_llu(&writer, document_p->json_string.length);
+    JsonWriter_key(&writer, "iterations");
+    JsonWriter_llu(&writer, iterations);
+    JsonWriter_key(&writer, "ops");
+    JsonWriter_llu(&writer, ops);
+    JsonWriter_key(&writer, "ns_per_doc");
+    JsonWriter_double(&writer, (double)elapsed_ns / (double)iterations);
+    JsonWriter_key(&writer, "ns_per_op");
+    JsonWriter_double(&writer, (double)elapsed_ns / (double)(iterations * (ops ? ops : 1)));
+    if (strcmp(operation, "parse") == 0)
+    {
+        JsonWriter_key(&writer, "mb_per_s");
+        JsonWriter_double(&writer, json_len * (double)iterations * 1e3 / (double)elapsed_ns);
+    }
+    JsonWriter_end_object(&writer);
+    if (is_ok(JsonWriter_to_string(&writer, &line_string)))
+    {
+        printf("%s\n", line_string.str);
+        fflush(stdout);
+        String_destroy(&line_string);
+    }
+    JsonWriter_destroy(&writer);
+}
 
-        PRINT_TEST_TITLE("Test integer");
-        Json_get(&json_obj, "test_integer", &value_llu);
-        ASSERT_EQ(value_llu, 435234, "Integer found and read correctly");
+// Look up `key` through the public getter matching `value_type`, as a user of the object would.
+static bool _json_benchmark_get(JsonObj* json_obj_p, const char* key, ValueType value_type)
+{
+    const char* value_cstr;
+    lld_t value_lld;
+    llu_t value_llu;
+    double value_double;
+    bool value_bool;
+    JsonItem* json_item_p;
+    JsonArray* json_array_p;
+    switch (value_type)
+    {
+    case VALUE_CSTR:
+        return is_ok(Json_get(json_obj_p, key, &value_cstr));
+    case VALUE_LLD:
+        return is_ok(Json_get(json_obj_p, key, &value_lld));
+    case VALUE_LLU:
+        return is_ok(Json_get(json_obj_p, key, &value_llu));
+    case VALUE_DOUBLE:
+        return is_ok(Json_get(json_obj_p, key, &value_double));
+    case VALUE_BOOL:
+        return is_ok(Json_get(json_obj_p, key, &value_bool));
+    case VALUE_ITEM:
+        return is_ok(Json_get(json_obj_p, key, &json_item_p));
+    case VALUE_ARRAY:
+        return is_ok(Json_get(json_obj_p, key, &json_array_p));
+    default:
+        return false;
+    }
+}
 
-        PRINT_TEST_TITLE("Test double");
-        Json_get(&json_obj, "test_double", &value_double);
-        ASSERT_EQ(value_double, 435.234, "Float found and read correctly");
+// Measure parsing and destruction separately, then lookups of every top-level key and the visit of
+// the first array found at the top level, if any. Null values have no getter, hence their keys are
+// not looked up.
+static void _json_benchmark_run(const JsonBenchmarkDocument* document_p)
+{
+    const size_t json_len = document_p->json_string.length;
+    size_t iterations     = JSON_BENCHMARK_BYTES / json_len;
+    if (iterations < JSON_BENCHMARK_MIN_ITERATIONS)
+    {
+        iterations = JSON_BENCHMARK_MIN_ITERATIONS;
+    }
+    else if (iterations > JSON_BENCHMARK_MAX_ITERATIONS)
+    {
+        iterations = JSON_BENCHMARK_MAX_ITERATIONS;
+    }
+    uint64_t parse_ns   = 0;
+    uint64_t destroy_ns = 0;
+    JsonObj json_obj;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        const uint64_t start_ns = _json_benchmark_now_ns();
+        if (is_err(JsonObj_new(document_p->json_string.str, &json_obj)))
+        {
+            LOG_ERROR("Failed to parse `%s`", document_p->name);
+            return;
+        }
+        const uint64_t parsed_ns = _json_benchmark_now_ns();
+        JsonObj_destroy(&json_obj);
+        parse_ns += parsed_ns - start_ns;
+        destroy_ns += _json_benchmark_now_ns() - parsed_ns;
+    }
+    _json_benchmark_report(document_p, "parse", iterations, 1, parse_ns);
+    _json_benchmark_report(document_p, "destroy", iterations, 1, destroy_ns);
 
-        PRINT_TEST_TITLE("Test bool true");
-        Json_get(&json_obj, "test_bool_true", &value_bool);
-        ASSERT_EQ(value_bool, true, "Boolean found and read correctly");
+    JsonObj_new(document_p->json_string.str, &json_obj);
+    const JsonItem* first_item_p  = json_obj.root.next_sibling;
+    const JsonArray* json_array_p = NULL;
+    size_t num_of_keys            = 0;
+    for (const JsonItem* item_p = first_item_p; item_p != NULL; item_p = item_p->next_sibling)
+    {
+        num_of_keys += (item_p->key_p != NULL) && (item_p->value.value_type != VALUE_NULL);
+        if ((json_array_p == NULL) && (item_p->value.value_type == VALUE_ARRAY))
+        {
+            json_array_p = item_p->value.value_array_p;
+        }
+    }
+    if (num_of_keys > 0)
+    {
+        size_t num_of_found     = 0;
+        const uint64_t start_ns = _json_benchmark_now_ns();
+        for (size_t i = 0; i < iterations; i++)
+        {
+            const JsonItem* item_p = first_item_p;
+            for (; item_p != NULL; item_p = item_p->next_sibling)
+            {
+                if ((item_p->key_p != NULL) && (item_p->value.value_type != VALUE_NULL))
+                {
+                    num_of_found += _json_benchmark_get(
+                        &json_obj, item_p->key_p, item_p->value.value_type);
+                }
+            }
+        }
+        const uint64_t elapsed_ns = _json_benchmark_now_ns() - start_ns;
+        if (num_of_found != num_of_keys * iterations)
+        {
+            LOG_ERROR("Lookups failed in `%s`", document_p->name);
+        }
+        _json_benchmark_report(document_p, "lookup", iterations, num_of_keys, elapsed_ns);
+    }
+    if (json_array_p != NULL)
+    {
+        size_t num_of_visited   = 0;
+        const uint64_t start_ns = _json_benchmark_now_ns();
+        for (size_t i = 0; i < iterations; i++)
+        {
+            JsonArrayCursor cursor = JsonArray_cursor(json_array_p);
+            const JsonValue* json_value_p;
+            while (JsonArrayCursor_next(&cursor, &json_value_p))
+            {
+                num_of_visited += (json_value_p->value_type != VALUE_UNDEFINED);
+            }
+        }
+        const uint64_t elapsed_ns = _json_benchmark_now_ns() - start_ns;
+        _json_benchmark_report(
+            document_p, "iterate", iterations, num_of_visited / iterations, elapsed_ns);
+    }
+    JsonObj_destroy(&json_obj);
+}
 
-        PRINT_TEST_TITLE("Test bool false");
-        Json_get(&json_obj, "test_bool_false", &value_bool);
-        ASSERT_EQ(value_bool, false, "Boolean found and read correctly");
+// A large object whose main member is an array of records of mixed types.
+static void _json_benchmark_generate_large(JsonWriter* writer_p)
+{
+    char name[32];
+    JsonWriter_begin_object(writer_p);
+    JsonWriter_key(writer_p, "source");
+    JsonWriter_cstr(writer_p, "benchmark");
+    JsonWriter_key(writer_p, "records");
+    JsonWriter_begin_array(writer_p);
+    for (size_t i = 0; i < 20000; i++)
+    {
+        snprintf(name, sizeof(name), "user_%zu", i);
+        JsonWriter_begin_object(writer_p);
+        JsonWriter_key(writer_p, "id");
+        JsonWriter_llu(writer_p, i);
+        JsonWriter_key(writer_p, "name");
+        JsonWriter_cstr(writer_p, name);
+        JsonWriter_key(writer_p, "score");
+        JsonWriter_double(writer_p, (double)i * 0.37);
+        JsonWriter_key(writer_p, "delta");
+        JsonWriter_lld(writer_p, -(lld_t)i);
+        JsonWriter_key(writer_p, "active");
+        JsonWriter_bool(writer_p, (i % 3) == 0);
+        JsonWriter_key(writer_p, "tags");
+        JsonWriter_begin_array(writer_p);
+        JsonWriter_cstr(writer_p, "alpha");
+        JsonWriter_cstr(writer_p, "beta");
+        JsonWriter_end_array(writer_p);
+        JsonWriter_end_object(writer_p);
+    }
+    JsonWriter_end_array(writer_p);
+    JsonWriter_key(writer_p, "count");
+    JsonWriter_llu(writer_p, 20000);
+    JsonWriter_end_object(writer_p);
+}
 
-        Json_get(&json_obj, "test_array", &json_array);
-        Json_get(json_array, 0, &value_llu);
-        ASSERT_EQ(value_llu, 14352, "Array element of type INT read correctly");
-        Json_get(json_array, 1, &value_double);
-        ASSERT_EQ(value_double, 2.15, "Array element of type DOUBLE read correctly");
-        Json_get(json_array, 2, &value_cstr);
-        ASSERT_EQ(value_cstr, "string_element", "Array element of type C-string read correctly");
+// Objects and arrays nested as deep as allowed.
+static void _json_benchmark_generate_deep(JsonWriter* writer_p)
+{
+    JsonWriter_begin_object(writer_p);
+    for (size_t i = 1; i < JSON_MAX_DEPTH; i++)
+    {
+        if (i % 2)
+        {
+            JsonWriter_key(writer_p, "next");
+            JsonWriter_begin_array(writer_p);
+        }
+        else
+        {
+            JsonWriter_begin_object(writer_p);
+        }
     }
-    PRINT_TEST_TITLE("Invalid JSON string - empty");
+    for (size_t i = JSON_MAX_DEPTH - 1; i > 0; i--)
     {
-        JsonObj json_obj;
-        char* json_cstr = "";
-        ASSERT(JsonObj_new(json_cstr, &json_obj) == ERR_EMPTY_STRING, "Empty JSON fails to initialize.");
+        if (i % 2)
+        {
+            JsonWriter_end_array(writer_p);
+        }
+        else
+        {
+            JsonWriter_end_object(writer_p);
+        }
     }
-    PRINT_TEST_TITLE("Invalid JSON string - string not starting with '{'");
-    { // TODO: crate token analyzer and add TC's.
-        JsonObj json_obj;
-        char* json_cstr = "This is not a JSON file";
-        ASSERT(JsonObj_new(json_cstr, &json_obj) == ERR_JSON_INVALID, "Invalid JSON fails to initialize.");
+    JsonWriter_end_object(writer_p);
+}
+
+// Many members with long strings, some of which need escaping.
+static void _json_benchmark_generate_strings(JsonWriter* writer_p)
+{
+    char key[32];
+    char value[256];
+    JsonWriter_begin_object(writer_p);
+    for (size_t i = 0; i < 2000; i++)
+    {
+        snprintf(key, sizeof(key), "key_%zu", i);
+        for (size_t j = 0; j < sizeof(value) - 1; j++)
+        {
+            value[j] = (char)('a' + (i + j) % 26);
+        }
+        value[sizeof(value) - 1] = '\0';
+        if (i % 4 == 0)
+        {
+            memcpy(&value[100], "\"quoted\"\n\t\\", 11);
+        }
+        JsonWriter_key(writer_p, key);
+        JsonWriter_cstr(writer_p, value);
     }
-    PRINT_TEST_TITLE("Fixed memory leak");
+    JsonWriter_end_object(writer_p);
+}
+
+void benchmark_class_json(void)
+{
+    const char* asset_names[] = {
+        "test_json",
+        "test_json_numbers",
+        "test_json_vec_of_obj",
+        "test_json_vector",
+    };
+    void (*const generators[])(JsonWriter*) = {
+        _json_benchmark_generate_large,
+        _json_benchmark_generate_deep,
+        _json_benchmark_generate_strings,
+    };
+    const char* generated_names[] = {"generated_large", "generated_deep", "generated_strings"};
+    char path[PATH_MAX];
+    for (size_t i = 0; i < sizeof_array(asset_names); i++)
     {
-        JsonArray* json_array;
-        const char* value_cstr;
-        const char* json_char_p = "{\"request\":[\"Required parameter is missing\"]}";
-        __autodestroy_json__ JsonObj json_with_vector_obj;
-        ASSERT(is_ok(JsonObj_new(json_char_p, &json_with_vector_obj)), "Json object created");
-        Json_get(&json_with_vector_obj, "request", &json_array);
-        Json_get(json_array, 0, &value_cstr);
-        ASSERT_EQ(value_cstr, "Required parameter is missing", "");
+        JsonBenchmarkDocument document = {.name = asset_names[i]};
+        snprintf(path, sizeof(path), "test/assets/%s.json", asset_names[i]);
+        if (is_err(fs_read_to_string(path, &document.json_string)))
+        {
+            LOG_ERROR("Failed to read `%s`", path);
+            continue;
+        }
+        _json_benchmark_run(&document);
+        String_destroy(&document.json_string);
     }
-    PRINT_TEST_TITLE("Data conversion");
+    for (size_t i = 0; i < sizeof_array(generators); i++)
     {
-        __autodestroy_json__ JsonObj json_obj;
-        llu_t value_llu;
-        lld_t value_lld;
-        __autofree_cstr__ char* json_cstr = load_file_alloc("test/assets/test_json_numbers.json");
-        ASSERT_OK(JsonObj_new(json_cstr, &json_obj), "Json object created");
-        Json_get(&json_obj, "value_positive_lld", &value_llu);
-        ASSERT_EQ((llu_t)23, value_llu, "Conversion from INT to LLU successfull");
-        Json_get(&json_obj, "value_small_llu", &value_lld);
-        ASSERT_EQ((lld_t)43, value_lld, "Conversion from LLU to INT successfull");
-        ASSERT(Json_get(&json_obj, "value_negative_lld", &value_llu) == ERR_INVALID, "Conversion from negative INT to LLU failed");
-        ASSERT(Json_get(&json_obj, "value_large_llu", &value_lld) == ERR_INVALID, "Conversion from large LLU to INT failed");
+        JsonBenchmarkDocument document = {.name = generated_names[i]};
+        JsonWriter writer;
+        JsonWriter_new(&writer);
+        generators[i](&writer);
+        if (is_ok(JsonWriter_to_string(&writer, &document.json_string)))
+        {
+            _json_benchmark_run(&document);
+            String_destroy(&document.json_string);
+        }
+        JsonWriter_destroy(&writer);
     }
-    /**/
 }
-#endif /* _TEST */
+#endif /* _BENCHMARK */
@@ -27,3 +27,11 @@ int main(void)
 }
 #endif /* _MODULE */
 #endif /* _TEST */
+
+#ifdef _BENCHMARK
+int main(void)
+{
+    logger_init(NULL, NULL);
+    benchmark_class_json();
+}
+#endif /* _BENCHMARK */
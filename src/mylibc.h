@@ -1,8 +1,10 @@
 #ifndef MYLIBC_H
 #define MYLIBC_H
 #include <stdbool.h>
+#include <stddef.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#include <time.h>
 #include <errno.h>
 #include <limits.h>
 #include <pthread.h>
@@ -13,6 +15,8 @@
 #include <ctype.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <math.h>
+#include <locale.h>
 #include <dirent.h>
 #include <sys/stat.h>
 #include <sys/errno.h>
@@ -22,10 +26,14 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/select.h>
+#include <sys/mman.h>
 #ifdef __linux__
 #include <sys/sendfile.h>
 #include <sys/file.h>
 #endif /* __linux__ */
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif /* __x86_64__ || __i386__ */
 
 #define UNUSED(x) (void)(x)
 #define __FILENAME__ (strrchr(__FILE__, '/') ? strrchr(__FILE__, '/') + 1 : __FILE__)
@@ -34,6 +42,13 @@
 #define __autofree__ __attribute__((cleanup(my_memory_free)))
 #define __autofree_cstr__ __attribute__((cleanup(my_memory_free_cstr)))
 #define __autodestroy_json__ __attribute__((cleanup(JsonObj_destroy)))
+#define __autodestroy_json_reader__ __attribute__((cleanup(JsonReader_destroy)))
+#define __autodestroy_json_parser__ __attribute__((cleanup(JsonParser_destroy)))
+#define __autodestroy_json_writer__ __attribute__((cleanup(JsonWriter_destroy)))
+#define __autodestroy_json_path__ __attribute__((cleanup(JsonPath_destroy)))
+#define __autodestroy_json_tape__ __attribute__((cleanup(JsonTape_destroy)))
+#define __autodestroy_json_key_table__ __attribute__((cleanup(JsonKeyTable_destroy)))
+#define __autodestroy_json_shape_cache__ __attribute__((cleanup(JsonShapeCache_destroy)))
 
 #define TCP_MAX_MSG_LEN 65535
 #define TCP_MAX_CONNECTIONS 1023
@@ -273,6 +288,11 @@ void test_hashmap(void);
 
 #endif
 
+#ifdef _BENCHMARK
+// Print one line of JSON per measurement on stdout.
+void benchmark_class_json(void);
+#endif /* _BENCHMARK */
+
 #define SET_MISSING_ENTRY(result, bool_value, success_string) \
     if (is_err(result))                                       \
     {                                                         \
@@ -296,12 +316,15 @@ typedef enum
     VALUE_CSTR,
     VALUE_ARRAY,
     VALUE_ITEM,
+    VALUE_NULL,
+    VALUE_LAZY, // Object or array not built yet, see `JsonObj_new_lazy()`.
     VALUE_INVALID,
 } ValueType;
 
 typedef struct JsonValue
 {
     ValueType value_type;
+    uint32_t cstr_len; // Length of `value_cstr`, which fits in the padding.
     union
     {
         lld_t value_lld;                 // leaf lld_t
@@ -314,6 +337,12 @@ typedef struct JsonValue
     };
 } JsonValue;
 
+// Maximum nesting level of JSON objects and arrays. Parsing, lookups and destruction do not
+// recurse, hence deeper documents only cost one bit per level to the tokenizer.
+#ifndef JSON_MAX_DEPTH
+#define JSON_MAX_DEPTH (512)
+#endif
+
 typedef struct JsonItem
 {
     const char* key_p;
@@ -323,19 +352,282 @@ typedef struct JsonItem
     struct JsonItem* next_sibling;
 } JsonItem;
 
+typedef struct JsonArenaChunk JsonArenaChunk;
+
+typedef struct JsonKeyTable JsonKeyTable;
+
+// Owns the memory of all the items of a `JsonObj`, which is released in one go.
+typedef struct JsonArena
+{
+    JsonArenaChunk* chunk_p;
+    size_t next_chunk_size;
+    JsonKeyTable* key_table_p; // Where the keys are stored, if not in the input.
+    struct JsonShapeCache* shape_cache_p; // Where the shapes of top-level objects are predicted.
+} JsonArena;
+
+typedef struct JsonKeyIndex JsonKeyIndex;
+
+// Lookups build the key index, the offset tables of arrays and the lazy values on demand, under
+// `mutex`, and publish them once complete: several threads may query the same `JsonObj`, as long as
+// none of them modifies it.
 typedef struct JsonObj
 {
     char* json_cstr;
+    size_t json_len;
     JsonItem root;
+    JsonArena arena;
+    JsonKeyIndex* key_index_p;
+    pthread_mutex_t mutex;
+    size_t mapped_size; // Bytes of the file mapped by `JsonObj_new_from_file()`, or 0.
 } JsonObj;
 
 Error JsonObj_new_from_string_p(const char* file, const int line, const String*, JsonObj*);
 Error JsonObj_new_from_char_p(const char* file, const int line, const char*, JsonObj*);
+Error _JsonObj_new(const char* file, const int line, const char*, JsonObj*);
+Error _JsonObj_new_lazy(const char* file, const int line, const char*, JsonObj*);
+Error _JsonObj_new_from_file(const char* file, const int line, const char* path, JsonObj*);
+Error _JsonObj_new_interned(const char* file, const int line, const char*, JsonKeyTable*, JsonObj*);
+Error _JsonObj_new_shaped(
+    const char* file,
+    const int line,
+    const char*,
+    struct JsonShapeCache*,
+    JsonObj*);
 void JsonObj_destroy(JsonObj*);
+// Check that `json_len` chars at `json_p` are a document that `JsonObj_new()` would accept, without
+// allocating. On ERR_JSON_INVALID, `out_error_offset_p`, if not NULL, receives the offset of the
+// offending char.
+Error JsonObj_validate(const char* json_p, size_t json_len, size_t* out_error_offset_p);
 void JsonObj_get_tokens(String*);
 
-// Created to have a symmetry between GET_VALUE and GET_ARRAY_VALUE
-Error invalid_request(const JsonArray*, llu_t, const JsonArray**);
+typedef struct JsonKeySlots JsonKeySlots;
+
+// Stores each key once for all the objects parsed with it, which then find keys by comparing
+// pointers. Keys are looked up without locking and added under `mutex`, hence several threads can
+// parse with the same table. The table must outlive the objects.
+struct JsonKeyTable
+{
+    JsonKeySlots* slots_p;
+    size_t len;
+    pthread_mutex_t mutex;
+};
+
+Error _JsonKeyTable_new(const char* file, const int line, JsonKeyTable*);
+void JsonKeyTable_destroy(JsonKeyTable*);
+#define JsonKeyTable_new(out_table) _JsonKeyTable_new(__FILE__, __LINE__, out_table)
+
+typedef struct JsonShape JsonShape;
+
+#define JSON_SHAPE_CACHE_SIZE (8)
+
+// Remembers the keys and value types of the members of the last top-level objects parsed with it,
+// one shape per first key, to build the next objects of the same shape with fewer scans. Not safe
+// to share across threads.
+typedef struct JsonShapeCache
+{
+    JsonShape* shapes_pp[JSON_SHAPE_CACHE_SIZE];
+    size_t next_slot; // Where the next new shape goes.
+    size_t hits;      // Objects whose shape was predicted exactly.
+    size_t misses;
+} JsonShapeCache;
+
+Error _JsonShapeCache_new(const char* file, const int line, JsonShapeCache*);
+void JsonShapeCache_destroy(JsonShapeCache*);
+#define JsonShapeCache_new(out_cache) _JsonShapeCache_new(__FILE__, __LINE__, out_cache)
+
+// Maximum number of bindings of a `Json_decode()` call, one per bit of the masks it reports.
+#define JSON_MAX_BINDINGS (64)
+
+// Where `Json_decode()` stores the value of `key`: at `offset` bytes from the beginning of a
+// struct, as `value_type`, one of VALUE_CSTR, VALUE_LLD, VALUE_LLU, VALUE_DOUBLE and VALUE_BOOL.
+typedef struct JsonBinding
+{
+    const char* key;
+    size_t offset;
+    ValueType value_type;
+} JsonBinding;
+
+#define JSON_BINDING(key, struct_type, field, value_type) \
+    {key, offsetof(struct_type, field), value_type}
+
+Error Json_decode(char*, const JsonBinding*, size_t, void*, uint64_t*, uint64_t*);
+
+// Callbacks of `Json_sax()`, called in document order. Any of them may be NULL. Each returns
+// whether to go on: on false, `Json_sax()` stops right away with ERR_INTERRUPTION, leaving the rest
+// of the input unchecked. Keys and strings are null-terminated, `len` covering embedded nulls.
+typedef struct JsonSaxHandler
+{
+    bool (*on_object_begin)(void* context_p);
+    bool (*on_object_end)(void* context_p);
+    bool (*on_array_begin)(void* context_p);
+    bool (*on_array_end)(void* context_p);
+    bool (*on_key)(void* context_p, const char* key, size_t len);
+    bool (*on_cstr)(void* context_p, const char* value_cstr, size_t len);
+    bool (*on_lld)(void* context_p, lld_t value_lld);
+    bool (*on_llu)(void* context_p, llu_t value_llu);
+    bool (*on_double)(void* context_p, double value_double);
+    bool (*on_bool)(void* context_p, bool value_bool);
+    bool (*on_null)(void* context_p);
+} JsonSaxHandler;
+
+// Parse `json_cstr`, which is modified in place, into events without building any item. As with
+// `JsonObj_new()`, the top-level value must be an object or an array.
+Error Json_sax(char* json_cstr, const JsonSaxHandler*, void* context_p);
+
+// Splits newline-delimited JSON read from `fd` into records, parsed one at a time into `json_obj`.
+// The buffers are reused from record to record, hence the memory needed is proportional to the
+// largest record rather than to the whole input.
+typedef struct JsonReader
+{
+    int fd;
+    char* buffer_p;
+    size_t size;
+    size_t begin; // First byte not consumed yet.
+    size_t scan;  // First byte not searched for a newline yet.
+    size_t end;   // End of the bytes read so far.
+    bool eof;
+    JsonObj json_obj;
+} JsonReader;
+
+Error _JsonReader_new(const char* file, const int line, int fd, JsonReader*);
+Error JsonReader_next(JsonReader*, JsonObj**);
+void JsonReader_destroy(JsonReader*);
+#define JsonReader_new(fd, out_reader) _JsonReader_new(__FILE__, __LINE__, fd, out_reader)
+
+typedef struct JsonPushState JsonPushState;
+
+// Parses a document coming in chunks, e.g. from a socket, without tokenizing the same bytes twice.
+typedef struct JsonParser
+{
+    JsonObj json_obj;
+    JsonPushState* state_p;
+} JsonParser;
+
+Error _JsonParser_new(const char* file, const int line, JsonParser*);
+Error JsonParser_feed(JsonParser*, const char*, size_t, bool*);
+void JsonParser_destroy(JsonParser*);
+#define JsonParser_new(out_parser) _JsonParser_new(__FILE__, __LINE__, out_parser)
+
+// Called from several threads at the same time, with each element parsed as a document of its own,
+// hence elements must be objects or arrays. The object is only valid during the call.
+typedef void (*JsonElementFn)(const JsonObj*, size_t index, void* context_p);
+
+typedef enum
+{
+    JSON_SPLIT_ARRAY, // Elements of a top-level array.
+    JSON_SPLIT_LINES, // Records of newline-delimited JSON, the blank ones being skipped.
+} JsonSplit;
+
+Error _JsonObj_new_parallel(const char* file, const int line, const char*, size_t, JsonObj*);
+Error _JsonObj_for_each_parallel(
+    const char* file, const int line, const char*, JsonSplit, size_t, JsonElementFn, void*);
+// Parse a top-level array on `num_of_threads` threads, or as many as the cores if 0, and never more
+// than its elements. Other documents are parsed by the calling thread.
+#define JsonObj_new_parallel(in_json, num_of_threads, out_json) \
+    _JsonObj_new_parallel(__FILE__, __LINE__, in_json, num_of_threads, out_json)
+#define JsonObj_for_each_parallel(in_json, split, num_of_threads, element_fn, context_p) \
+    _JsonObj_for_each_parallel(                                                         \
+        __FILE__, __LINE__, in_json, split, num_of_threads, element_fn, context_p)
+// The elements of a top-level array, which is the only child of `root`, and has no key.
+Error JsonObj_get_array(const JsonObj*, JsonArray**);
+
+// Visits the elements of a `JsonArray` in order.
+typedef struct JsonArrayCursor
+{
+    const JsonItem* element_p;
+} JsonArrayCursor;
+
+size_t JsonArray_len(const JsonArray*);
+JsonArrayCursor JsonArray_cursor(const JsonArray*);
+bool JsonArrayCursor_next(JsonArrayCursor*, const JsonValue**);
+
+typedef struct JsonTapeEntry JsonTapeEntry;
+
+// Read-only alternative to `JsonObj`: the values are stored in one array of 16-byte entries, in
+// document order, with keys and strings pointing into the input. Queried with `Json_get()` like a
+// `JsonObj`, with a key for objects or an index for top-level arrays.
+typedef struct JsonTape
+{
+    char* json_cstr;
+    size_t json_len;
+    JsonTapeEntry* entries_p;
+    size_t len;
+    size_t mapped_size; // Bytes of the snapshot file mapped by `JsonTape_map_snapshot()`, or 0.
+} JsonTape;
+
+// Object or array of a `JsonTape`, returned by `Json_get()` in place of a `JsonItem*` or a
+// `JsonArray*`. It remains valid as long as the tape.
+typedef struct JsonTapeView
+{
+    const char* json_cstr;
+    const JsonTapeEntry* entry_p;
+} JsonTapeView;
+
+Error _JsonTape_new(const char* file, const int line, const char*, JsonTape*);
+void JsonTape_destroy(JsonTape*);
+// Number of members or elements of the object or array.
+size_t JsonTapeView_len(const JsonTapeView*);
+// Selected by `Json_get()` when mixing a `JsonTapeView` with the items of a `JsonObj`.
+Error Json_get_unsupported(const void*, ...);
+#define JsonTape_new(in_json, out_tape) _JsonTape_new(__FILE__, __LINE__, in_json, out_tape)
+
+// Snapshots hold a tape as it is in memory, with offsets in place of pointers, so that loading one
+// is a matter of mapping the file. Pages are read on demand and shared by the processes mapping
+// the same file. Snapshots are meant to be read on the machine which wrote them. Mapping one checks
+// all its entries, hence a corrupted file is rejected rather than read out of bounds.
+Error JsonTape_save_snapshot(const JsonTape*, const char* path);
+Error JsonTape_map_snapshot(const char* path, JsonTape*);
+Error _JsonObj_save_snapshot(const char* file, const int line, const JsonObj*, const char* path);
+#define JsonObj_save_snapshot(json_obj_p, path) \
+    _JsonObj_save_snapshot(__FILE__, __LINE__, json_obj_p, path)
+
+typedef struct JsonPathSegment JsonPathSegment;
+
+// Keys and indexes leading to a value, written as in JSON Pointer (RFC 6901), e.g.
+// `/nested/array/2`. A path is compiled once and can be evaluated against any number of objects.
+typedef struct JsonPath
+{
+    JsonPathSegment* segments_p;
+    size_t len;
+} JsonPath;
+
+Error _JsonPath_new(const char* file, const int line, const char*, JsonPath*);
+void JsonPath_destroy(JsonPath*);
+#define JsonPath_new(path_cstr, out_path) _JsonPath_new(__FILE__, __LINE__, path_cstr, out_path)
+
+// Builds a JSON document by appending to a buffer that grows as needed. Commas and colons are
+// added by the writer, while the caller is in charge of alternating keys and values in objects.
+typedef struct JsonWriter
+{
+    char* buffer_p;
+    size_t len;
+    size_t size;
+    size_t depth;
+    bool need_comma;
+    bool failed; // A container was closed without being open.
+} JsonWriter;
+
+Error _JsonWriter_new(const char* file, const int line, JsonWriter*);
+void JsonWriter_begin_object(JsonWriter*);
+void JsonWriter_end_object(JsonWriter*);
+void JsonWriter_begin_array(JsonWriter*);
+void JsonWriter_end_array(JsonWriter*);
+void JsonWriter_key(JsonWriter*, const char*);
+void JsonWriter_cstr(JsonWriter*, const char*);
+void JsonWriter_lld(JsonWriter*, lld_t);
+void JsonWriter_llu(JsonWriter*, llu_t);
+void JsonWriter_double(JsonWriter*, double);
+void JsonWriter_bool(JsonWriter*, bool);
+void JsonWriter_null(JsonWriter*);
+Error JsonWriter_to_string(JsonWriter*, String*);
+void JsonWriter_destroy(JsonWriter*);
+#define JsonWriter_new(out_writer) _JsonWriter_new(__FILE__, __LINE__, out_writer)
+
+Error _JsonObj_to_string(const char* file, const int line, const JsonObj*, String*);
+// Serialize the object, including the parts left unparsed by `JsonObj_new_lazy()`, without
+// whitespace.
+#define JsonObj_to_string(json_obj_p, out_string_p) \
+    _JsonObj_to_string(__FILE__, __LINE__, json_obj_p, out_string_p)
 
 // clang-format off
 #define OBJ_GET_VALUE_h(suffix, out_type)                            \
@@ -370,6 +662,64 @@ Error invalid_request(const JsonArray*, llu_t, const JsonArray**);
     GET_ARRAY_VALUE_h(value_double, double*)
     GET_ARRAY_VALUE_h(value_bool, bool*)
     GET_ARRAY_VALUE_h(value_child_p, JsonItem**)
+    GET_ARRAY_VALUE_h(value_array_p, JsonArray**)
+
+#define PATH_GET_VALUE_h(suffix, out_type)                           \
+    Error path_get_##suffix(const JsonObj*, const JsonPath*, out_type);
+    PATH_GET_VALUE_h(value_cstr, const char**)
+    PATH_GET_VALUE_h(value_child_p, JsonItem**)
+    PATH_GET_VALUE_h(value_array_p, JsonArray**)
+    PATH_GET_VALUE_h(value_lld, lld_t*)
+    PATH_GET_VALUE_h(value_llu, llu_t*)
+    PATH_GET_VALUE_h(value_double, double*)
+    PATH_GET_VALUE_h(value_bool, bool*)
+
+#define TAPE_GET_VALUE_h(suffix, out_type)                                  \
+    Error tape_obj_get_##suffix(const JsonTape*, const char*, out_type);    \
+    Error tape_obj_get_array_##suffix(const JsonTape*, size_t, out_type);   \
+    Error tape_get_##suffix(const JsonTapeView*, const char*, out_type);    \
+    Error tape_get_array_##suffix(const JsonTapeView*, size_t, out_type);
+    TAPE_GET_VALUE_h(value_cstr, const char**)
+    TAPE_GET_VALUE_h(value_lld, lld_t*)
+    TAPE_GET_VALUE_h(value_llu, llu_t*)
+    TAPE_GET_VALUE_h(value_double, double*)
+    TAPE_GET_VALUE_h(value_bool, bool*)
+    TAPE_GET_VALUE_h(value_view, JsonTapeView*)
+
+#define SET_VALUE_h(suffix, in_type)                                           \
+    Error obj_set_##suffix(JsonObj*, const char*, in_type);                    \
+    Error set_##suffix(JsonItem*, const char*, in_type);                       \
+    Error set_array_##suffix(JsonArray*, size_t, in_type);                     \
+    Error obj_insert_##suffix(JsonObj*, const char*, in_type);                 \
+    Error insert_##suffix(JsonItem*, const char*, in_type);                    \
+    Error insert_array_##suffix(JsonArray*, size_t, in_type);                  \
+    Error obj_insert_in_##suffix(JsonObj*, const char*, const char*, in_type); \
+    Error insert_in_##suffix(JsonItem*, const char*, const char*, in_type);
+    SET_VALUE_h(value_cstr, const char*)
+    SET_VALUE_h(value_lld, lld_t)
+    SET_VALUE_h(value_llu, llu_t)
+    SET_VALUE_h(value_double, double)
+    SET_VALUE_h(value_bool, bool)
+
+Error obj_remove_value(JsonObj*, const char*);
+Error remove_value(JsonItem*, const char*);
+Error remove_array_value(JsonArray*, size_t);
+
+// Write a value of any of the supported C types.
+#define JsonWriter_value(writer_p, value)       \
+    _Generic((value),                           \
+        int                : JsonWriter_lld,    \
+        long               : JsonWriter_lld,    \
+        long long          : JsonWriter_lld,    \
+        unsigned int       : JsonWriter_llu,    \
+        unsigned long      : JsonWriter_llu,    \
+        unsigned long long : JsonWriter_llu,    \
+        float              : JsonWriter_double, \
+        double             : JsonWriter_double, \
+        bool               : JsonWriter_bool,   \
+        char*              : JsonWriter_cstr,   \
+        const char*        : JsonWriter_cstr    \
+        )(writer_p, value)
 
 #define JsonObj_new(in_json, out_json)        \
     _Generic(in_json,                         \
@@ -377,37 +727,155 @@ Error invalid_request(const JsonArray*, llu_t, const JsonArray**);
         char *      : _JsonObj_new            \
         )(__FILE__, __LINE__, in_json, out_json)
 
+// Validate the input but build the items of nested objects and arrays only when `Json_get()`
+// descends into them, one level at a time. Accessing a lazy value may fail if it holds a number
+// out of range.
+#define JsonObj_new_lazy(in_json, out_json)   \
+    _Generic(in_json,                         \
+        const char* : _JsonObj_new_lazy,      \
+        char *      : _JsonObj_new_lazy       \
+        )(__FILE__, __LINE__, in_json, out_json)
+
+// Parse with the keys stored in `key_table_p`, shared with other objects.
+#define JsonObj_new_interned(in_json, key_table_p, out_json) \
+    _JsonObj_new_interned(__FILE__, __LINE__, in_json, key_table_p, out_json)
+
+// Parse a top-level object predicting its members from the last object of `shape_cache_p` with the
+// same first key. Objects of another shape are parsed as usual, and then predicted in turn.
+#define JsonObj_new_shaped(in_json, shape_cache_p, out_json) \
+    _JsonObj_new_shaped(__FILE__, __LINE__, in_json, shape_cache_p, out_json)
+
+// Parse the file where it is mapped in memory, without reading it into a buffer first. The mapping
+// is private: keys and strings are null-terminated in place without touching the file.
+#define JsonObj_new_from_file(path, out_json) \
+    _JsonObj_new_from_file(__FILE__, __LINE__, path, out_json)
+
+#define _JSON_TAPE_GET_GENERIC(prefix, out_p)             \
+    _Generic((out_p),                                      \
+        const char**  : prefix##value_cstr,                \
+        lld_t*        : prefix##value_lld,                 \
+        llu_t*        : prefix##value_llu,                 \
+        double*       : prefix##value_double,              \
+        bool*         : prefix##value_bool,                \
+        JsonTapeView* : prefix##value_view,                \
+        JsonItem**    : Json_get_unsupported,              \
+        JsonArray**   : Json_get_unsupported               \
+        )
+
 #define Json_get(json_stuff, needle, out_p)                \
     _Generic ((json_stuff),                                \
         JsonObj*: _Generic((out_p),                        \
-            const char** : obj_get_value_cstr,             \
-            lld_t*       : obj_get_value_lld,              \
-            llu_t*       : obj_get_value_llu,              \
-            double*      : obj_get_value_double,           \
-            bool*        : obj_get_value_bool,             \
-            JsonItem**   : obj_get_value_child_p,          \
-            JsonArray**  : obj_get_value_array_p           \
+            const char**  : obj_get_value_cstr,            \
+            lld_t*        : obj_get_value_lld,             \
+            llu_t*        : obj_get_value_llu,             \
+            double*       : obj_get_value_double,          \
+            bool*         : obj_get_value_bool,            \
+            JsonItem**    : obj_get_value_child_p,         \
+            JsonArray**   : obj_get_value_array_p,         \
+            JsonTapeView* : Json_get_unsupported           \
             ),                                             \
          JsonItem*: _Generic((out_p),                      \
-            const char** : get_value_cstr,                 \
-            lld_t*       : get_value_lld,                  \
-            llu_t*       : get_value_llu,                  \
-            double*      : get_value_double,               \
-            bool*        : get_value_bool,                 \
-            JsonItem**   : get_value_child_p,              \
-            JsonArray**  : get_value_array_p               \
+            const char**  : get_value_cstr,                \
+            lld_t*        : get_value_lld,                 \
+            llu_t*        : get_value_llu,                 \
+            double*       : get_value_double,              \
+            bool*         : get_value_bool,                \
+            JsonItem**    : get_value_child_p,             \
+            JsonArray**   : get_value_array_p,             \
+            JsonTapeView* : Json_get_unsupported           \
             ),                                             \
         JsonArray*: _Generic((out_p),                      \
-            const char** : get_array_value_cstr,           \
-            lld_t*       : get_array_value_lld,            \
-            llu_t*       : get_array_value_llu,            \
-            double*      : get_array_value_double,         \
-            bool*        : get_array_value_bool,           \
-            JsonItem**   : get_array_value_child_p,        \
-            JsonArray**  : invalid_request                 \
+            const char**  : get_array_value_cstr,          \
+            lld_t*        : get_array_value_lld,           \
+            llu_t*        : get_array_value_llu,           \
+            double*       : get_array_value_double,        \
+            bool*         : get_array_value_bool,          \
+            JsonItem**    : get_array_value_child_p,       \
+            JsonArray**   : get_array_value_array_p,       \
+            JsonTapeView* : Json_get_unsupported           \
+            ),                                             \
+        JsonTape*: _Generic((needle),                      \
+            char*       : _JSON_TAPE_GET_GENERIC(tape_obj_get_, out_p),       \
+            const char* : _JSON_TAPE_GET_GENERIC(tape_obj_get_, out_p),       \
+            default     : _JSON_TAPE_GET_GENERIC(tape_obj_get_array_, out_p)  \
+            ),                                             \
+        JsonTapeView*: _Generic((needle),                  \
+            char*       : _JSON_TAPE_GET_GENERIC(tape_get_, out_p),           \
+            const char* : _JSON_TAPE_GET_GENERIC(tape_get_, out_p),           \
+            default     : _JSON_TAPE_GET_GENERIC(tape_get_array_, out_p)      \
             )                                              \
         )(json_stuff, needle, out_p)
 
+Error obj_get_many(const JsonObj*, const char* const*, const ValueType*, void* const*, size_t);
+Error get_many(const JsonItem*, const char* const*, const ValueType*, void* const*, size_t);
+// Look up `num_of_keys` distinct keys, at most JSON_MAX_BINDINGS, in a single walk over the members
+// of an object, storing the value of `keys[i]` as `types[i]` into `outs[i]`. Values found are
+// stored even if others are missing (ERR_JSON_MISSING_ENTRY) or mismatch (ERR_TYPE_MISMATCH).
+#define Json_get_many(json_stuff, keys, types, outs, num_of_keys) \
+    _Generic((json_stuff),                                        \
+        JsonObj*  : obj_get_many,                                 \
+        JsonItem* : get_many                                      \
+        )(json_stuff, keys, types, outs, num_of_keys)
+
+#define _JSON_SET_GENERIC(prefix, value)                \
+    _Generic((value),                                   \
+        int                : prefix##value_lld,         \
+        long               : prefix##value_lld,         \
+        long long          : prefix##value_lld,         \
+        unsigned int       : prefix##value_llu,         \
+        unsigned long      : prefix##value_llu,         \
+        unsigned long long : prefix##value_llu,         \
+        float              : prefix##value_double,      \
+        double             : prefix##value_double,      \
+        bool               : prefix##value_bool,        \
+        char*              : prefix##value_cstr,        \
+        const char*        : prefix##value_cstr         \
+        )
+
+#define JsonPath_get(json_obj_p, path_p, out_p)    \
+    _Generic((out_p),                              \
+        const char** : path_get_value_cstr,        \
+        lld_t*       : path_get_value_lld,         \
+        llu_t*       : path_get_value_llu,         \
+        double*      : path_get_value_double,      \
+        bool*        : path_get_value_bool,        \
+        JsonItem**   : path_get_value_child_p,     \
+        JsonArray**  : path_get_value_array_p      \
+        )(json_obj_p, path_p, out_p)
+
+// Replace the value of an existing key or element. Strings are copied, while the values which are
+// not modified keep pointing into the input.
+#define Json_set(json_stuff, needle, value)                    \
+    _Generic ((json_stuff),                                    \
+        JsonObj*   : _JSON_SET_GENERIC(obj_set_, value),       \
+        JsonItem*  : _JSON_SET_GENERIC(set_, value),           \
+        JsonArray* : _JSON_SET_GENERIC(set_array_, value)      \
+        )(json_stuff, needle, value)
+
+// Add a key which is not present yet at the end of an object, or an element at the given index of
+// an array, which may be its length to append it.
+#define Json_insert(json_stuff, needle, value)                 \
+    _Generic ((json_stuff),                                    \
+        JsonObj*   : _JSON_SET_GENERIC(obj_insert_, value),    \
+        JsonItem*  : _JSON_SET_GENERIC(insert_, value),        \
+        JsonArray* : _JSON_SET_GENERIC(insert_array_, value)   \
+        )(json_stuff, needle, value)
+
+// Add a key which is not present yet at the end of the object which is the value of `object_key`,
+// even if empty: an empty object has no member that `Json_insert()` could be given.
+#define Json_insert_in(json_stuff, object_key, key, value)     \
+    _Generic ((json_stuff),                                    \
+        JsonObj*   : _JSON_SET_GENERIC(obj_insert_in_, value), \
+        JsonItem*  : _JSON_SET_GENERIC(insert_in_, value)      \
+        )(json_stuff, object_key, key, value)
+
+#define Json_remove(json_stuff, needle)                        \
+    _Generic ((json_stuff),                                    \
+        JsonObj*   : obj_remove_value,                         \
+        JsonItem*  : remove_value,                             \
+        JsonArray* : remove_array_value                        \
+        )(json_stuff, needle)
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wextra-semi"
 ;
@@ -547,6 +1015,7 @@ Error fs_ls(const char*);
 Error fs_rm_from_path_as_char_p(const char*);
 Error fs_append(const char*, const char*);
 Error fs_create_with_content(const char*, const char*);
+Error _fs_read_to_string(const char* file, const int line, const char*, String*);
 // Files and folders.
 bool fs_does_exist(const char*);
 Error fs_rm_r(const char*);
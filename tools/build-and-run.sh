@@ -8,6 +8,8 @@ LOG_FILE_ERR="${ARTIFACT_FOLDER}/err.log"
 FLAGS="-Wall -Werror -Wextra -std=c2x -pedantic -fsanitize=address"
 DEBUG_FLAGS="-O0 -g -D_TEST -D_MEMORY_CHECK"
 RELEASE_FLAGS="-O3"
+BENCHMARK_FLAGS="-O3 -D_BENCHMARK -DLOG_LEVEL=LEVEL_ERROR"
+BENCHMARK_FILE="benchmark.jsonl"
 BUILD_DIR="build"
 DIST_DIR="dist"
 DEBUGGER="lldb"
@@ -121,6 +123,11 @@ elif [ "${MODE}" = "LIB" ]; then
     echo "-----    Usage    -----"
     echo "- Add ${APP_NAME}.h to your projects."
     echo "- Compile your projects using \n\t\$ clang <your-translation-units> -L<path-to-lib${APP_NAME}> -l${APP_NAME} -o <my_program>"
+elif [ "${MODE}" = "BENCHMARK" ]; then
+    # Built without sanitizer, to measure the code as it runs in release builds.
+    clang src/main-test.c $(echo ${FLAGS:s/-fsanitize=address/} ${BENCHMARK_FLAGS}) -o "${BUILD_DIR}/${APP_NAME}"
+    ./"${BUILD_DIR}/${APP_NAME}" | tee "${BUILD_DIR}/${BENCHMARK_FILE}"
+    echo "----- Results saved to ${BUILD_DIR}/${BENCHMARK_FILE} -----"
 elif [ "${MODE}" = "RELEASE" ]; then
     rm -rf ${DIST_DIR}
     mkdir ${DIST_DIR}
@@ -132,7 +139,7 @@ elif [ "${MODE}" = "RELEASE" ]; then
     echo "- Add ${APP_NAME}.h to your projects."
     echo "- Compile your projects using \n\t\$ clang <your-translation-units> <path-to-'${APP_NAME}.o'> -o <my_program>"
 else
-    echo "Error: accepted modes are:\n\t- 'test'\n\t- 'debug'\n\t- 'release'\n\t- lib"
+    echo "Error: accepted modes are:\n\t- 'test'\n\t- 'debug'\n\t- 'release'\n\t- lib\n\t- 'benchmark'"
     exit 1
 fi
 popd